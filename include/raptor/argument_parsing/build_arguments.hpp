@@ -12,6 +12,8 @@
 
 #include <seqan3/search/kmer_index/shape.hpp>
 
+#include <raptor/build/sequence_file_chunks.hpp>
+#include <raptor/metrics.hpp>
 #include <raptor/strong_types.hpp>
 
 namespace raptor
@@ -35,8 +37,10 @@ struct build_arguments
     uint64_t bits{4096};
     uint64_t hash{2};
     uint8_t parts{1u};
+    uint64_t shards{1u};
     double fpr{0.05};
     bool compressed{false};
+    bool huge_pages{false};
 
     // General arguments
     std::vector<std::vector<std::string>> bin_path{};
@@ -45,6 +49,14 @@ struct build_arguments
     bool is_socks{false};
     bool is_hibf{false};
     bool is_minimiser{false};
+    std::filesystem::path metrics_file{};
+    mutable raptor::metrics metrics{};
+    std::string memory_limit_string{};
+    uint64_t memory_limit{}; // In bytes; 0 means no limit.
+    std::string chunk_size_string{};
+    uint64_t chunk_size{default_chunk_size}; // In bytes; see raptor::split_sequence_file.
+    std::string available_memory_string{};
+    uint64_t available_memory{}; // In bytes; 0 means the free physical memory. See raptor::all_parts_fit_into_memory.
 };
 
 } // namespace raptor
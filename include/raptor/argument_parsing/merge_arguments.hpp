@@ -0,0 +1,32 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include <raptor/metrics.hpp>
+
+namespace raptor
+{
+
+struct merge_arguments
+{
+    std::vector<std::filesystem::path> in_files{};
+    std::filesystem::path out_file{};
+    uint8_t threads{1u};
+
+    // Determined from the input indices.
+    uint8_t parts{1u};
+    size_t bins{};
+
+    std::filesystem::path metrics_file{};
+    mutable raptor::metrics metrics{};
+};
+
+} // namespace raptor
@@ -0,0 +1,31 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace raptor
+{
+
+struct remove_arguments
+{
+    std::filesystem::path bin_file{};
+    std::filesystem::path in_file{};
+    std::filesystem::path out_file{};
+    bool is_hibf{false};
+    bool compact{false};
+
+    // Determined from the input index.
+    uint8_t parts{1u};
+
+    // Whether each user bin of the index is removed.
+    std::vector<bool> removed{};
+};
+
+} // namespace raptor
@@ -12,6 +12,9 @@
 
 #include <seqan3/search/kmer_index/shape.hpp>
 
+#include <raptor/metrics.hpp>
+#include <raptor/prefetching_counting_agent.hpp>
+#include <raptor/search/numa_topology.hpp>
 #include <raptor/threshold/threshold_parameters.hpp>
 
 namespace raptor
@@ -32,6 +35,7 @@ struct search_arguments
     uint8_t shape_weight{shape.count()};
     uint8_t threads{1u};
     uint8_t parts{1u};
+    uint64_t shards{1u};
 
     // Related to thresholding
     double tau{0.9999};
@@ -45,6 +49,12 @@ struct search_arguments
     // Related to IBF
     std::filesystem::path index_file{};
     bool compressed{false};
+    std::string numa_string{"none"};
+    raptor::numa_policy numa{raptor::numa_policy::none};
+    bool huge_pages{false};
+    std::string prefetch_distance_string{"auto"};
+    size_t prefetch_distance{raptor::auto_prefetch_distance};
+    bool worker_processes{false};
 
     // General arguments
     std::vector<std::vector<std::string>> bin_path{};
@@ -54,6 +64,9 @@ struct search_arguments
     bool is_socks{false};
     bool is_hibf{false};
     bool cache_thresholds{false};
+    std::filesystem::path metrics_file{};
+    mutable raptor::metrics metrics{};
+    bool hardware_counters{false};
 
     raptor::threshold::threshold_parameters make_threshold_parameters() const noexcept
     {
@@ -0,0 +1,40 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include <seqan3/search/kmer_index/shape.hpp>
+
+namespace raptor
+{
+
+struct update_arguments
+{
+    std::filesystem::path bin_file{};
+    std::filesystem::path in_file{};
+    std::filesystem::path out_file{};
+    uint8_t threads{1u};
+    bool huge_pages{false};
+    bool is_hibf{false};
+    double fpr{0.05};
+
+    // Determined from the input index.
+    uint32_t window_size{};
+    seqan3::shape shape{};
+    uint8_t parts{1u};
+
+    // The new user bins.
+    std::vector<std::vector<std::string>> bin_path{};
+    bool is_minimiser{false};
+
+    std::filesystem::path metrics_file{};
+};
+
+} // namespace raptor
@@ -0,0 +1,92 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+#include <raptor/ibf_hasher.hpp>
+
+namespace raptor
+{
+
+/*!\brief Inserts values into an uncompressed IBF. Any number of agents may insert into the same IBF concurrently.
+ * \details
+ * seqan3::interleaved_bloom_filter::emplace sets a bit via a read-modify-write of the whole 64-bit word, which also
+ * holds the bits of 63 other bins. Two threads inserting into different bins of the same word may hence lose
+ * an update. This agent sets the bit with an atomic `fetch_or` instead, so threads may insert into arbitrary bins
+ * without locks or a partitioning of the bins. If the bit is already set, no atomic operation is performed.
+ *
+ * The hashing is identical to the one of the seqan3::interleaved_bloom_filter, and so is the resulting IBF.
+ *
+ * ### Thread safety
+ *
+ * Concurrent calls of emplace() on any agents of the same IBF are thread safe. The IBF must not be modified otherwise,
+ * e.g. via seqan3::interleaved_bloom_filter::emplace, at the same time.
+ */
+class atomic_insertion_agent
+{
+private:
+    //!\brief The type of the augmented IBF.
+    using ibf_t = seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed>;
+
+    //!\brief The words of the IBF's bit vector.
+    uint64_t * data{nullptr};
+    //!\brief The hashing of the IBF.
+    detail::ibf_hasher hasher{};
+    //!\brief The number of bins rounded up to a multiple of 64.
+    size_t technical_bins{};
+    //!\brief The number of hash functions.
+    size_t hash_count{};
+
+public:
+    /*!\name Constructors, destructor and assignment
+     * \{
+     */
+    atomic_insertion_agent() = default; //!< Defaulted.
+    atomic_insertion_agent(atomic_insertion_agent const &) = default; //!< Defaulted.
+    atomic_insertion_agent & operator=(atomic_insertion_agent const &) = default; //!< Defaulted.
+    atomic_insertion_agent(atomic_insertion_agent &&) = default; //!< Defaulted.
+    atomic_insertion_agent & operator=(atomic_insertion_agent &&) = default; //!< Defaulted.
+    ~atomic_insertion_agent() = default; //!< Defaulted.
+
+    /*!\brief Construct an atomic_insertion_agent for an existing IBF.
+     * \param ibf The IBF. Must outlive the agent.
+     */
+    explicit atomic_insertion_agent(ibf_t & ibf) :
+        data{ibf.raw_data().data()},
+        hasher{ibf},
+        technical_bins{hasher.technical_bin_count()},
+        hash_count{ibf.hash_function_count()}
+    {
+        assert(hash_count <= detail::ibf_hasher::seeds.size());
+    }
+    //!\}
+
+    //!\brief Inserts `value` into `bin`. Same as seqan3::interleaved_bloom_filter::emplace.
+    void emplace(size_t const value, seqan3::bin_index const bin) const noexcept
+    {
+        assert(data != nullptr);
+        assert(bin.get() < technical_bins);
+
+        for (size_t i = 0; i < hash_count; ++i)
+        {
+            size_t const index = hasher.hash_and_fit(value, detail::ibf_hasher::seeds[i]) + bin.get();
+            uint64_t const mask = 1ULL << (index & 63u);
+            std::atomic_ref<uint64_t> word{data[index >> 6]};
+
+            // Most bits of frequent values are already set; reading does not require exclusive cache line ownership.
+            if ((word.load(std::memory_order_relaxed) & mask) == 0u)
+                word.fetch_or(mask, std::memory_order_relaxed);
+        }
+    }
+};
+
+} // namespace raptor
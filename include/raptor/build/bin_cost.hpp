@@ -0,0 +1,77 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace raptor
+{
+
+/*!\brief Estimates the work needed to process a bin.
+ * \details
+ * For a `.minimiser` file, this is the minimiser count stored in the corresponding `.header` file, if there is one.
+ * For all other files, it is the file size in bytes. Files that cannot be read count as 0.
+ * The estimates of different bins are only comparable if all bins consist of the same kind of files.
+ */
+inline uint64_t estimate_bin_cost(std::vector<std::string> const & file_names)
+{
+    uint64_t cost{};
+
+    for (auto const & file_name : file_names)
+    {
+        std::filesystem::path const path{file_name};
+
+        if (path.extension() == ".minimiser")
+        {
+            // Format: shape window cutoff count
+            std::ifstream header{std::filesystem::path{path}.replace_extension(".header")};
+            std::string shape{};
+            uint64_t window{};
+            uint64_t cutoff{};
+            uint64_t count{};
+            if (header >> shape >> window >> cutoff >> count)
+            {
+                cost += count;
+                continue;
+            }
+        }
+
+        std::error_code ec{};
+        uint64_t const size = std::filesystem::file_size(path, ec);
+        cost += ec ? 0u : size;
+    }
+
+    return cost;
+}
+
+/*!\brief Returns the indices of the bins, ordered by decreasing estimated cost.
+ * \details
+ * Bins with the same cost keep their order. When threads take the next bin from this order as soon as they are idle,
+ * the largest bins are started first and the small ones fill the gaps at the end (longest processing time first).
+ */
+inline std::vector<size_t> largest_first(std::vector<std::vector<std::string>> const & bin_path)
+{
+    std::vector<uint64_t> costs(bin_path.size());
+    std::ranges::transform(bin_path, costs.begin(), estimate_bin_cost);
+
+    std::vector<size_t> order(bin_path.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, [&costs] (size_t const lhs, size_t const rhs)
+    {
+        return costs[lhs] > costs[rhs];
+    });
+
+    return order;
+}
+
+} // namespace raptor
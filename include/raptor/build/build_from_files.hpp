@@ -7,12 +7,59 @@
 
 #pragma once
 
+#include <unistd.h>
+
 #include <raptor/build/index_factory.hpp>
 #include <raptor/build/store_index.hpp>
 
 namespace raptor
 {
 
+/*!\brief Returns for each value of the last `2 * suffix_length` bits of a minimiser the part it belongs to.
+ * \details
+ * The size of the returned vector is the smallest power of four that is at least `parts`.
+ */
+inline std::vector<size_t> part_of_suffix(size_t const parts)
+{
+    if (parts == 2u) // More than 1 prefix per part
+        return {0u, 0u, 1u, 1u};
+
+    // How long must the suffix be such that 4^suffix_length >= parts
+    size_t suffix_length{0};
+    for (; 0b100u << (2 * suffix_length) < parts; ++suffix_length) {}
+    size_t const next_power_of_four = 0b100u << (2 * suffix_length);
+
+    size_t const prefixes_per_part = next_power_of_four / parts;
+
+    std::vector<size_t> result(next_power_of_four);
+    for (size_t i : std::views::iota(0u, next_power_of_four))
+        result[i] = i / prefixes_per_part;
+
+    return result;
+}
+
+/*!\brief Whether there is enough free memory to keep all parts of the index in memory at the same time.
+ * \details
+ * Each part is an IBF with `arguments.bits / arguments.parts` bits per bin, see raptor::raptor_index. Each thread
+ * additionally holds a chunk of the input and its copy in a stream.
+ * The available memory is `arguments.available_memory` if set, and the free physical memory otherwise.
+ */
+inline bool all_parts_fit_into_memory(build_arguments const & arguments)
+{
+    uint64_t const part_bytes = arguments.bits / arguments.parts / 8u * ((arguments.bins + 63u) / 64u * 64u);
+    uint64_t const required = arguments.parts * part_bytes + arguments.threads * 2u * arguments.chunk_size;
+
+    if (arguments.available_memory > 0u)
+        return required < arguments.available_memory;
+
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+    uint64_t const available = static_cast<uint64_t>(sysconf(_SC_AVPHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+    return required < available;
+#else
+    return true;
+#endif
+}
+
 template <bool compressed>
 void build_from_files(build_arguments const & arguments)
 {
@@ -25,42 +72,35 @@ void build_from_files(build_arguments const & arguments)
     }
     else
     {
-        std::vector<std::vector<size_t>> association(arguments.parts);
-        size_t next_power_of_four{4u};
+        std::vector<size_t> const part_lookup = part_of_suffix(arguments.parts);
+        size_t const mask{part_lookup.size() - 1u};
 
-        if (arguments.parts == 4u) // one-to-one
-        {
-            for (size_t i : std::views::iota(0u, arguments.parts))
-                association[i] = std::vector<size_t>{i};
-        }
-        else if (arguments.parts == 2u) // More than 1 prefix per part
+        auto part_out_path = [&] (size_t const part)
         {
-            association[0] = std::vector<size_t>{0, 1};
-            association[1] = std::vector<size_t>{2, 3};
-        }
-        else // More parts than prefixes
-        {
-            // How long must the suffix be such that 4^suffix_length >= arguments.parts
-            size_t suffix_length{0};
-            for (; 0b100 << (2 * suffix_length) < arguments.parts; ++suffix_length) {}
-            next_power_of_four = 0b100 << (2 * suffix_length);
+            std::filesystem::path out_path{arguments.out_path};
+            out_path += "_" + std::to_string(part);
+            return out_path;
+        };
 
-            size_t const prefixes_per_part = next_power_of_four / arguments.parts;
+        if (all_parts_fit_into_memory(arguments))
+        {
+            // Read and hash the input once, and distribute the minimisers to the parts.
+            auto indices = generator.parts([&] (uint64_t const hash) { return part_lookup[hash & mask]; });
 
-            for (size_t i : std::views::iota(0u, next_power_of_four))
-                association[i/prefixes_per_part].push_back(i);
+            for (size_t part : std::views::iota(0u, arguments.parts))
+                store_index(part_out_path(part), indices[part], arguments);
         }
-
-        for (size_t part : std::views::iota(0u, arguments.parts))
+        else
         {
-            size_t const mask{next_power_of_four - 1};
-            auto filter_view = std::views::filter([&] (auto && hash)
-                { return std::ranges::find(association[part], hash & mask) != association[part].end(); });
+            // Build one part at a time. The input is read and hashed once per part.
+            for (size_t part : std::views::iota(0u, arguments.parts))
+            {
+                auto filter_view = std::views::filter([&] (auto && hash)
+                    { return part_lookup[hash & mask] == part; });
 
-            auto index = generator(std::move(filter_view));
-            std::filesystem::path out_path{arguments.out_path};
-            out_path += "_" + std::to_string(part);
-            store_index(out_path, index, arguments);
+                auto index = generator(std::move(filter_view));
+                store_index(part_out_path(part), index, arguments);
+            }
         }
     }
 }
@@ -8,10 +8,14 @@
 #pragma once
 
 #include <raptor/argument_parsing/build_arguments.hpp>
+#include <raptor/index.hpp>
 
 namespace raptor
 {
 
 void build_from_minimiser(build_arguments const & arguments);
 
+// Inserts the .minimiser files of `arguments` into the existing `index` as bins `first_bin`, `first_bin + 1`, ...
+void insert_minimisers(build_arguments const & arguments, raptor_index<> & index, size_t const first_bin);
+
 } // namespace raptor
@@ -7,27 +7,116 @@
 
 #pragma once
 
+#include <chrono>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
 #include <seqan3/core/algorithm/detail/execution_handler_parallel.hpp>
 #include <seqan3/utility/views/chunk.hpp>
-#include <seqan3/utility/views/zip.hpp>
 
 #include <raptor/argument_parsing/build_arguments.hpp>
+#include <raptor/build/bin_cost.hpp>
+#include <raptor/build/sequence_file_chunks.hpp>
 
 namespace raptor
 {
 
+// Each bin is a task; idle threads take the next bin. The bins are handed out in order of decreasing estimated cost,
+// such that a large bin is not started last. Workers inserting into a shared IBF must use the
+// raptor::atomic_insertion_agent, since bins sharing a 64-bit word may be processed concurrently.
+// The elapsed time is recorded as `stage` in arguments.metrics, including the time spent by each thread.
+template <typename algorithm_t>
+void call_parallel_on_bins(algorithm_t && worker, build_arguments const & arguments, std::string const & stage = "insert")
+{
+    // With a single thread, the order does not matter.
+    std::vector<size_t> order{};
+    if (arguments.threads > 1u)
+    {
+        order = largest_first(arguments.bin_path);
+    }
+    else
+    {
+        order.resize(arguments.bin_path.size());
+        std::iota(order.begin(), order.end(), 0u);
+    }
+
+    auto chunked_view = order | std::views::transform([&arguments] (size_t const bin_number)
+                        {
+                            return std::tuple<std::vector<std::string> const &, size_t>{arguments.bin_path[bin_number],
+                                                                                        bin_number};
+                        })
+                        | seqan3::views::chunk(1u);
+    auto timed_worker = [&worker, &arguments, &stage] (auto && zipped_view, auto && callback)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        worker(std::forward<decltype(zipped_view)>(zipped_view), std::forward<decltype(callback)>(callback));
+        auto end = std::chrono::high_resolution_clock::now();
+        arguments.metrics.add_thread_time(stage, std::chrono::duration<double>(end - start).count());
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    seqan3::detail::execution_handler_parallel executioner{arguments.threads};
+    executioner.bulk_execute(std::move(timed_worker), std::move(chunked_view), [](){});
+    auto end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage(stage, std::chrono::duration<double>(end - start).count());
+}
+
+/*!\brief Like call_parallel_on_bins, but large sequence files are split into chunks that are processed in parallel.
+ * \details
+ * Calls `worker(chunk, bin_number)` for each raptor::sequence_file_chunk of each file of each bin. With more than one
+ * thread, uncompressed FASTA and FASTQ files larger than build_arguments::chunk_size are split into record-aligned
+ * chunks, see raptor::split_sequence_file.
+ * Hence, a single large bin does not bound the build time. The chunks are handed out largest first.
+ * Since chunks of the same bin are processed concurrently, the worker must only be used for per-record work like
+ * inserting minimisers via raptor::atomic_insertion_agent.
+ */
 template <typename algorithm_t>
-void call_parallel_on_bins(algorithm_t && worker, build_arguments const & arguments)
+void call_parallel_on_chunks(algorithm_t && worker,
+                             build_arguments const & arguments,
+                             std::string const & stage = "insert")
 {
-// GCOVR_EXCL_START
-    size_t const chunk_size = std::clamp<size_t>(std::bit_ceil(arguments.bins / arguments.threads),
-                                                 8u,
-                                                 64u);
-// GCOVR_EXCL_STOP
-    auto chunked_view = seqan3::views::zip(arguments.bin_path, std::views::iota(0u)) |
-                        seqan3::views::chunk(chunk_size);
+    using item_t = std::pair<sequence_file_chunk, size_t>; // chunk, bin number
+    std::vector<item_t> items{};
+
+    for (size_t bin_number = 0; bin_number < arguments.bin_path.size(); ++bin_number)
+    {
+        for (auto const & file_name : arguments.bin_path[bin_number])
+        {
+            if (arguments.threads > 1u)
+            {
+                for (auto & chunk : split_sequence_file(file_name, arguments.chunk_size))
+                    items.emplace_back(std::move(chunk), bin_number);
+            }
+            else
+            {
+                items.emplace_back(sequence_file_chunk{file_name}, bin_number);
+            }
+        }
+    }
+
+    if (arguments.threads > 1u)
+    {
+        std::ranges::stable_sort(items, [] (item_t const & lhs, item_t const & rhs)
+        {
+            return lhs.first.size() > rhs.first.size();
+        });
+    }
+
+    auto timed_worker = [&worker, &arguments, &stage] (auto && chunk_view, auto &&)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto && [chunk, bin_number] : chunk_view)
+            worker(chunk, bin_number);
+        auto end = std::chrono::high_resolution_clock::now();
+        arguments.metrics.add_thread_time(stage, std::chrono::duration<double>(end - start).count());
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
     seqan3::detail::execution_handler_parallel executioner{arguments.threads};
-    executioner.bulk_execute(std::move(worker), std::move(chunked_view), [](){});
+    executioner.bulk_execute(std::move(timed_worker), items | seqan3::views::chunk(1u), [](){});
+    auto end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage(stage, std::chrono::duration<double>(end - start).count());
 }
 
 } // namespace raptor
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <raptor/argument_parsing/build_arguments.hpp>
 
 namespace raptor::hibf
@@ -14,4 +16,15 @@ namespace raptor::hibf
 
 size_t bin_size_in_bits(build_arguments const & arguments, size_t const number_of_kmers_to_be_stored);
 
+//!\brief The inverse of bin_size_in_bits(): How many k-mers a bin of `bin_size` bits can store.
+size_t max_number_of_kmers(build_arguments const & arguments, size_t const bin_size);
+
+/*!\brief Returns the factors by which the bin size must be increased when a user bin is split into `i` technical bins,
+ *        for `i` in `[0, tmax]`.
+ * \details
+ * A query is reported if it is found in any of the technical bins, hence the false positive rate of a split user bin
+ * is higher than the one of each technical bin.
+ */
+std::vector<double> fp_correction_factors(size_t const tmax, size_t const hash, double const fpr);
+
 } // namespace raptor::hibf
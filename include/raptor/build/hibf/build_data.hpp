@@ -8,9 +8,13 @@
 #pragma once
 
 #include <atomic>
+#include <optional>
 #include <seqan3/std/new>
 
+#include <raptor/build/hibf/bin_size_in_bits.hpp>
+#include <raptor/build/hibf/kmer_union.hpp>
 #include <raptor/build/hibf/node_data.hpp>
+#include <raptor/build/task_scheduler.hpp>
 #include <raptor/hierarchical_interleaved_bloom_filter.hpp>
 
 namespace raptor::hibf
@@ -31,6 +35,11 @@ struct build_data
     hierarchical_interleaved_bloom_filter<data_layout_mode> hibf{};
     std::vector<double> fp_correction{};
 
+    // Builds the subtrees of merged bins in parallel, on all levels.
+    std::optional<task_scheduler> scheduler{};
+    // Decides whether the k-mers of merged bins are kept in memory or written to temporary files.
+    std::optional<kmer_storage> storage{};
+
     size_t request_ibf_idx()
     {
         return std::atomic_fetch_add(&ibf_number, 1u);
@@ -51,16 +60,7 @@ struct build_data
 
     void compute_fp_correction(size_t const tmax, size_t const hash, double const fpr)
     {
-        fp_correction.resize(tmax + 1, 1.0);
-
-        double const denominator = std::log(1 - std::exp(std::log(fpr) / hash));
-
-        for (size_t i = 2; i <= tmax; ++i)
-        {
-            double const tmp = 1.0 - std::pow(1 - fpr, static_cast<double>(i));
-            fp_correction[i] = std::log(1 - std::exp(std::log(tmp) / hash)) / denominator;
-            assert(fp_correction[i] >= 1.0);
-        }
+        fp_correction = fp_correction_factors(tmax, hash, fpr);
     }
 };
 
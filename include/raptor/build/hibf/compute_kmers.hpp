@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include <robin_hood.h>
+#include <vector>
 
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/chopper_pack_record.hpp>
@@ -15,8 +15,17 @@
 namespace raptor::hibf
 {
 
-void compute_kmers(robin_hood::unordered_flat_set<size_t> & kmers,
+/*!\brief Computes the distinct k-mers of `record`.
+ * \details
+ * If the record is stored in a single technical bin, `kmers` is sorted. If the record is split into multiple technical
+ * bins, `kmers` is in the iteration order of a `robin_hood::unordered_flat_set` with a capacity for at least
+ * `set_capacity` elements. This order determines the assignment of k-mers to technical bins in insert_into_ibf().
+ * Previously, one hash set was reused for all records of an IBF; passing the largest number of k-mers computed so far
+ * for this IBF as `set_capacity` results in the same assignment, and hence in the same HIBF.
+ */
+void compute_kmers(std::vector<uint64_t> & kmers,
                    build_arguments const & arguments,
-                   chopper_pack_record const & record);
+                   chopper_pack_record const & record,
+                   size_t const set_capacity = 0u);
 
 } // namespace raptor::hibf
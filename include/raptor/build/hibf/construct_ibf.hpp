@@ -7,17 +7,19 @@
 
 #pragma once
 
-#include <robin_hood.h>
+#include <vector>
 
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/build_data.hpp>
+#include <raptor/build/hibf/kmer_union.hpp>
 
 namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-seqan3::interleaved_bloom_filter<> construct_ibf(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                                                 robin_hood::unordered_flat_set<size_t> & kmers,
+seqan3::interleaved_bloom_filter<> construct_ibf(kmer_union & parent_kmers,
+                                                 std::vector<uint64_t> && kmers,
+                                                 kmer_union & favourite_kmers,
                                                  size_t const number_of_bins,
                                                  lemon::ListDigraph::Node const & node,
                                                  build_data<data_layout_mode> & data,
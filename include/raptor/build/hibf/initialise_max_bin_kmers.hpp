@@ -7,16 +7,18 @@
 
 #pragma once
 
-#include <robin_hood.h>
+#include <vector>
 
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/build_data.hpp>
+#include <raptor/build/hibf/kmer_union.hpp>
 
 namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-size_t initialise_max_bin_kmers(robin_hood::unordered_flat_set<size_t> & kmers,
+size_t initialise_max_bin_kmers(std::vector<uint64_t> & kmers,
+                                kmer_union & favourite_kmers,
                                 std::vector<int64_t> & ibf_positions,
                                 std::vector<int64_t> & filename_indices,
                                 lemon::ListDigraph::Node const & node,
@@ -7,27 +7,37 @@
 
 #pragma once
 
-#include <robin_hood.h>
+#include <vector>
 
 #include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
 
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/chopper_pack_record.hpp>
+#include <raptor/build/hibf/kmer_union.hpp>
 
 namespace raptor::hibf
 {
 
-
 // automatically does naive splitting if number_of_bins > 1
-void insert_into_ibf(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                            robin_hood::unordered_flat_set<size_t> const & kmers,
-                            size_t const number_of_bins,
-                            size_t const bin_index,
-                            seqan3::interleaved_bloom_filter<> & ibf,
-                            bool is_root);
+// If not is_root, the distinct k-mers `kmers` are moved into parent_kmers.
+void insert_into_ibf(kmer_union & parent_kmers,
+                     std::vector<uint64_t> && kmers,
+                     size_t const number_of_bins,
+                     size_t const bin_index,
+                     seqan3::interleaved_bloom_filter<> & ibf,
+                     bool is_root);
+
+// Inserts the merged `kmers` of a lower level IBF into bin_index.
+// If not is_root, the k-mers are moved into parent_kmers.
+// May be called concurrently for different bins of the same IBF.
+void insert_into_ibf(kmer_union & parent_kmers,
+                     kmer_union & kmers,
+                     size_t const bin_index,
+                     seqan3::interleaved_bloom_filter<> & ibf,
+                     bool is_root);
 
 void insert_into_ibf(build_arguments const & arguments,
-                            chopper_pack_record const & record,
-                            seqan3::interleaved_bloom_filter<> & ibf);
+                     chopper_pack_record const & record,
+                     seqan3::interleaved_bloom_filter<> & ibf);
 
 } // namespace raptor::hibf
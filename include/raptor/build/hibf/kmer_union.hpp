@@ -0,0 +1,352 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include <raptor/build/minimiser_file.hpp>
+
+namespace raptor::hibf
+{
+
+//!\brief Sorts `kmers` and removes duplicates.
+inline void sort_and_deduplicate(std::vector<uint64_t> & kmers)
+{
+    if (!std::ranges::is_sorted(kmers))
+        std::ranges::sort(kmers);
+    kmers.erase(std::unique(kmers.begin(), kmers.end()), kmers.end());
+}
+
+/*!\brief Decides whether sets of k-mers are kept in memory or written to temporary files.
+ * \details
+ * All raptor::hibf::kmer_union sharing a kmer_storage share its memory limit. A set of k-mers that would exceed the
+ * limit is written to a temporary `.minimiser` file in `temp_directory` instead. A memory limit of `0` means no limit.
+ */
+class kmer_storage
+{
+public:
+    kmer_storage() = default;
+    kmer_storage(kmer_storage const &) = delete;
+    kmer_storage & operator=(kmer_storage const &) = delete;
+    kmer_storage(kmer_storage &&) = delete;
+    kmer_storage & operator=(kmer_storage &&) = delete;
+    ~kmer_storage() = default;
+
+    kmer_storage(uint64_t const memory_limit, std::filesystem::path const & temp_directory) :
+        memory_limit{memory_limit},
+        temp_directory{temp_directory.empty() ? std::filesystem::temp_directory_path() : temp_directory}
+    {}
+
+    //!\brief Reserves memory for `count` k-mers. Returns `false` if this would exceed the limit.
+    bool try_reserve(size_t const count)
+    {
+        uint64_t const bytes = count * sizeof(uint64_t);
+        uint64_t current = used.load(std::memory_order_relaxed);
+
+        do
+        {
+            if (memory_limit > 0u && current + bytes > memory_limit)
+                return false;
+        }
+        while (!used.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+
+        return true;
+    }
+
+    //!\brief Releases the memory reserved for `count` k-mers.
+    void release(size_t const count)
+    {
+        used.fetch_sub(count * sizeof(uint64_t), std::memory_order_relaxed);
+    }
+
+    //!\brief Returns a unique path for a temporary file.
+    std::filesystem::path next_file()
+    {
+        return temp_directory / ("raptor_kmers_" + std::to_string(getpid()) + '_' + std::to_string(file_id++) +
+                                 ".minimiser");
+    }
+
+    //!\brief Returns the number of temporary files returned by next_file().
+    uint64_t files() const
+    {
+        return file_id.load(std::memory_order_relaxed);
+    }
+
+private:
+    uint64_t memory_limit{};
+    std::filesystem::path temp_directory{std::filesystem::temp_directory_path()};
+    std::atomic<uint64_t> used{};
+    std::atomic<uint64_t> file_id{};
+};
+
+/*!\brief Collects sets of k-mers and computes their union.
+ * \details
+ * Used for the k-mers of a merged bin, i.e., the union of all k-mers stored in the lower level IBF.
+ * Each added set is kept as a sorted vector or, if the raptor::hibf::kmer_storage is out of memory, as a temporary
+ * `.minimiser` file. merge() combines them in a single k-way merge.
+ * Compared to inserting all k-mers into a hash set, this needs 8 bytes per k-mer and accesses memory sequentially.
+ * add() may be called concurrently.
+ */
+class kmer_union
+{
+public:
+    //!\brief All sets are kept in memory.
+    kmer_union() = default;
+    kmer_union(kmer_union const &) = delete;
+    kmer_union & operator=(kmer_union const &) = delete;
+    kmer_union(kmer_union &&) = delete;
+    kmer_union & operator=(kmer_union &&) = delete;
+
+    ~kmer_union()
+    {
+        clear();
+    }
+
+    //!\brief The sets are kept in memory or written to files according to `storage`.
+    explicit kmer_union(kmer_storage & storage) : storage{&storage}
+    {}
+
+    //!\brief Adds the distinct k-mers `kmers`.
+    void add(std::vector<uint64_t> && kmers)
+    {
+        if (kmers.empty())
+            return;
+
+        if (!std::ranges::is_sorted(kmers))
+            std::ranges::sort(kmers);
+
+        run current{};
+        current.size = kmers.size();
+
+        if (storage == nullptr || storage->try_reserve(kmers.size()))
+        {
+            current.values = std::move(kmers);
+        }
+        else
+        {
+            current.file = storage->next_file();
+            minimiser_file_writer writer{current.file};
+            for (uint64_t const value : kmers)
+                writer.push_back(value);
+            kmers = std::vector<uint64_t>{};
+        }
+
+        std::lock_guard lock{mutex};
+        runs.push_back(std::move(current));
+    }
+
+    //!\brief Adds all k-mers of `other`, which must use the same storage. `other` is empty afterwards.
+    void add(kmer_union & other)
+    {
+        assert(storage == other.storage);
+        other.merge();
+
+        std::scoped_lock lock{mutex, other.mutex};
+        if (!other.runs.empty())
+        {
+            runs.push_back(std::move(other.runs[0]));
+            other.runs.clear();
+        }
+    }
+
+    //!\brief Merges all sets into one. Required for size() and for_each_block().
+    void merge()
+    {
+        std::lock_guard lock{mutex};
+
+        if (runs.size() <= 1u)
+            return;
+
+        size_t total_size{};
+        bool all_in_memory{true};
+        for (auto const & current : runs)
+        {
+            total_size += current.size;
+            all_in_memory &= current.file.empty();
+        }
+
+        // The result has at most `total_size` k-mers. If files are merged, the result is written to a file as well.
+        bool const in_memory = all_in_memory && (storage == nullptr || storage->try_reserve(total_size));
+
+        run result{};
+        if (in_memory)
+        {
+            result.values.reserve(total_size);
+            merge_runs([&result] (uint64_t const value)
+            {
+                result.values.push_back(value);
+            });
+            result.size = result.values.size();
+        }
+        else
+        {
+            result.file = storage->next_file();
+            minimiser_file_writer writer{result.file};
+            merge_runs([&writer] (uint64_t const value)
+            {
+                writer.push_back(value);
+            });
+            result.size = writer.size();
+        }
+
+        // The runs are freed first, hence shrinking does not increase the memory peak.
+        clear_runs();
+        if (in_memory)
+        {
+            result.values.shrink_to_fit();
+            if (storage != nullptr)
+                storage->release(total_size - result.size);
+        }
+
+        runs.push_back(std::move(result));
+    }
+
+    //!\brief The number of distinct k-mers. merge() must have been called.
+    size_t size() const
+    {
+        assert(runs.size() <= 1u);
+        return runs.empty() ? 0u : runs[0].size;
+    }
+
+    /*!\brief Calls `callback(block)` for blocks of the sorted, distinct k-mers. merge() must have been called.
+     * \details
+     * `block` is a `std::vector<uint64_t> const &`.
+     */
+    template <typename callback_t>
+    void for_each_block(callback_t && callback) const
+    {
+        assert(runs.size() <= 1u);
+
+        if (runs.empty())
+            return;
+
+        if (runs[0].file.empty())
+            callback(runs[0].values);
+        else
+            for_each_minimiser_block(std::vector<std::filesystem::path>{runs[0].file}, callback);
+    }
+
+    //!\brief Removes all k-mers.
+    void clear()
+    {
+        std::lock_guard lock{mutex};
+        clear_runs();
+    }
+
+private:
+    //!\brief A sorted set of distinct k-mers, either in memory or in a `.minimiser` file.
+    struct run
+    {
+        std::vector<uint64_t> values{};
+        std::filesystem::path file{};
+        size_t size{};
+    };
+
+    //!\brief Iterates over the k-mers of a run.
+    struct cursor
+    {
+        std::vector<uint64_t> const * values{};
+        std::vector<uint64_t> block{};
+        std::optional<minimiser_file_reader> reader{};
+        size_t position{};
+
+        explicit cursor(run const & current)
+        {
+            if (current.file.empty())
+                values = &current.values;
+            else
+                reader.emplace(current.file);
+        }
+
+        //!\brief Returns `false` if there are no more k-mers.
+        bool valid()
+        {
+            if (reader && position == block.size())
+            {
+                reader->read_block(block);
+                position = 0u;
+            }
+
+            return position < (reader ? block.size() : values->size());
+        }
+
+        uint64_t value() const
+        {
+            return reader ? block[position] : (*values)[position];
+        }
+    };
+
+    //!\brief The sets of k-mers.
+    std::vector<run> runs{};
+    //!\brief Where to keep the sets. `nullptr` means memory without limit.
+    kmer_storage * storage{nullptr};
+    //!\brief Protects `runs`.
+    std::mutex mutex{};
+
+    //!\brief Calls `callback(value)` for each distinct k-mer of all runs in ascending order.
+    template <typename callback_t>
+    void merge_runs(callback_t && callback)
+    {
+        std::vector<cursor> cursors{};
+        cursors.reserve(runs.size());
+        for (auto const & current : runs)
+            cursors.emplace_back(current);
+
+        using entry_t = std::pair<uint64_t, size_t>; // value, cursor
+        std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> queue{};
+
+        for (size_t i = 0; i < cursors.size(); ++i)
+            if (cursors[i].valid())
+                queue.emplace(cursors[i].value(), i);
+
+        bool first{true};
+        uint64_t last{};
+
+        while (!queue.empty())
+        {
+            auto const [value, i] = queue.top();
+            queue.pop();
+
+            if (first || value != last)
+                callback(value);
+            first = false;
+            last = value;
+
+            ++cursors[i].position;
+            if (cursors[i].valid())
+                queue.emplace(cursors[i].value(), i);
+        }
+    }
+
+    //!\brief Frees all runs. The caller must hold the lock.
+    void clear_runs()
+    {
+        std::error_code ec{};
+        for (auto const & current : runs)
+        {
+            if (!current.file.empty())
+                std::filesystem::remove(current.file, ec);
+            else if (storage != nullptr)
+                storage->release(current.size);
+        }
+        runs.clear();
+    }
+};
+
+} // namespace raptor::hibf
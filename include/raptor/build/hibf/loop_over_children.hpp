@@ -7,16 +7,15 @@
 
 #pragma once
 
-#include <robin_hood.h>
-
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/build_data.hpp>
+#include <raptor/build/hibf/kmer_union.hpp>
 
 namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-void loop_over_children(robin_hood::unordered_flat_set<size_t> & parent_kmers,
+void loop_over_children(kmer_union & parent_kmers,
                         seqan3::interleaved_bloom_filter<> & ibf,
                         std::vector<int64_t> & ibf_positions,
                         lemon::ListDigraph::Node const & current_node,
@@ -7,11 +7,15 @@
 
 #pragma once
 
+#include <sstream>
+
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
+#include <raptor/build/atomic_insertion_agent.hpp>
 #include <raptor/build/call_parallel_on_bins.hpp>
 #include <raptor/dna4_traits.hpp>
+#include <raptor/huge_pages.hpp>
 #include <raptor/index.hpp>
 
 namespace raptor
@@ -41,50 +45,145 @@ public:
             return raptor_index<index_structure::ibf_compressed>{std::move(tmp)};
     }
 
-private:
-    build_arguments const * const arguments{nullptr};
-
-    template <typename view_t>
-    auto construct(view_t && hash_filter_view) const
+    /*!\brief Builds all `arguments.parts` parts of a partitioned index while reading and hashing the input only once.
+     * \param part_of_hash Returns the part a minimiser belongs to.
+     */
+    template <typename part_function_t>
+    [[nodiscard]] auto parts(part_function_t && part_of_hash) const
     {
-        using sequence_file_t = seqan3::sequence_file_input<dna4_traits, seqan3::fields<seqan3::field::seq>>;
+        auto tmp = construct_parts(part_of_hash);
 
-        assert(arguments != nullptr);
+        if constexpr (!compressed)
+        {
+            return tmp;
+        }
+        else
+        {
+            std::vector<raptor_index<index_structure::ibf_compressed>> result{};
+            result.reserve(tmp.size());
+            for (auto & index : tmp)
+                result.emplace_back(std::move(index));
+            return result;
+        }
+    }
 
-        raptor_index<> index{*arguments};
+    /*!\brief Inserts the bins of `arguments` into the existing `index` as bins `first_bin`, `first_bin + 1`, ...
+     * \details
+     * The IBF of `index` must already have enough bins. Used by `raptor update`.
+     */
+    template <typename view_t = int>
+    void append(raptor_index<> & index, size_t const first_bin, view_t && hash_filter_view = 0) const
+    {
+        assert(arguments != nullptr);
 
         auto hash_view = [&] ()
         {
             if constexpr (std::same_as<view_t, int>)
-            {
-                return seqan3::views::minimiser_hash(arguments->shape,
-                                                     seqan3::window_size{arguments->window_size},
-                                                     seqan3::seed{adjust_seed(arguments->shape.count())});
-            }
+                return minimiser_view();
             else
-            {
-                return seqan3::views::minimiser_hash(arguments->shape,
-                                                     seqan3::window_size{arguments->window_size},
-                                                     seqan3::seed{adjust_seed(arguments->shape.count())})
-                       | hash_filter_view;
-            }
+                return minimiser_view() | hash_filter_view;
         };
 
-        auto worker = [&] (auto && zipped_view, auto &&)
+        atomic_insertion_agent const agent{index.ibf()};
+        insert(hash_view, [&agent, first_bin] (uint64_t const value, size_t const bin_number)
         {
-            auto & ibf = index.ibf();
+            agent.emplace(value, seqan3::bin_index{first_bin + bin_number});
+        });
+    }
 
-            for (auto && [file_names, bin_number] : zipped_view)
-                for (auto && file_name : file_names)
-                    for (auto && [seq] : sequence_file_t{file_name})
-                        for (auto && value : seq | hash_view())
-                            ibf.emplace(value, seqan3::bin_index{bin_number});
+private:
+    build_arguments const * const arguments{nullptr};
+
+    // Calls `emplace(minimiser, bin_number)` for all minimisers of all bins. `hash_view()` returns the view to apply.
+    // Large files are split into chunks that are processed in parallel, hence `emplace` must be thread safe.
+    template <typename hash_view_t, typename emplace_t>
+    void insert(hash_view_t && hash_view, emplace_t && emplace) const
+    {
+        using sequence_file_t = seqan3::sequence_file_input<dna4_traits, seqan3::fields<seqan3::field::seq>>;
+
+        auto worker = [&] (sequence_file_chunk const & chunk, size_t const bin_number)
+        {
+            uint64_t sequence_count{};
+            uint64_t minimiser_count{};
+
+            auto process = [&] (sequence_file_t && fin)
+            {
+                for (auto && [seq] : fin)
+                {
+                    ++sequence_count;
+                    for (auto && value : seq | hash_view())
+                    {
+                        emplace(value, bin_number);
+                        ++minimiser_count;
+                    }
+                }
+            };
+
+            switch (chunk.format)
+            {
+                case chunk_format::fasta:
+                    process(sequence_file_t{std::istringstream{read_chunk(chunk)}, seqan3::format_fasta{}});
+                    break;
+                case chunk_format::fastq:
+                    process(sequence_file_t{std::istringstream{read_chunk(chunk)}, seqan3::format_fastq{}});
+                    break;
+                default:
+                    process(sequence_file_t{chunk.file_name});
+            }
+
+            arguments->metrics.reads += sequence_count;
+            arguments->metrics.minimisers += minimiser_count;
         };
 
-        call_parallel_on_bins(worker, *arguments);
+        call_parallel_on_chunks(worker, *arguments);
+    }
+
+    auto minimiser_view() const
+    {
+        return seqan3::views::minimiser_hash(arguments->shape,
+                                            seqan3::window_size{arguments->window_size},
+                                            seqan3::seed{adjust_seed(arguments->shape.count())});
+    }
+
+    template <typename view_t>
+    auto construct(view_t && hash_filter_view) const
+    {
+        assert(arguments != nullptr);
+
+        raptor_index<> index{*arguments};
+        if (arguments->huge_pages)
+            advise_huge_pages(index.ibf());
+
+        append(index, 0u, std::forward<view_t>(hash_filter_view));
 
         return index;
     }
+
+    template <typename part_function_t>
+    auto construct_parts(part_function_t & part_of_hash) const
+    {
+        assert(arguments != nullptr);
+
+        std::vector<raptor_index<>> indices{};
+        std::vector<atomic_insertion_agent> agents{};
+        indices.reserve(arguments->parts);
+        agents.reserve(arguments->parts);
+        for (size_t part = 0; part < arguments->parts; ++part)
+        {
+            indices.emplace_back(*arguments);
+            if (arguments->huge_pages)
+                advise_huge_pages(indices.back().ibf());
+            agents.emplace_back(indices.back().ibf());
+        }
+
+        insert([this] () { return minimiser_view(); },
+               [&agents, &part_of_hash] (uint64_t const value, size_t const bin_number)
+        {
+            agents[part_of_hash(value)].emplace(value, seqan3::bin_index{bin_number});
+        });
+
+        return indices;
+    }
 };
 
 } // namespace raptor
@@ -0,0 +1,313 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <robin_hood.h>
+
+namespace raptor
+{
+
+/*!\brief Counts how often each minimiser occurs, saturating at 254.
+ * \details
+ * Without a memory limit, the counts are stored in a hash table. Each distinct minimiser then needs more than
+ * 16 bytes, and the memory usage depends on the number of distinct minimisers.
+ *
+ * With a memory limit, the minimisers are collected in a buffer of `memory_limit / 8` values. When the buffer is full,
+ * it is sorted, and the distinct minimisers and their counts are written as a sorted run to `temp_directory`.
+ * for_each() merges the runs, at most `max_open_runs` at once. If there are more runs, they are first merged into
+ * fewer, larger runs. The buffers of the counter stay within `memory_limit`, independent of the input size; only the
+ * stream buffers of the open files come on top.
+ */
+class minimiser_counter
+{
+public:
+    //!\brief The largest count; higher counts are not needed for the cutoffs.
+    static constexpr uint8_t max_count{254u};
+
+    minimiser_counter() = default;
+    minimiser_counter(minimiser_counter const &) = delete;
+    minimiser_counter & operator=(minimiser_counter const &) = delete;
+    minimiser_counter(minimiser_counter &&) = default;
+    minimiser_counter & operator=(minimiser_counter &&) = default;
+
+    ~minimiser_counter()
+    {
+        remove_runs();
+    }
+
+    /*!\brief Construct a minimiser_counter.
+     * \param memory_limit The memory limit in bytes. `0` means no limit.
+     * \param temp_directory The directory to write sorted runs to. Only used if there is a memory limit.
+     */
+    explicit minimiser_counter(uint64_t const memory_limit, std::filesystem::path temp_directory = {}) :
+        capacity{memory_limit > 0u ? std::max<size_t>(1u, memory_limit / sizeof(uint64_t)) : 0u},
+        temp_directory{temp_directory.empty() ? std::filesystem::temp_directory_path() : std::move(temp_directory)}
+    {}
+
+    //!\brief Increments the count of `hash`.
+    void add(uint64_t const hash)
+    {
+        if (capacity == 0u)
+        {
+            uint8_t & count = table[hash];
+            count = std::min<uint8_t>(max_count, count + 1);
+            return;
+        }
+
+        // Grow like std::vector, but never beyond the memory limit.
+        if (buffer.size() == buffer.capacity())
+            buffer.reserve(std::min(capacity, std::max(initial_capacity, 2u * buffer.size())));
+
+        buffer.push_back(hash);
+
+        if (buffer.size() == capacity)
+            spill();
+    }
+
+    /*!\brief Calls `callback(hash, count)` for each distinct minimiser and resets the counter.
+     * \details
+     * With a memory limit, the minimisers are visited in ascending order. Without a limit, the order is unspecified.
+     */
+    template <typename callback_t>
+    void for_each(callback_t && callback)
+    {
+        if (capacity == 0u)
+        {
+            for (auto && [hash, count] : table)
+                callback(hash, count);
+            table.clear();
+        }
+        else if (runs.empty())
+        {
+            std::ranges::sort(buffer);
+            for_each_distinct(buffer, callback);
+            buffer.clear();
+        }
+        else
+        {
+            if (!buffer.empty())
+                spill();
+            merge_runs(callback);
+        }
+    }
+
+private:
+    //!\brief The first allocation of the buffer, unless the memory limit is smaller.
+    static constexpr size_t initial_capacity{1024u};
+
+    //!\brief How many runs are merged at once at most. Bounds the number of open files.
+    static constexpr size_t max_open_runs{64u};
+
+    //!\brief The smallest number of records read at once from a run, unless the memory limit is smaller.
+    static constexpr size_t min_block_records{64u};
+
+    //!\brief The size of a record in a run: the hash and the count.
+    static constexpr size_t record_size{sizeof(uint64_t) + sizeof(uint8_t)};
+
+    //!\brief How many minimisers are kept in memory. `0` if there is no memory limit.
+    size_t capacity{};
+    //!\brief Where the runs are written to.
+    std::filesystem::path temp_directory{};
+    //!\brief The minimisers not yet written to a run.
+    std::vector<uint64_t> buffer{};
+    //!\brief The sorted runs.
+    std::vector<std::filesystem::path> runs{};
+    //!\brief The counts if there is no memory limit.
+    robin_hood::unordered_map<uint64_t, uint8_t> table{};
+
+    //!\brief Calls `callback(hash, count)` for each distinct value of the sorted `values`.
+    template <typename callback_t>
+    static void for_each_distinct(std::vector<uint64_t> const & values, callback_t && callback)
+    {
+        for (auto it = values.begin(); it != values.end();)
+        {
+            auto const next = std::ranges::find_if(it, values.end(), [value = *it] (uint64_t const v)
+            {
+                return v != value;
+            });
+            callback(*it, static_cast<uint8_t>(std::min<size_t>(max_count, next - it)));
+            it = next;
+        }
+    }
+
+    //!\brief Returns a unique file name for the next run.
+    std::filesystem::path next_run_path() const
+    {
+        static std::atomic<uint64_t> run_id{};
+        return temp_directory / ("raptor_minimiser_" + std::to_string(getpid()) + '_' +
+                                 std::to_string(run_id++) + ".run");
+    }
+
+    //!\brief Opens a new run for writing.
+    static std::ofstream open_run(std::filesystem::path const & path)
+    {
+        std::ofstream run{path, std::ios::binary};
+        if (!run.good())
+            throw std::runtime_error{"Could not open " + path.string() + " for writing."}; // GCOVR_EXCL_LINE
+        return run;
+    }
+
+    //!\brief Appends a record to a run.
+    static void write_record(std::ofstream & run, uint64_t const hash, uint8_t const count)
+    {
+        run.write(reinterpret_cast<char const *>(&hash), sizeof(hash));
+        run.write(reinterpret_cast<char const *>(&count), sizeof(count));
+    }
+
+    //!\brief Writes the buffer as a sorted run.
+    void spill()
+    {
+        std::ranges::sort(buffer);
+
+        std::filesystem::path const path = next_run_path();
+        std::ofstream run = open_run(path);
+        runs.push_back(path);
+
+        for_each_distinct(buffer, [&run] (uint64_t const hash, uint8_t const count)
+        {
+            write_record(run, hash, count);
+        });
+
+        buffer.clear();
+    }
+
+    //!\brief Reads a run in blocks.
+    struct run_reader
+    {
+        std::ifstream stream;
+        std::vector<char> block;
+        size_t position{};
+        size_t size{};
+
+        //!\brief Reads the next record. Returns `false` at the end of the run.
+        bool next(uint64_t & hash, uint8_t & count)
+        {
+            if (position == size)
+            {
+                stream.read(block.data(), block.size());
+                size = static_cast<size_t>(stream.gcount()) / record_size * record_size;
+                position = 0u;
+                if (size == 0u)
+                    return false;
+            }
+
+            std::memcpy(&hash, block.data() + position, sizeof(hash));
+            std::memcpy(&count, block.data() + position + sizeof(hash), sizeof(count));
+            position += record_size;
+            return true;
+        }
+    };
+
+    /*!\brief k-way merge of the given runs.
+     * \param paths The runs to merge.
+     * \param memory The memory for the read blocks in bytes. It is split evenly between the runs.
+     * \param callback Called with each distinct minimiser and its summed count, in ascending order.
+     */
+    template <typename callback_t>
+    static void merge(std::span<std::filesystem::path const> const paths, size_t const memory, callback_t && callback)
+    {
+        size_t const block_size = std::max<size_t>(memory / paths.size() / record_size, 1u) * record_size;
+
+        std::vector<run_reader> readers(paths.size());
+        using entry_t = std::tuple<uint64_t, uint8_t, size_t>; // hash, count, reader
+        std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> queue{};
+
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            readers[i].stream.open(paths[i], std::ios::binary);
+            readers[i].block.resize(block_size);
+
+            uint64_t hash{};
+            uint8_t count{};
+            if (readers[i].next(hash, count))
+                queue.emplace(hash, count, i);
+        }
+
+        while (!queue.empty())
+        {
+            uint64_t const hash = std::get<0>(queue.top());
+            size_t total{};
+
+            // Sum the counts of `hash` in all runs.
+            while (!queue.empty() && std::get<0>(queue.top()) == hash)
+            {
+                auto const [current_hash, count, reader] = queue.top();
+                queue.pop();
+                total += count;
+
+                uint64_t next_hash{};
+                uint8_t next_count{};
+                if (readers[reader].next(next_hash, next_count))
+                    queue.emplace(next_hash, next_count, reader);
+            }
+
+            callback(hash, static_cast<uint8_t>(std::min<size_t>(max_count, total)));
+        }
+    }
+
+    //!\brief Merges all runs, in several passes if there are more than can be opened at once. Deletes the runs.
+    template <typename callback_t>
+    void merge_runs(callback_t && callback)
+    {
+        // The memory of the buffer is used for the read blocks instead.
+        size_t const memory = capacity * sizeof(uint64_t);
+        buffer = std::vector<uint64_t>{};
+
+        size_t const fan_in = std::clamp<size_t>(memory / (min_block_records * record_size), 2u, max_open_runs);
+
+        // Merge the oldest runs into a new run until the remaining runs can be merged at once.
+        // Since the counts saturate, merging in several passes gives the same counts.
+        while (runs.size() > fan_in)
+        {
+            std::vector<std::filesystem::path> const merged(runs.begin(), runs.begin() + fan_in);
+            std::filesystem::path const path = next_run_path();
+            std::ofstream run = open_run(path);
+            runs.push_back(path);
+
+            merge(merged, memory, [&run] (uint64_t const hash, uint8_t const count)
+            {
+                write_record(run, hash, count);
+            });
+            run.close();
+
+            std::error_code ec{};
+            for (auto const & merged_run : merged)
+                std::filesystem::remove(merged_run, ec);
+            runs.erase(runs.begin(), runs.begin() + fan_in);
+        }
+
+        merge(runs, memory, callback);
+        remove_runs();
+    }
+
+    //!\brief Deletes all runs.
+    void remove_runs() noexcept
+    {
+        std::error_code ec{};
+        for (auto const & run : runs)
+            std::filesystem::remove(run, ec);
+        runs.clear();
+    }
+};
+
+} // namespace raptor
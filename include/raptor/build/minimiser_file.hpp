@@ -0,0 +1,460 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace raptor
+{
+
+/*!\brief The format of `.minimiser` files.
+ * \details
+ * A `.minimiser` file stores the distinct minimisers of a bin in ascending order:
+ *
+ * | Field        | Size             | Description                                     |
+ * |--------------|------------------|-------------------------------------------------|
+ * | magic        | 8 bytes          | `RPTRMNMS`                                      |
+ * | version      | 4 bytes          | 1                                               |
+ * | block size   | 4 bytes          | Maximum number of minimisers per block          |
+ * | count        | 8 bytes          | Total number of minimisers                      |
+ * | blocks       |                  | Until the end of the file                       |
+ *
+ * Each block consists of the number of minimisers (4 bytes), the number of bytes of the encoded minimisers (4 bytes),
+ * and the encoded minimisers: the first minimiser and the differences between consecutive minimisers as varints
+ * (7 bits per byte, the highest bit signals that more bytes follow). Blocks can be decoded independently.
+ *
+ * Since the minimisers of a bin are dense in the hash space (the hashes of k-mers use at most 2k bits), the differences
+ * mostly need two to four bytes instead of eight.
+ *
+ * Files written by older versions of raptor contain unsorted raw 8-byte values without a header. They are still
+ * supported by raptor::minimiser_file_reader.
+ */
+struct minimiser_file
+{
+    //!\brief Identifies the format.
+    static constexpr char magic[8]{'R', 'P', 'T', 'R', 'M', 'N', 'M', 'S'};
+    //!\brief The current version.
+    static constexpr uint32_t version{1u};
+    //!\brief The default number of minimisers per block.
+    static constexpr uint32_t default_block_size{1u << 16};
+    //!\brief The size of the file header in bytes.
+    static constexpr size_t header_size{sizeof(magic) + 2u * sizeof(uint32_t) + sizeof(uint64_t)};
+    //!\brief The size of a block header in bytes.
+    static constexpr size_t block_header_size{2u * sizeof(uint32_t)};
+    //!\brief The maximum number of bytes of a varint-encoded 64 bit value.
+    static constexpr size_t max_varint_size{10u};
+
+    //!\brief Appends the varint encoding of `value` to `out`. Returns the position after the encoding.
+    static char * encode_varint(uint64_t value, char * out) noexcept
+    {
+        while (value >= 0x80u)
+        {
+            *out++ = static_cast<char>(value | 0x80u);
+            value >>= 7;
+        }
+        *out++ = static_cast<char>(value);
+        return out;
+    }
+
+    /*!\brief Decodes `count` delta-encoded values from `in` into `out`.
+     * \returns The position after the decoded values, or `nullptr` if the encoding exceeds `end`.
+     */
+    static char const * decode_block(char const * in, char const * const end, uint64_t * out, size_t const count) noexcept
+    {
+        uint64_t previous{};
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64_t value{};
+            unsigned shift{};
+            uint8_t byte{};
+
+            do
+            {
+                if (in == end)
+                    return nullptr;
+                byte = static_cast<uint8_t>(*in++);
+                value |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+                shift += 7u;
+            }
+            while (byte & 0x80u && shift < 64u);
+
+            previous += value;
+            out[i] = previous;
+        }
+
+        return in;
+    }
+};
+
+/*!\brief Writes a `.minimiser` file. The minimisers must be added in ascending order.
+ * \details
+ * The file is complete after close() is called or the writer is destroyed.
+ */
+class minimiser_file_writer
+{
+public:
+    minimiser_file_writer() = delete;
+    minimiser_file_writer(minimiser_file_writer const &) = delete;
+    minimiser_file_writer & operator=(minimiser_file_writer const &) = delete;
+    minimiser_file_writer(minimiser_file_writer &&) = default;
+    minimiser_file_writer & operator=(minimiser_file_writer &&) = default;
+
+    ~minimiser_file_writer()
+    {
+        if (stream.is_open())
+            close();
+    }
+
+    explicit minimiser_file_writer(std::filesystem::path const & path,
+                                   uint32_t const block_size = minimiser_file::default_block_size) :
+        stream{path, std::ios::binary},
+        block_size{block_size}
+    {
+        if (!stream.good())
+            throw std::runtime_error{"Could not open " + path.string() + " for writing."};
+        assert(block_size > 0u);
+
+        buffer.resize(block_size * minimiser_file::max_varint_size);
+        write_header();
+    }
+
+    //!\brief Adds a minimiser. Must not be smaller than the previous one. Duplicates are skipped.
+    void push_back(uint64_t const value)
+    {
+        if (count != 0u)
+        {
+            assert(value >= last);
+            if (value == last)
+                return;
+        }
+
+        position = minimiser_file::encode_varint(value - previous, position);
+        previous = value;
+        last = value;
+        ++block_count;
+        ++count;
+
+        if (block_count == block_size)
+            flush();
+    }
+
+    //!\brief Writes the remaining minimisers and the final header.
+    void close()
+    {
+        flush();
+        stream.seekp(0);
+        write_header();
+        stream.close();
+    }
+
+    //!\brief The number of minimisers written so far.
+    uint64_t size() const noexcept
+    {
+        return count;
+    }
+
+private:
+    std::ofstream stream{};
+    uint32_t block_size{};
+    std::vector<char> buffer{};
+    char * position{nullptr};
+    uint64_t previous{}; // The previous value in the current block.
+    uint64_t last{}; // The previous value in the file.
+    uint32_t block_count{};
+    uint64_t count{};
+
+    void write_header()
+    {
+        stream.write(minimiser_file::magic, sizeof(minimiser_file::magic));
+        stream.write(reinterpret_cast<char const *>(&minimiser_file::version), sizeof(minimiser_file::version));
+        stream.write(reinterpret_cast<char const *>(&block_size), sizeof(block_size));
+        stream.write(reinterpret_cast<char const *>(&count), sizeof(count));
+        position = buffer.data();
+    }
+
+    void flush()
+    {
+        if (block_count == 0u)
+            return;
+
+        uint32_t const bytes = static_cast<uint32_t>(position - buffer.data());
+        stream.write(reinterpret_cast<char const *>(&block_count), sizeof(block_count));
+        stream.write(reinterpret_cast<char const *>(&bytes), sizeof(bytes));
+        stream.write(buffer.data(), bytes);
+
+        // The next block starts from scratch, so that blocks can be decoded independently.
+        position = buffer.data();
+        previous = 0u;
+        block_count = 0u;
+    }
+};
+
+/*!\brief Reads a `.minimiser` file block by block.
+ * \details
+ * Also reads files without a header, i.e. raw 8-byte values, as written by older versions of raptor.
+ */
+class minimiser_file_reader
+{
+public:
+    minimiser_file_reader() = delete;
+    minimiser_file_reader(minimiser_file_reader const &) = delete;
+    minimiser_file_reader & operator=(minimiser_file_reader const &) = delete;
+    minimiser_file_reader(minimiser_file_reader &&) = default;
+    minimiser_file_reader & operator=(minimiser_file_reader &&) = default;
+    ~minimiser_file_reader() = default;
+
+    explicit minimiser_file_reader(std::filesystem::path const & path) : stream{path, std::ios::binary}, path{path}
+    {
+        if (!stream.good())
+            throw std::runtime_error{"Could not open " + path.string() + " for reading."};
+
+        char header[minimiser_file::header_size]{};
+        stream.read(header, sizeof(header));
+
+        if (static_cast<size_t>(stream.gcount()) == sizeof(header) &&
+            std::memcmp(header, minimiser_file::magic, sizeof(minimiser_file::magic)) == 0)
+        {
+            uint32_t version{};
+            std::memcpy(&version, header + sizeof(minimiser_file::magic), sizeof(version));
+            if (version != minimiser_file::version)
+                throw std::runtime_error{"Unsupported version " + std::to_string(version) + " of " + path.string()};
+            std::memcpy(&count, header + sizeof(minimiser_file::magic) + 2u * sizeof(uint32_t), sizeof(count));
+        }
+        else
+        {
+            is_legacy = true;
+            count = std::filesystem::file_size(path) / sizeof(uint64_t);
+            stream.clear();
+            stream.seekg(0);
+        }
+    }
+
+    /*!\brief Replaces the content of `values` with the next block of minimisers.
+     * \returns `false` if there are no more minimisers.
+     */
+    bool read_block(std::vector<uint64_t> & values)
+    {
+        return is_legacy ? read_legacy_block(values) : read_encoded_block(values);
+    }
+
+    //!\brief The number of minimisers in the file.
+    uint64_t size() const noexcept
+    {
+        return count;
+    }
+
+private:
+    std::ifstream stream{};
+    std::filesystem::path path{};
+    std::vector<char> buffer{};
+    uint64_t count{};
+    bool is_legacy{false};
+
+    //!\brief The number of values read at once from a file without header.
+    static constexpr size_t legacy_block_size{minimiser_file::default_block_size};
+
+    bool read_encoded_block(std::vector<uint64_t> & values)
+    {
+        uint32_t block_header[2]{};
+        stream.read(reinterpret_cast<char *>(block_header), minimiser_file::block_header_size);
+        if (stream.gcount() == 0)
+        {
+            values.clear();
+            return false;
+        }
+
+        if (static_cast<size_t>(stream.gcount()) != minimiser_file::block_header_size)
+            throw std::runtime_error{"The file " + path.string() + " is corrupted."};
+
+        auto const [block_count, bytes] = block_header;
+        buffer.resize(bytes);
+        stream.read(buffer.data(), bytes);
+        values.resize(block_count);
+
+        if (static_cast<size_t>(stream.gcount()) != bytes ||
+            minimiser_file::decode_block(buffer.data(), buffer.data() + bytes, values.data(), block_count) == nullptr)
+            throw std::runtime_error{"The file " + path.string() + " is corrupted."};
+
+        return block_count > 0u;
+    }
+
+    bool read_legacy_block(std::vector<uint64_t> & values)
+    {
+        values.resize(legacy_block_size);
+        stream.read(reinterpret_cast<char *>(values.data()), legacy_block_size * sizeof(uint64_t));
+        values.resize(static_cast<size_t>(stream.gcount()) / sizeof(uint64_t));
+        return !values.empty();
+    }
+};
+
+/*!\brief Reads and decodes the blocks of one or more `.minimiser` files in a background thread.
+ * \details
+ * The producer thread reads ahead up to `capacity` blocks, such that reading and decoding overlaps with the
+ * processing of the blocks, e.g., inserting them into an IBF. The producer mostly waits for I/O or for free slots,
+ * hence it does not need a core of its own. The block buffers are reused.
+ *
+ * Exceptions thrown by the producer, e.g. for a missing or corrupted file, are rethrown by next().
+ */
+class minimiser_block_reader
+{
+public:
+    minimiser_block_reader() = delete;
+    minimiser_block_reader(minimiser_block_reader const &) = delete;
+    minimiser_block_reader & operator=(minimiser_block_reader const &) = delete;
+    minimiser_block_reader(minimiser_block_reader &&) = delete;
+    minimiser_block_reader & operator=(minimiser_block_reader &&) = delete;
+
+    ~minimiser_block_reader()
+    {
+        {
+            std::lock_guard lock{mutex};
+            stopped = true;
+        }
+        not_full.notify_all();
+        producer.join();
+    }
+
+    //!\brief Starts reading the files `paths` in the given order.
+    template <typename paths_t>
+    explicit minimiser_block_reader(paths_t const & paths, size_t const capacity = default_capacity) :
+        paths(std::ranges::begin(paths), std::ranges::end(paths)),
+        capacity{std::max<size_t>(capacity, 1u)}
+    {
+        producer = std::thread{[this] () { produce(); }};
+    }
+
+    /*!\brief Replaces the content of `values` with the next block of minimisers.
+     * \returns `false` if all files have been read.
+     */
+    bool next(std::vector<uint64_t> & values)
+    {
+        std::unique_lock lock{mutex};
+        not_empty.wait(lock, [this] () { return !full_blocks.empty() || finished; });
+
+        if (full_blocks.empty())
+        {
+            if (exception)
+                std::rethrow_exception(std::exchange(exception, nullptr));
+            values.clear();
+            return false;
+        }
+
+        // The old content of `values` becomes a free buffer for the producer.
+        std::swap(values, full_blocks.front());
+        free_blocks.push_back(std::move(full_blocks.front()));
+        full_blocks.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    //!\brief The default number of blocks that are read ahead.
+    static constexpr size_t default_capacity{4u};
+
+private:
+    std::vector<std::filesystem::path> paths{};
+    size_t capacity{};
+    std::deque<std::vector<uint64_t>> full_blocks{};
+    std::vector<std::vector<uint64_t>> free_blocks{};
+    std::exception_ptr exception{};
+    bool finished{false};
+    bool stopped{false};
+    std::mutex mutex{};
+    std::condition_variable not_empty{};
+    std::condition_variable not_full{};
+    std::thread producer{};
+
+    void produce()
+    {
+        try
+        {
+            std::vector<uint64_t> block{};
+
+            for (auto const & path : paths)
+            {
+                minimiser_file_reader reader{path};
+
+                while (reader.read_block(block))
+                {
+                    std::unique_lock lock{mutex};
+                    not_full.wait(lock, [this] () { return full_blocks.size() < capacity || stopped; });
+
+                    if (stopped)
+                        return;
+
+                    full_blocks.push_back(std::move(block));
+                    if (!free_blocks.empty())
+                    {
+                        block = std::move(free_blocks.back());
+                        free_blocks.pop_back();
+                    }
+                    else
+                    {
+                        block = std::vector<uint64_t>{};
+                    }
+                    lock.unlock();
+                    not_empty.notify_one();
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard lock{mutex};
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock{mutex};
+            finished = true;
+        }
+        not_empty.notify_one();
+    }
+};
+
+/*!\brief Calls `callback(block)` for each block of minimisers in the `.minimiser` files `paths`.
+ * \details
+ * `block` is a `std::vector<uint64_t> const &`. The files are read in a background thread, see
+ * raptor::minimiser_block_reader.
+ */
+template <typename paths_t, typename callback_t>
+void for_each_minimiser_block(paths_t const & paths, callback_t && callback)
+{
+    minimiser_block_reader reader{paths};
+    std::vector<uint64_t> block{};
+
+    while (reader.next(block))
+        callback(std::as_const(block));
+}
+
+//!\brief Calls `callback(minimiser)` for each minimiser in the `.minimiser` file `path`.
+template <typename callback_t>
+void for_each_minimiser(std::filesystem::path const & path, callback_t && callback)
+{
+    minimiser_file_reader reader{path};
+    std::vector<uint64_t> values{};
+
+    while (reader.read_block(values))
+        for (uint64_t const value : values)
+            callback(value);
+}
+
+} // namespace raptor
@@ -0,0 +1,163 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace raptor
+{
+
+//!\brief The format of a sequence_file_chunk.
+enum class chunk_format
+{
+    whole_file, //!< Any sequence file, possibly compressed. Read via its file name.
+    fasta, //!< A range of records of an uncompressed FASTA file.
+    fastq //!< A range of records of an uncompressed FASTQ file.
+};
+
+//!\brief A part of a sequence file that can be processed independently of the rest of the file.
+struct sequence_file_chunk
+{
+    std::string file_name{};
+    chunk_format format{chunk_format::whole_file};
+    //!\brief The first byte of the chunk. Always the start of a record.
+    uint64_t begin{};
+    //!\brief One past the last byte of the chunk. The start of a record or the end of the file.
+    uint64_t end{};
+
+    //!\brief The size in bytes, used to schedule the largest chunks first.
+    uint64_t size() const noexcept
+    {
+        return end - begin;
+    }
+};
+
+//!\brief Uncompressed files larger than this are split into chunks of about this size.
+inline constexpr uint64_t default_chunk_size{64ULL * 1024ULL * 1024ULL};
+
+//!\cond
+namespace detail
+{
+
+/*!\brief Returns the first record start at or after `position`, or `end` if there is none.
+ * \details
+ * A FASTA record starts with a line starting with `>`. A line starting with `@` may be a FASTQ header or a quality
+ * line. Only a header is followed by the `+` line two lines later, hence FASTQ files must have four lines per record.
+ */
+inline uint64_t next_record_start(std::ifstream & stream, uint64_t const position, uint64_t const end, bool const is_fastq)
+{
+    constexpr auto max_line = std::numeric_limits<std::streamsize>::max();
+
+    // Skip to the first line start at or after `position`.
+    stream.clear();
+    stream.seekg(position - 1u);
+    stream.ignore(max_line, '\n');
+
+    while (stream)
+    {
+        uint64_t const line_start = static_cast<uint64_t>(stream.tellg());
+        int const first = stream.peek();
+
+        if (first == std::char_traits<char>::eof())
+            break;
+
+        if (!is_fastq && first == '>')
+            return line_start;
+
+        if (is_fastq && first == '@')
+        {
+            stream.ignore(max_line, '\n');
+            stream.ignore(max_line, '\n');
+            if (stream.peek() == '+')
+                return line_start;
+
+            stream.clear();
+            stream.seekg(line_start);
+        }
+
+        stream.ignore(max_line, '\n');
+    }
+
+    return end;
+}
+
+//!\brief Returns whether the first record of a FASTQ file has four lines.
+inline bool has_four_line_records(std::ifstream & stream)
+{
+    stream.clear();
+    stream.seekg(0);
+    stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    return stream.peek() == '+';
+}
+
+} // namespace detail
+//!\endcond
+
+/*!\brief Splits a sequence file into record-aligned chunks of about `chunk_size` bytes.
+ * \details
+ * Only uncompressed FASTA and FASTQ files (with four lines per record) larger than `chunk_size` are split. A chunk
+ * contains at least one record, hence a single record larger than `chunk_size` is not split. All other files,
+ * including compressed ones, result in a single chunk of format chunk_format::whole_file covering the file.
+ */
+inline std::vector<sequence_file_chunk> split_sequence_file(std::string const & file_name,
+                                                            uint64_t const chunk_size = default_chunk_size)
+{
+    std::error_code ec{};
+    uint64_t const file_size = std::filesystem::file_size(file_name, ec);
+    std::vector<sequence_file_chunk> chunks{{file_name, chunk_format::whole_file, 0u, ec ? 0u : file_size}};
+
+    if (ec || chunk_size == 0u || file_size <= chunk_size)
+        return chunks;
+
+    std::ifstream stream{file_name, std::ios::binary};
+    int const first = stream.peek();
+    bool const is_fastq = first == '@';
+
+    // Compressed files start with a magic number instead.
+    if ((first != '>' && !is_fastq) || (is_fastq && !detail::has_four_line_records(stream)))
+        return chunks;
+
+    chunk_format const format = is_fastq ? chunk_format::fastq : chunk_format::fasta;
+    chunks.clear();
+
+    uint64_t begin{};
+    while (begin < file_size)
+    {
+        uint64_t const end = begin + chunk_size >= file_size
+                           ? file_size
+                           : detail::next_record_start(stream, begin + chunk_size, file_size, is_fastq);
+        chunks.push_back({file_name, format, begin, end});
+        begin = end;
+    }
+
+    return chunks;
+}
+
+//!\brief Returns the content of a chunk of format chunk_format::fasta or chunk_format::fastq.
+inline std::string read_chunk(sequence_file_chunk const & chunk)
+{
+    std::ifstream stream{chunk.file_name, std::ios::binary};
+    stream.seekg(chunk.begin);
+
+    std::string content(chunk.size(), '\0');
+    stream.read(content.data(), content.size());
+
+    if (static_cast<uint64_t>(stream.gcount()) != chunk.size())
+        throw std::runtime_error{"Could not read " + chunk.file_name + '.'};
+
+    return content;
+}
+
+} // namespace raptor
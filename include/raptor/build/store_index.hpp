@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <filesystem>
 
 #include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
@@ -20,11 +21,18 @@ namespace raptor
 template <typename data_t, typename arguments_t>
 static inline void store_index(std::filesystem::path const & path,
                                raptor_index<data_t> const & index,
-                               arguments_t const &)
+                               arguments_t const & arguments)
 {
-    std::ofstream os{path, std::ios::binary};
-    cereal::BinaryOutputArchive oarchive{os};
-    oarchive(index);
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        std::ofstream os{path, std::ios::binary};
+        cereal::BinaryOutputArchive oarchive{os};
+        oarchive(index);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    if constexpr (requires { arguments.metrics; })
+        arguments.metrics.add_stage("store", std::chrono::duration<double>(end - start).count());
 }
 
 template <seqan3::data_layout layout, typename arguments_t>
@@ -39,9 +47,7 @@ static inline void store_index(std::filesystem::path const & path,
                                                                  arguments.bin_path,
                                                                  std::move(ibf)};
 
-    std::ofstream os{path, std::ios::binary};
-    cereal::BinaryOutputArchive oarchive{os};
-    oarchive(index);
+    store_index(path, index, arguments);
 }
 
 } // namespace raptor
@@ -0,0 +1,173 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace raptor
+{
+
+/*!\brief Runs tasks on a fixed number of threads. Tasks may spawn and wait for further tasks.
+ * \details
+ * Tasks are added to a group via run(). wait() blocks until all tasks of the group are finished. While waiting, the
+ * calling thread executes queued tasks itself, hence nested waits do not deadlock and no thread idles as long as there
+ * is work. Waiting threads take the most recently added task, which usually belongs to their own group; idle worker
+ * threads take the oldest task, which usually is the largest remaining unit of work.
+ *
+ * With `threads == 1`, no worker threads are started and all tasks are executed by the thread calling wait().
+ */
+class task_scheduler
+{
+public:
+    //!\brief A set of tasks that can be waited for.
+    class task_group
+    {
+    public:
+        task_group() = default;
+        task_group(task_group const &) = delete;
+        task_group & operator=(task_group const &) = delete;
+        task_group(task_group &&) = delete;
+        task_group & operator=(task_group &&) = delete;
+        ~task_group() = default;
+
+    private:
+        friend task_scheduler;
+
+        size_t pending{};
+        std::exception_ptr exception{};
+    };
+
+    task_scheduler() : task_scheduler{1u}
+    {}
+
+    task_scheduler(task_scheduler const &) = delete;
+    task_scheduler & operator=(task_scheduler const &) = delete;
+    task_scheduler(task_scheduler &&) = delete;
+    task_scheduler & operator=(task_scheduler &&) = delete;
+
+    ~task_scheduler()
+    {
+        {
+            std::lock_guard lock{mutex};
+            stopped = true;
+        }
+        changed.notify_all();
+
+        for (auto & worker : workers)
+            worker.join();
+    }
+
+    //!\brief Starts `threads - 1` worker threads. The thread calling wait() is the remaining one.
+    explicit task_scheduler(size_t const threads)
+    {
+        for (size_t i = 1; i < threads; ++i)
+            workers.emplace_back([this] () { work(); });
+    }
+
+    //!\brief Adds `task` to `group`. It may be executed immediately by another thread.
+    void run(task_group & group, std::function<void()> task)
+    {
+        {
+            std::lock_guard lock{mutex};
+            ++group.pending;
+            queue.push_back({&group, std::move(task)});
+        }
+        changed.notify_one();
+    }
+
+    /*!\brief Executes queued tasks until all tasks of `group` are finished.
+     * \details
+     * If a task of `group` threw an exception, the first one is rethrown after all tasks of `group` are finished.
+     */
+    void wait(task_group & group)
+    {
+        std::unique_lock lock{mutex};
+
+        while (group.pending > 0u)
+        {
+            if (queue.empty())
+            {
+                changed.wait(lock);
+                continue;
+            }
+
+            entry current = std::move(queue.back());
+            queue.pop_back();
+            execute(current, lock);
+        }
+
+        if (group.exception)
+            std::rethrow_exception(std::exchange(group.exception, nullptr));
+    }
+
+private:
+    //!\brief A task and the group it belongs to.
+    struct entry
+    {
+        task_group * group;
+        std::function<void()> task;
+    };
+
+    std::vector<std::thread> workers{};
+    std::deque<entry> queue{};
+    std::mutex mutex{};
+    //!\brief Signalled when a task is added or finished, or when the scheduler stops.
+    std::condition_variable changed{};
+    bool stopped{false};
+
+    //!\brief Runs a task without holding the lock.
+    void execute(entry & current, std::unique_lock<std::mutex> & lock)
+    {
+        lock.unlock();
+
+        std::exception_ptr exception{};
+        try
+        {
+            current.task();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+        current.task = nullptr; // Destroy captures outside the lock.
+
+        lock.lock();
+        if (exception && !current.group->exception)
+            current.group->exception = exception;
+
+        // Notify all: a waiting thread may wait for exactly this group.
+        if (--current.group->pending == 0u)
+            changed.notify_all();
+    }
+
+    void work()
+    {
+        std::unique_lock lock{mutex};
+
+        while (true)
+        {
+            changed.wait(lock, [this] () { return stopped || !queue.empty(); });
+
+            if (stopped)
+                return;
+
+            entry current = std::move(queue.front());
+            queue.pop_front();
+            execute(current, lock);
+        }
+    }
+};
+
+} // namespace raptor
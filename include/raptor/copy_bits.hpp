@@ -0,0 +1,31 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace raptor::detail
+{
+
+//!\brief Copies `length` bits starting at bit `source` of `from` to bit `target` of `to`. The target bits must be 0.
+inline void copy_bits(uint64_t const * const from, size_t source, uint64_t * const to, size_t target, size_t length)
+{
+    while (length > 0u)
+    {
+        size_t const chunk = std::min<size_t>({length, 64u - (source & 63u), 64u - (target & 63u)});
+        uint64_t const mask = chunk == 64u ? ~0ULL : (1ULL << chunk) - 1u;
+        to[target >> 6] |= ((from[source >> 6] >> (source & 63u)) & mask) << (target & 63u);
+        source += chunk;
+        target += chunk;
+        length -= chunk;
+    }
+}
+
+} // namespace raptor::detail
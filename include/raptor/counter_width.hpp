@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <seqan3/std/ranges>
+
+namespace raptor
+{
+
+/*!\brief Returns an upper bound for the number of minimisers of any record in `records`.
+ * \details
+ * A record of length `n` has at most `n - shape_size + 1` minimisers. The records must be tuple-like with the
+ * sequence as last element, as returned by seqan3::sequence_file_input with the fields `id` and `seq`.
+ */
+template <std::ranges::input_range records_t>
+size_t max_minimiser_count(records_t && records, size_t const shape_size)
+{
+    size_t result{};
+
+    for (auto && [id, seq] : records)
+    {
+        (void) id;
+        size_t const length = std::ranges::size(seq);
+        result = std::max(result, length < shape_size ? 0u : length - shape_size + 1u);
+    }
+
+    return result;
+}
+
+/*!\brief Calls `callback` with the narrowest counter type that can hold `max_count`.
+ * \details
+ * The counter type is passed as `std::type_identity<value_t>`, i.e. `callback` is instantiated for `uint8_t`,
+ * `uint16_t`, and `uint32_t`.
+ * Narrow counters reduce the memory traffic for short reads; wide counters cannot overflow for long reads.
+ */
+template <typename callback_t>
+void dispatch_counter_width(size_t const max_count, callback_t && callback)
+{
+    if (max_count <= std::numeric_limits<uint8_t>::max())
+        callback(std::type_identity<uint8_t>{});
+    else if (max_count <= std::numeric_limits<uint16_t>::max())
+        callback(std::type_identity<uint16_t>{});
+    else
+        callback(std::type_identity<uint32_t>{});
+}
+
+} // namespace raptor
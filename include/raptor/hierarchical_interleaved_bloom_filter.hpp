@@ -11,6 +11,9 @@
 
 #include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
 
+#include <raptor/counter_width.hpp>
+#include <raptor/prefetching_counting_agent.hpp>
+
 #ifndef RAPTOR_HIBF_HAS_COUNT
 #define RAPTOR_HIBF_HAS_COUNT 0
 #endif
@@ -122,20 +125,24 @@ public:
     //!\brief The underlying user bins.
     user_bins user_bins;
 
-    //!\brief Returns a membership_agent to be used for counting.
-    membership_agent membership_agent() const
+    /*!\brief Returns a membership_agent to be used for counting.
+     * \param prefetch_distance Used for counting in the individual IBFs, see raptor::prefetching_counting_agent.
+     */
+    membership_agent membership_agent(size_t const prefetch_distance = auto_prefetch_distance) const
     {
-        return typename hierarchical_interleaved_bloom_filter<data_layout_mode>::membership_agent{*this};
+        return typename hierarchical_interleaved_bloom_filter<data_layout_mode>::membership_agent{*this,
+                                                                                                  prefetch_distance};
     }
 
 #if RAPTOR_HIBF_HAS_COUNT
     /*!\brief Returns a counting_agent_type to be used for counting.
      * \tparam value_t The type to use for the counters; must model std::integral.
+     * \param prefetch_distance Used for counting in the individual IBFs, see raptor::prefetching_counting_agent.
      */
     template <std::integral value_t = uint16_t>
-    counting_agent_type<value_t> counting_agent() const
+    counting_agent_type<value_t> counting_agent(size_t const prefetch_distance = auto_prefetch_distance) const
     {
-        return counting_agent_type<value_t>{*this};
+        return counting_agent_type<value_t>{*this, prefetch_distance};
     }
 #endif
 
@@ -169,6 +176,7 @@ private:
      * \details
      * Assume we look up a bin `b` in IBF `i`, i.e. `ibf_bin_to_filename_position[i][b]`.
      * If `-1` is returned, bin `b` is a merged bin, and there is no filename, we need to look into the lower level IBF.
+     * If `-2` is returned, bin `b` belonged to a removed user bin and is empty, see raptor::remove_user_bins.
      * Otherwise, the returned value `j` can be used to access the corresponding filename `user_bin_filenames[j]`.
      */
     std::vector<std::vector<int64_t>> ibf_bin_to_filename_position{};
@@ -211,14 +219,14 @@ public:
     }
 
     /*!\brief Returns a view over the user bin filenames for the `ibf_idx`th IBF.
-     *        An empty string is returned for merged bins.
+     *        An empty string is returned for merged and removed bins.
      */
     auto operator[](size_t const ibf_idx) const
     {
         return ibf_bin_to_filename_position[ibf_idx]
                | std::views::transform([this] (int64_t i)
                  {
-                    if (i == -1)
+                    if (i < 0)
                         return std::string{};
                     else
                         return user_bin_filenames[i];
@@ -285,14 +293,18 @@ private:
     //!\brief A pointer to the augmented hierarchical_interleaved_bloom_filter.
     hibf_t const * const hibf_ptr{nullptr};
 
+    //!\brief The prefetch distance used for counting in the individual IBFs.
+    size_t const prefetch_distance{auto_prefetch_distance};
+
     //!\brief Helper for recursive membership querying.
-    template <std::ranges::forward_range value_range_t>
+    template <std::integral value_t, std::ranges::forward_range value_range_t>
     void bulk_contains_impl(value_range_t && values, int64_t const ibf_idx, size_t const threshold)
     {
-        auto agent = hibf_ptr->ibf_vector[ibf_idx].template counting_agent<uint16_t>();
+        auto agent = make_counting_agent<value_t>(hibf_ptr->ibf_vector[ibf_idx], prefetch_distance);
         auto & result = agent.bulk_count(values);
+        ++ibfs_visited;
 
-        uint16_t sum{};
+        size_t sum{}; // Split bins may exceed the range of value_t.
 
         for (size_t bin{}; bin < result.size(); ++bin)
         {
@@ -300,10 +312,10 @@ private:
 
             auto const current_filename_index = hibf_ptr->user_bins.filename_index(ibf_idx, bin);
 
-            if (current_filename_index < 0) // merged bin
+            if (current_filename_index < 0) // merged or removed bin
             {
-                if (sum >= threshold)
-                    bulk_contains_impl(values, hibf_ptr->next_ibf_id[ibf_idx][bin], threshold);
+                if (sum >= threshold && current_filename_index == -1)
+                    bulk_contains_impl<value_t>(values, hibf_ptr->next_ibf_id[ibf_idx][bin], threshold);
                 sum = 0u;
             }
             else if (bin + 1u == result.size() || // last bin
@@ -330,15 +342,22 @@ public:
     /*!\brief Construct a membership_agent for an existing hierarchical_interleaved_bloom_filter.
      * \private
      * \param hibf The hierarchical_interleaved_bloom_filter.
+     * \param prefetch_distance_ The prefetch distance used for counting in the individual IBFs.
      */
-    explicit membership_agent(hibf_t const & hibf) :
-        hibf_ptr(std::addressof(hibf))
+    explicit membership_agent(hibf_t const & hibf, size_t const prefetch_distance_ = auto_prefetch_distance) :
+        hibf_ptr(std::addressof(hibf)), prefetch_distance{prefetch_distance_}
     {}
     //!\}
 
     //!\brief Stores the result of bulk_contains().
     std::vector<int64_t> result_buffer;
 
+    //!\brief The number of IBFs queried by all calls to bulk_contains().
+    size_t ibfs_visited{};
+
+    //!\brief The number of values looked up in an IBF by all calls to bulk_contains(). Each level counts separately.
+    size_t lookups{};
+
     /*!\name Lookup
      * \{
      */
@@ -367,7 +386,14 @@ public:
 
         result_buffer.clear();
 
-        bulk_contains_impl(values, 0, threshold);
+        // No technical bin can have more hits than there are values.
+        size_t const value_count = std::ranges::distance(values);
+        size_t const ibfs_visited_before{ibfs_visited};
+        dispatch_counter_width(value_count, [&] <typename value_t> (std::type_identity<value_t>)
+        {
+            bulk_contains_impl<value_t>(values, 0, threshold);
+        });
+        lookups += (ibfs_visited - ibfs_visited_before) * value_count;
 
         std::ranges::sort(result_buffer); // TODO: necessary?
 
@@ -395,11 +421,14 @@ private:
     //!\brief A pointer to the augmented hierarchical_interleaved_bloom_filter.
     hibf_t const * const hibf_ptr{nullptr};
 
+    //!\brief The prefetch distance used for counting in the individual IBFs.
+    size_t const prefetch_distance{auto_prefetch_distance};
+
     //!\brief Helper for recursive bulk counting.
     template <std::ranges::forward_range value_range_t>
     void bulk_count_impl(value_range_t && values, int64_t const ibf_idx, size_t const threshold)
     {
-        auto agent = hibf_ptr->ibf_vector[ibf_idx].template counting_agent<value_t>();
+        auto agent = make_counting_agent<value_t>(hibf_ptr->ibf_vector[ibf_idx], prefetch_distance);
         auto & result = agent.bulk_count(values);
 
         value_t sum{};
@@ -409,9 +438,9 @@ private:
             sum += result[bin];
             auto const current_filename_index = hibf_ptr->user_bins.filename_index(ibf_idx, bin);
 
-            if (current_filename_index < 0) // merged bin
+            if (current_filename_index < 0) // merged or removed bin
             {
-                if (sum >= threshold)
+                if (sum >= threshold && current_filename_index == -1)
                     bulk_count_impl(values, hibf_ptr->next_ibf_id[ibf_idx][bin], threshold);
                 sum = 0u;
             }
@@ -439,9 +468,12 @@ public:
     /*!\brief Construct a counting_agent_type for an existing hierarchical_interleaved_bloom_filter.
      * \private
      * \param hibf The hierarchical_interleaved_bloom_filter.
+     * \param prefetch_distance_ The prefetch distance used for counting in the individual IBFs.
      */
-    explicit counting_agent_type(hibf_t const & hibf) :
-        hibf_ptr(std::addressof(hibf)), result_buffer(hibf_ptr->user_bins.num_user_bins())
+    explicit counting_agent_type(hibf_t const & hibf, size_t const prefetch_distance_ = auto_prefetch_distance) :
+        hibf_ptr(std::addressof(hibf)),
+        prefetch_distance{prefetch_distance_},
+        result_buffer(hibf_ptr->user_bins.num_user_bins())
     {}
     //!\}
 
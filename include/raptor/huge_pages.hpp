@@ -0,0 +1,97 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+#include <raptor/hierarchical_interleaved_bloom_filter.hpp>
+
+namespace raptor
+{
+
+//!\brief The size of a transparent huge page on x86_64 and aarch64 (with 4 KiB base pages).
+inline constexpr uint64_t huge_page_size{2ULL * 1024ULL * 1024ULL};
+
+/*!\brief Asks the kernel to back `[data, data + bytes)` with transparent huge pages.
+ * \details
+ * Only the huge page aligned part of the range is advised. Since the bit vectors are usually written before this
+ * function is called (zero initialisation or deserialisation), the existing pages are collapsed synchronously via
+ * `MADV_COLLAPSE` if the kernel supports it (Linux 6.1+). Otherwise, `khugepaged` collapses them in the background.
+ * All errors are ignored: huge pages are a performance optimisation and not available on every system.
+ */
+inline void advise_huge_pages([[maybe_unused]] void const * const data, [[maybe_unused]] uint64_t const bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    uintptr_t const begin = (reinterpret_cast<uintptr_t>(data) + huge_page_size - 1u) & ~(huge_page_size - 1u);
+    uintptr_t const end = (reinterpret_cast<uintptr_t>(data) + bytes) & ~(huge_page_size - 1u);
+
+    if (begin >= end)
+        return;
+
+    void * const address = reinterpret_cast<void *>(begin);
+    size_t const length = end - begin;
+
+    madvise(address, length, MADV_HUGEPAGE);
+#if defined(MADV_COLLAPSE)
+    madvise(address, length, MADV_COLLAPSE);
+#endif
+#endif
+}
+
+//!\brief Advises huge pages for the bit vector of an uncompressed IBF. Compressed IBFs are left unchanged.
+template <seqan3::data_layout data_layout_mode>
+void advise_huge_pages(seqan3::interleaved_bloom_filter<data_layout_mode> & ibf)
+{
+    if constexpr (data_layout_mode == seqan3::data_layout::uncompressed)
+    {
+        auto const & data = ibf.raw_data();
+        advise_huge_pages(data.data(), (data.size() + 63u) / 64u * sizeof(uint64_t));
+    }
+}
+
+//!\brief Advises huge pages for all IBFs of an HIBF.
+template <seqan3::data_layout data_layout_mode>
+void advise_huge_pages(hierarchical_interleaved_bloom_filter<data_layout_mode> & hibf)
+{
+    for (auto & ibf : hibf.ibf_vector)
+        advise_huge_pages(ibf);
+}
+
+//!\brief Returns the number of bytes of the process' anonymous memory that is backed by transparent huge pages.
+inline uint64_t huge_page_bytes()
+{
+    uint64_t result{};
+#if defined(__linux__)
+    // Line format: "AnonHugePages:    409600 kB"
+    std::ifstream smaps{"/proc/self/smaps_rollup"};
+    std::string line{};
+    while (std::getline(smaps, line))
+    {
+        if (line.starts_with("AnonHugePages:"))
+        {
+            size_t const value_start = line.find_first_not_of(' ', 14u);
+            if (value_start != std::string::npos)
+                std::from_chars(line.data() + value_start, line.data() + line.size(), result);
+            result *= 1024u;
+            break;
+        }
+    }
+#endif
+    return result;
+}
+
+} // namespace raptor
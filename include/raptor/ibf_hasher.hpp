@@ -0,0 +1,77 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+namespace raptor::detail
+{
+
+/*!\brief Maps values to bit positions of an IBF, exactly like seqan3::interleaved_bloom_filter.
+ * \details
+ * seqan3 does not expose its hashing. Agents that access the bit vector of an IBF directly use this class, so that
+ * there is a single copy of seqan3's hashing in raptor. raptor/test/api/prefetching_counting_agent_test.cpp and
+ * raptor/test/api/atomic_insertion_agent_test.cpp compare the agents to seqan3.
+ */
+class ibf_hasher
+{
+public:
+    //!\brief The seeds used by seqan3::interleaved_bloom_filter. The i-th hash function uses the i-th seed.
+    static constexpr std::array<size_t, 5> seeds{13572355802537770549ULL,
+                                                 13043817825332782213ULL,
+                                                 10650232656628343401ULL,
+                                                 16499269484942379435ULL,
+                                                 4893150838803335377ULL};
+
+    ibf_hasher() = default; //!< Defaulted.
+
+    //!\brief Construct an ibf_hasher for the given IBF.
+    template <seqan3::data_layout data_layout_mode>
+    explicit ibf_hasher(seqan3::interleaved_bloom_filter<data_layout_mode> const & ibf) noexcept :
+        bin_size{ibf.bin_size()},
+        hash_shift{static_cast<size_t>(std::countl_zero(bin_size))},
+        technical_bins{((ibf.bin_count() + 63u) >> 6) << 6}
+    {}
+
+    //!\brief Returns the bit position of bin 0 for `h` and the hash function with seed `seed`.
+    //!\details Same as seqan3::interleaved_bloom_filter::hash_and_fit.
+    size_t hash_and_fit(size_t h, size_t const seed) const noexcept
+    {
+        h *= seed;
+        h ^= h >> hash_shift;
+        h *= 11400714819323198485ULL;
+#ifdef __SIZEOF_INT128__
+        h = static_cast<uint64_t>((static_cast<__uint128_t>(h) * static_cast<__uint128_t>(bin_size)) >> 64);
+#else
+        h %= bin_size;
+#endif
+        h *= technical_bins;
+        return h;
+    }
+
+    //!\brief The number of bins rounded up to a multiple of 64.
+    size_t technical_bin_count() const noexcept
+    {
+        return technical_bins;
+    }
+
+private:
+    //!\brief The size of each Bloom filter in bits.
+    size_t bin_size{};
+    //!\brief Shift value used for hashing.
+    size_t hash_shift{};
+    //!\brief The number of bins rounded up to a multiple of 64.
+    size_t technical_bins{};
+};
+
+} // namespace raptor::detail
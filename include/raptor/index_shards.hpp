@@ -0,0 +1,73 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace raptor
+{
+
+/*!\brief Returns the path of shard `shard` of a sharded index.
+ * \details
+ * A sharded index consists of the files `<index_file>_shard_0`, `<index_file>_shard_1`, ... Each shard is a complete
+ * IBF over a consecutive range of user bins and can be loaded, searched, or rebuilt on its own. The global number of
+ * a user bin is its number within its shard plus the number of user bins in all previous shards.
+ */
+inline std::filesystem::path shard_path(std::filesystem::path const & index_file, size_t const shard)
+{
+    std::filesystem::path result{index_file};
+    result += "_shard_" + std::to_string(shard);
+    return result;
+}
+
+//!\brief Returns the number of consecutive shards `<index_file>_shard_0`, `<index_file>_shard_1`, ... that exist.
+inline size_t shard_count(std::filesystem::path const & index_file)
+{
+    size_t result{};
+    while (std::filesystem::exists(shard_path(index_file, result)))
+        ++result;
+    return result;
+}
+
+/*!\brief Removes the shards `<index_file>_shard_<first>`, `<index_file>_shard_<first + 1>`, ... of an earlier build.
+ * \details
+ * raptor search prefers shards over an unsharded index, hence every build must remove the shards it did not write.
+ */
+inline void remove_shards(std::filesystem::path const & index_file, size_t first = 0u)
+{
+    while (std::filesystem::remove(shard_path(index_file, first)))
+        ++first;
+}
+
+/*!\brief Splits `bins` user bins into at most `shards` consecutive ranges `[first, last)`.
+ * \details
+ * Except for the end of the last range, all boundaries are multiples of 64. Hence, the shards have as many technical
+ * bins as the unsharded index, and they need the same amount of memory with the same bin size. The 64-bin blocks are
+ * distributed evenly. If there are fewer blocks than `shards`, each range consists of one block.
+ */
+inline std::vector<std::pair<size_t, size_t>> shard_ranges(size_t const bins, size_t const shards)
+{
+    size_t const blocks{(bins + 63u) >> 6};
+    size_t const count{std::min(shards, blocks)};
+    std::vector<std::pair<size_t, size_t>> result{};
+
+    for (size_t shard = 0; shard < count; ++shard)
+    {
+        size_t const first = (blocks * shard / count) << 6;
+        size_t const last = std::min(bins, (blocks * (shard + 1u) / count) << 6);
+        result.emplace_back(first, last);
+    }
+
+    return result;
+}
+
+} // namespace raptor
@@ -0,0 +1,60 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <future>
+#include <vector>
+
+#include <raptor/copy_bits.hpp>
+#include <raptor/index.hpp>
+
+namespace raptor
+{
+
+/*!\brief Copies all bins of `ibf` to the bins `[first_bin, first_bin + ibf.bin_count())` of `result`.
+ * \param[in,out] result The merged IBF. The target bins must be empty.
+ * \param[in] ibf The IBF to copy. Must have the same bin size and number of hash functions as `result`.
+ * \param[in] first_bin The first target bin.
+ * \param[in] threads The number of threads. Each thread copies a contiguous range of rows.
+ * \details
+ * No value is rehashed: each row starts at a word boundary, hence row `r` of `ibf` is copied to row `r` of `result`,
+ * shifted by `first_bin` bits. Threads write to distinct rows and need no synchronisation.
+ */
+inline void merge_into(index_structure::ibf & result,
+                       index_structure::ibf const & ibf,
+                       size_t const first_bin,
+                       size_t const threads)
+{
+    size_t const rows{ibf.bin_size()};
+    size_t const from_words{(ibf.bin_count() + 63u) >> 6};
+    size_t const to_words{(result.bin_count() + 63u) >> 6};
+    size_t const bins{ibf.bin_count()};
+    uint64_t const * const from{ibf.raw_data().data()};
+    uint64_t * const to{result.raw_data().data()};
+
+    auto worker = [&] (size_t const start, size_t const end)
+    {
+        for (size_t row = start; row < end; ++row)
+            detail::copy_bits(from + row * from_words, 0u, to + row * to_words, first_bin, bins);
+    };
+
+    std::vector<std::future<void>> tasks{};
+    size_t const rows_per_thread{rows / threads};
+
+    for (size_t i = 0; i < threads; ++i)
+    {
+        size_t const start = rows_per_thread * i;
+        size_t const end = i == (threads - 1u) ? rows : rows_per_thread * (i + 1u);
+        tasks.emplace_back(std::async(std::launch::async, worker, start, end));
+    }
+
+    for (auto && task : tasks)
+        task.get();
+}
+
+} // namespace raptor
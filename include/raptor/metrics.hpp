@@ -0,0 +1,256 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace raptor
+{
+
+//!\brief Returns the peak resident set size of the process in bytes.
+inline uint64_t peak_rss() noexcept
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024u; // KiB
+#endif
+}
+
+/*!\brief Collects timings and counts of `raptor build` and `raptor search` and writes them as JSON (`--metrics`).
+ * \details
+ * Stages are identified by name and listed in the order they are first recorded. The time of a stage is the sum of
+ * all recorded durations. Additionally, the peak RSS at the end of the stage and, if recorded, the time spent by each
+ * thread are reported.
+ *
+ * All member functions are thread safe.
+ */
+class metrics
+{
+public:
+    metrics() = default;
+    metrics(metrics const &) = delete;
+    metrics & operator=(metrics const &) = delete;
+    metrics(metrics &&) = delete;
+    metrics & operator=(metrics &&) = delete;
+    ~metrics() = default;
+
+    //!\brief Number of processed reads (search) or sequences (build).
+    std::atomic<uint64_t> reads{};
+    //!\brief Number of processed minimisers.
+    std::atomic<uint64_t> minimisers{};
+    //!\brief Number of bytes of the input files.
+    std::atomic<uint64_t> bytes{};
+    //!\brief Number of minimisers looked up in an IBF. For the HIBF, each level counts separately.
+    std::atomic<uint64_t> lookups{};
+    //!\brief Number of IBFs visited when querying an HIBF.
+    std::atomic<uint64_t> ibfs_visited{};
+    //!\brief Number of temporary files the k-mers of merged bins were written to because of `--memory-limit`.
+    std::atomic<uint64_t> spilled_files{};
+
+    //!\brief Adds `seconds` to the stage `name` and records the peak RSS.
+    void add_stage(std::string const & name, double const seconds)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stage_data & data = stage(name);
+        data.seconds += seconds;
+        data.peak_rss = peak_rss();
+    }
+
+    //!\brief Adds `seconds` to the time that thread `thread_id` spent in stage `name`.
+    void add_thread_time(std::string const & name, size_t const thread_id, double const seconds)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stage_data & data = stage(name);
+        if (data.thread_seconds.size() <= thread_id)
+            data.thread_seconds.resize(thread_id + 1u, 0.0);
+        data.thread_seconds[thread_id] += seconds;
+        data.peak_rss = peak_rss();
+    }
+
+    //!\brief Adds `seconds` to the time that the calling thread spent in stage `name`.
+    void add_thread_time(std::string const & name, double const seconds)
+    {
+        size_t thread_id{};
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            thread_id = thread_ids.try_emplace(std::this_thread::get_id(), thread_ids.size()).first->second;
+        }
+        add_thread_time(name, thread_id, seconds);
+    }
+
+    /*!\brief Adds hardware counter `values` (event name and count) of thread `thread_id` to `scope`.
+     * \details Scopes and events are listed in the order they are first recorded.
+     */
+    void add_hardware_counters(std::string const & scope,
+                               size_t const thread_id,
+                               std::vector<std::pair<std::string, uint64_t>> const & values)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto scope_it = std::ranges::find(hardware_counters, scope, &hardware_scope::first);
+        if (scope_it == hardware_counters.end())
+            scope_it = hardware_counters.emplace(hardware_counters.end(), scope, hardware_scope::second_type{});
+
+        for (auto const & [event, value] : values)
+        {
+            auto & events = scope_it->second;
+            auto event_it = std::ranges::find(events, event, &hardware_event::first);
+            if (event_it == events.end())
+                event_it = events.emplace(events.end(), event, std::vector<uint64_t>{});
+
+            auto & per_thread = event_it->second;
+            if (per_thread.size() <= thread_id)
+                per_thread.resize(thread_id + 1u, 0u);
+            per_thread[thread_id] += value;
+        }
+    }
+
+    //!\brief Writes the metrics as JSON to `path`. `command` is either "build" or "search".
+    void write(std::filesystem::path const & path, std::string const & command) const
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        double const wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        auto per_second = [wall_time] (uint64_t const value)
+        {
+            return wall_time > 0.0 ? value / wall_time : 0.0;
+        };
+        auto per_read = [this] (uint64_t const value)
+        {
+            return reads > 0u ? static_cast<double>(value) / reads : 0.0;
+        };
+
+        std::ofstream out{path};
+        out << std::fixed << std::setprecision(6);
+        out << "{\n"
+            << "  \"command\": \"" << command << "\",\n"
+            << "  \"wall_time\": " << wall_time << ",\n"
+            << "  \"peak_rss\": " << peak_rss() << ",\n"
+            << "  \"stages\": [";
+
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            auto const & [name, data] = stages[i];
+            out << (i == 0u ? "\n" : ",\n")
+                << "    {\n"
+                << "      \"name\": \"" << name << "\",\n"
+                << "      \"time\": " << data.seconds << ",\n"
+                << "      \"peak_rss\": " << data.peak_rss << ",\n"
+                << "      \"thread_times\": [";
+            for (size_t thread = 0; thread < data.thread_seconds.size(); ++thread)
+                out << (thread == 0u ? "" : ", ") << data.thread_seconds[thread];
+            out << "]\n"
+                << "    }";
+        }
+
+        out << (stages.empty() ? "],\n" : "\n  ],\n")
+            << "  \"counts\": {\n"
+            << "    \"reads\": " << reads << ",\n"
+            << "    \"minimisers\": " << minimisers << ",\n"
+            << "    \"bytes\": " << bytes << ",\n"
+            << "    \"lookups\": " << lookups << ",\n"
+            << "    \"ibfs_visited\": " << ibfs_visited << ",\n"
+            << "    \"spilled_files\": " << spilled_files << "\n"
+            << "  },\n"
+            << "  \"per_read\": {\n"
+            << "    \"minimisers\": " << per_read(minimisers) << ",\n"
+            << "    \"lookups\": " << per_read(lookups) << ",\n"
+            << "    \"ibfs_visited\": " << per_read(ibfs_visited) << "\n"
+            << "  },\n"
+            << "  \"rates\": {\n"
+            << "    \"reads_per_second\": " << per_second(reads) << ",\n"
+            << "    \"minimisers_per_second\": " << per_second(minimisers) << ",\n"
+            << "    \"bytes_per_second\": " << per_second(bytes) << "\n"
+            << "  }";
+
+        if (!hardware_counters.empty())
+            write_hardware_counters(out);
+
+        out << "\n}\n";
+    }
+
+private:
+    //!\brief The recorded data of a single stage.
+    struct stage_data
+    {
+        double seconds{};
+        uint64_t peak_rss{};
+        std::vector<double> thread_seconds{};
+    };
+
+    //!\brief The name of a hardware event and its count per thread.
+    using hardware_event = std::pair<std::string, std::vector<uint64_t>>;
+    //!\brief The name of a scope and its events.
+    using hardware_scope = std::pair<std::string, std::vector<hardware_event>>;
+
+    //!\brief Writes the "hardware_counters" object. The mutex must be held.
+    void write_hardware_counters(std::ofstream & out) const
+    {
+        auto total = [] (std::vector<hardware_event> const & events, std::string const & name) -> uint64_t
+        {
+            auto it = std::ranges::find(events, name, &hardware_event::first);
+            return it == events.end() ? 0u : std::accumulate(it->second.begin(), it->second.end(), uint64_t{});
+        };
+
+        out << ",\n  \"hardware_counters\": {";
+        for (size_t i = 0; i < hardware_counters.size(); ++i)
+        {
+            auto const & [scope, events] = hardware_counters[i];
+            out << (i == 0u ? "\n" : ",\n") << "    \"" << scope << "\": {\n";
+            for (auto const & [event, per_thread] : events)
+            {
+                out << "      \"" << event << "\": {\"total\": " << total(events, event) << ", \"threads\": [";
+                for (size_t thread = 0; thread < per_thread.size(); ++thread)
+                    out << (thread == 0u ? "" : ", ") << per_thread[thread];
+                out << "]},\n";
+            }
+            uint64_t const cycles = total(events, "cycles");
+            out << "      \"ipc\": " << (cycles > 0u ? static_cast<double>(total(events, "instructions")) / cycles
+                                                      : 0.0) << "\n"
+                << "    }";
+        }
+        out << "\n  }";
+    }
+
+    //!\brief Returns the data of stage `name`. Adds the stage if it does not exist yet. The mutex must be held.
+    stage_data & stage(std::string const & name)
+    {
+        auto it = std::ranges::find(stages, name, &std::pair<std::string, stage_data>::first);
+        if (it == stages.end())
+            return stages.emplace_back(name, stage_data{}).second;
+        return it->second;
+    }
+
+    //!\brief Stages in the order they were first recorded.
+    std::vector<std::pair<std::string, stage_data>> stages{};
+    //!\brief Hardware counters per scope in the order they were first recorded.
+    std::vector<hardware_scope> hardware_counters{};
+    //!\brief Maps threads to consecutive IDs for add_thread_time(name, seconds).
+    std::unordered_map<std::thread::id, size_t> thread_ids{};
+    //!\brief The time the metrics were created. Used for the wall time and the rates.
+    std::chrono::steady_clock::time_point const start_time{std::chrono::steady_clock::now()};
+    //!\brief Guards all members except the counters.
+    mutable std::mutex mutex{};
+};
+
+} // namespace raptor
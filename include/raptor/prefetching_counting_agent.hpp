@@ -0,0 +1,219 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <bit>
+#include <limits>
+
+#include <seqan3/std/ranges>
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+#include <raptor/ibf_hasher.hpp>
+
+namespace raptor
+{
+
+//!\brief Passing this value as prefetch distance picks the distance based on the IBF, see prefetching_counting_agent.
+inline constexpr size_t auto_prefetch_distance{std::numeric_limits<size_t>::max()};
+
+/*!\brief Counts the occurrences of values in an uncompressed IBF while prefetching the words of upcoming values.
+ * \tparam value_t The type of the counters; must model std::integral.
+ * \details
+ * The [seqan3::interleaved_bloom_filter::counting_agent_type](https://docs.seqan.de/seqan/3.1.0/classseqan3_1_1interleaved__bloom__filter_1_1counting__agent__type.html)
+ * hashes a value right before it accesses the bit vector. Each value causes `hash_function_count` independent
+ * random accesses, which are almost always cache misses for large indices.
+ *
+ * This agent hashes value `i + d` and prefetches the corresponding cache lines before it processes value `i`.
+ * Hence, the memory accesses of up to `d` values overlap. The hashing is identical to the one of the
+ * seqan3::interleaved_bloom_filter, and so are the results.
+ *
+ * With `d = 0`, no prefetching is done. With `d = raptor::auto_prefetch_distance`, prefetching is disabled if the
+ * IBF fits into the last level cache, otherwise `d` is chosen such that about 16 cache lines are requested at
+ * the same time. This corresponds to the number of line fill buffers of current x86_64 and aarch64 cores.
+ *
+ * ### Thread safety
+ *
+ * Concurrent invocations of bulk_count() are not thread safe, please create an agent for each thread.
+ */
+template <std::integral value_t>
+class prefetching_counting_agent
+{
+private:
+    //!\brief The type of the augmented IBF.
+    using ibf_t = seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed>;
+
+    //!\brief IBFs smaller than this are assumed to be cache resident.
+    static constexpr size_t cache_resident_bytes{32ULL * 1024ULL * 1024ULL};
+
+    //!\brief At most this many cache lines are prefetched per hash function.
+    static constexpr size_t max_prefetched_lines{4u};
+
+    //!\brief The words of the IBF's bit vector.
+    uint64_t const * data{nullptr};
+    //!\brief The hashing of the IBF.
+    detail::ibf_hasher hasher{};
+    //!\brief The number of bins rounded up to a multiple of 64.
+    size_t technical_bins{};
+    //!\brief The number of words making up all bins for one hash value.
+    size_t bin_words{};
+    //!\brief The number of hash functions.
+    size_t hash_count{};
+    //!\brief The number of cache lines prefetched per hash function.
+    size_t prefetched_lines{};
+    //!\brief Mask of the valid bins in the last word.
+    uint64_t last_word_mask{};
+    //!\brief The prefetch distance.
+    size_t distance{};
+
+    //!\brief Ring buffer of the word indices of the values between the one being counted and the one being prefetched.
+    std::vector<size_t> word_indices{};
+
+    //!\brief Computes the word indices of `value` and stores them in `slot` of the ring buffer.
+    void hash_and_prefetch(size_t const value, size_t const slot) noexcept
+    {
+        size_t * const indices = word_indices.data() + slot * hash_count;
+
+        for (size_t i = 0; i < hash_count; ++i)
+        {
+            indices[i] = hasher.hash_and_fit(value, detail::ibf_hasher::seeds[i]) >> 6;
+#if defined(__GNUC__)
+            if (distance > 0u)
+                for (size_t line = 0; line < prefetched_lines; ++line)
+                    __builtin_prefetch(data + indices[i] + line * 8u, 0 /* read */, 0 /* no temporal locality */);
+#endif
+        }
+    }
+
+    //!\brief Adds the hits of the value stored in `slot` of the ring buffer.
+    void count(size_t const slot) noexcept
+    {
+        size_t const * const indices = word_indices.data() + slot * hash_count;
+
+        for (size_t word = 0; word < bin_words; ++word)
+        {
+            uint64_t bits{std::numeric_limits<uint64_t>::max()};
+            for (size_t i = 0; i < hash_count; ++i)
+                bits &= data[indices[i] + word];
+
+            if (word + 1u == bin_words)
+                bits &= last_word_mask;
+
+            for (size_t const offset = word << 6; bits != 0u; bits &= bits - 1u)
+                ++result_buffer[offset + std::countr_zero(bits)];
+        }
+    }
+
+public:
+    /*!\name Constructors, destructor and assignment
+     * \{
+     */
+    prefetching_counting_agent() = default; //!< Defaulted.
+    prefetching_counting_agent(prefetching_counting_agent const &) = default; //!< Defaulted.
+    prefetching_counting_agent & operator=(prefetching_counting_agent const &) = default; //!< Defaulted.
+    prefetching_counting_agent(prefetching_counting_agent &&) = default; //!< Defaulted.
+    prefetching_counting_agent & operator=(prefetching_counting_agent &&) = default; //!< Defaulted.
+    ~prefetching_counting_agent() = default; //!< Defaulted.
+
+    /*!\brief Construct a prefetching_counting_agent for an existing IBF.
+     * \param ibf The IBF. Must outlive the agent.
+     * \param prefetch_distance How many values to look ahead. See the class description.
+     */
+    explicit prefetching_counting_agent(ibf_t const & ibf, size_t const prefetch_distance = auto_prefetch_distance) :
+        data{ibf.raw_data().data()},
+        hasher{ibf},
+        technical_bins{hasher.technical_bin_count()},
+        bin_words{technical_bins >> 6},
+        hash_count{ibf.hash_function_count()},
+        prefetched_lines{std::min<size_t>((bin_words + 7u) / 8u, max_prefetched_lines)},
+        last_word_mask{ibf.bin_count() % 64u == 0u ? std::numeric_limits<uint64_t>::max()
+                                                   : (1ULL << (ibf.bin_count() % 64u)) - 1u},
+        result_buffer(ibf.bin_count())
+    {
+        assert(hash_count <= detail::ibf_hasher::seeds.size());
+
+        if (prefetch_distance != auto_prefetch_distance)
+            distance = prefetch_distance;
+        else if (ibf.bit_size() / 8u < cache_resident_bytes)
+            distance = 0u;
+        else
+            distance = std::max<size_t>(1u, 16u / (hash_count * prefetched_lines));
+
+        word_indices.resize((distance + 1u) * hash_count);
+    }
+    //!\}
+
+    //!\brief Stores the result of bulk_count().
+    seqan3::counting_vector<value_t> result_buffer;
+
+    //!\brief Returns the prefetch distance that is used.
+    size_t prefetch_distance() const noexcept
+    {
+        return distance;
+    }
+
+    /*!\name Counting
+     * \{
+     */
+    /*!\brief Counts the occurrences in each bin for all values in a range.
+     * \tparam value_range_t The type of the range of values. Must model std::ranges::input_range. The reference type
+     *                       must model std::unsigned_integral.
+     * \param[in] values The range of values to process.
+     *
+     * \attention The result of this function must always be bound via reference, e.g. `auto &`, to prevent copying.
+     * \attention Sequential calls to this function invalidate the previously returned reference.
+     */
+    template <std::ranges::input_range value_range_t>
+    [[nodiscard]] seqan3::counting_vector<value_t> const & bulk_count(value_range_t && values) & noexcept
+    {
+        assert(data != nullptr);
+
+        static_assert(std::unsigned_integral<std::ranges::range_value_t<value_range_t>>,
+                      "An individual value must be an unsigned integral.");
+
+        std::ranges::fill(result_buffer, static_cast<value_t>(0u));
+
+        size_t const slots{distance + 1u};
+        size_t hashed{};
+
+        for (auto && value : values)
+        {
+            hash_and_prefetch(value, hashed % slots);
+            ++hashed;
+
+            if (hashed > distance)
+                count((hashed - 1u - distance) % slots);
+        }
+
+        for (size_t i = hashed > distance ? hashed - distance : 0u; i < hashed; ++i)
+            count(i % slots);
+
+        return result_buffer;
+    }
+
+    // `bulk_count` cannot be called on a temporary, since the object the returned reference points to
+    // is immediately destroyed.
+    template <std::ranges::range value_range_t>
+    [[nodiscard]] seqan3::counting_vector<value_t> const & bulk_count(value_range_t && values) && noexcept = delete;
+    //!\}
+};
+
+/*!\brief Returns a raptor::prefetching_counting_agent for uncompressed IBFs, and the IBF's own counting agent for
+ *        compressed IBFs.
+ */
+template <std::integral value_t, seqan3::data_layout data_layout_mode>
+auto make_counting_agent(seqan3::interleaved_bloom_filter<data_layout_mode> const & ibf,
+                         size_t const prefetch_distance = auto_prefetch_distance)
+{
+    if constexpr (data_layout_mode == seqan3::data_layout::uncompressed)
+        return prefetching_counting_agent<value_t>{ibf, prefetch_distance};
+    else
+        return ibf.template counting_agent<value_t>();
+}
+
+} // namespace raptor
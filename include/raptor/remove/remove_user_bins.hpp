@@ -0,0 +1,210 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <seqan3/std/ranges>
+
+#include <raptor/copy_bits.hpp>
+#include <raptor/index.hpp>
+
+namespace raptor
+{
+
+/*!\brief Returns an IBF that only contains the given bins of `ibf`, in the given order.
+ * \details
+ * The bin size and the number of hash functions stay the same, hence no value is rehashed. The bits are copied row by
+ * row, and consecutive bins are copied up to 64 bits at once.
+ */
+inline index_structure::ibf compact_ibf(index_structure::ibf const & ibf, std::vector<size_t> const & bins)
+{
+    index_structure::ibf result{seqan3::bin_count{std::max<size_t>(1u, bins.size())},
+                                seqan3::bin_size{ibf.bin_size()},
+                                seqan3::hash_function_count{ibf.hash_function_count()}};
+
+    // Consecutive bins are copied together: (first old bin, first new bin, number of bins).
+    std::vector<std::tuple<size_t, size_t, size_t>> runs{};
+    for (size_t bin = 0; bin < bins.size(); ++bin)
+    {
+        if (!runs.empty() && std::get<0>(runs.back()) + std::get<2>(runs.back()) == bins[bin])
+            ++std::get<2>(runs.back());
+        else
+            runs.emplace_back(bins[bin], bin, 1u);
+    }
+
+    // Each row starts at a word boundary.
+    size_t const old_words{(ibf.bin_count() + 63u) >> 6};
+    size_t const new_words{(result.bin_count() + 63u) >> 6};
+    uint64_t const * from{ibf.raw_data().data()};
+    uint64_t * to{result.raw_data().data()};
+
+    for (size_t row = 0; row < ibf.bin_size(); ++row, from += old_words, to += new_words)
+        for (auto const [old_bin, new_bin, length] : runs)
+            detail::copy_bits(from, old_bin, to, new_bin, length);
+
+    return result;
+}
+
+/*!\brief Removes user bins from an IBF by clearing their bins.
+ * \param[in,out] ibf The IBF.
+ * \param[in] removed Whether each user bin is removed.
+ * \details
+ * The bins are kept, so the numbering of the other user bins does not change. The searches skip hits of removed user
+ * bins, see raptor::removed_user_bins.
+ */
+inline void remove_user_bins(index_structure::ibf & ibf, std::vector<bool> const & removed)
+{
+    std::vector<seqan3::bin_index> bins{};
+
+    for (size_t bin = 0; bin < removed.size(); ++bin)
+        if (removed[bin])
+            bins.push_back(seqan3::bin_index{bin});
+
+    if (!bins.empty())
+        ibf.clear(bins);
+}
+
+/*!\brief Removes user bins from an HIBF without changing its structure.
+ * \param[in,out] hibf The HIBF.
+ * \param[in] removed Whether each user bin is removed.
+ * \details
+ * The technical bins of removed user bins are cleared and marked as removed, see
+ * raptor::hierarchical_interleaved_bloom_filter::user_bins. Merged bins above them still contain their values until
+ * the HIBF is rebuilt, hence queries may still descend into lower-level IBFs, but never report a removed user bin.
+ */
+inline void remove_user_bins(index_structure::hibf & hibf, std::vector<bool> const & removed)
+{
+    std::vector<seqan3::bin_index> bins{};
+
+    for (size_t ibf_idx = 0; ibf_idx < hibf.ibf_vector.size(); ++ibf_idx)
+    {
+        bins.clear();
+        std::vector<int64_t> & filename_indices = hibf.user_bins.bin_indices_of_ibf(ibf_idx);
+
+        for (size_t bin = 0; bin < filename_indices.size(); ++bin)
+        {
+            if (filename_indices[bin] >= 0 && removed[filename_indices[bin]])
+            {
+                hibf.user_bins.filename_of_user_bin(filename_indices[bin]).clear();
+                filename_indices[bin] = -2;
+                bins.push_back(seqan3::bin_index{bin});
+            }
+        }
+
+        if (!bins.empty())
+            hibf.ibf_vector[ibf_idx].clear(bins);
+    }
+}
+
+/*!\brief Drops all removed user bins from an HIBF.
+ * \param[in,out] hibf The HIBF.
+ * \param[in,out] bin_path The user bins of the index. Entries of removed user bins are empty and dropped.
+ * \throws std::runtime_error If all user bins were removed.
+ * \details
+ * The technical bins of removed user bins are dropped from their IBFs. A lower-level IBF without any remaining user bin
+ * is dropped together with its merged bin. The remaining user bins and IBFs keep their order and are renumbered.
+ * An IBF only shrinks if it loses enough bins to need fewer multiples of 64 technical bins.
+ */
+inline void compact(index_structure::hibf & hibf, std::vector<std::vector<std::string>> & bin_path)
+{
+    size_t const ibf_count{hibf.ibf_vector.size()};
+
+    // Parents are visited before their children.
+    std::vector<size_t> order{0u};
+    for (size_t i = 0; i < order.size(); ++i)
+        for (size_t bin = 0; bin < hibf.next_ibf_id[order[i]].size(); ++bin)
+            if (hibf.user_bins.filename_index(order[i], bin) == -1)
+                order.push_back(hibf.next_ibf_id[order[i]][bin]);
+
+    // An IBF is kept if it contains a user bin, possibly below one of its merged bins.
+    std::vector<bool> is_kept(ibf_count, false);
+    for (size_t const ibf_idx : std::views::reverse(order))
+    {
+        for (size_t bin = 0; bin < hibf.next_ibf_id[ibf_idx].size() && !is_kept[ibf_idx]; ++bin)
+        {
+            int64_t const filename_index = hibf.user_bins.filename_index(ibf_idx, bin);
+            is_kept[ibf_idx] = filename_index >= 0 || (filename_index == -1 && is_kept[hibf.next_ibf_id[ibf_idx][bin]]);
+        }
+    }
+
+    if (!is_kept[0])
+        throw std::runtime_error{"All user bins were removed."};
+
+    std::vector<int64_t> new_ibf_idx(ibf_count, -1);
+    size_t new_ibf_count{};
+    for (size_t ibf_idx = 0; ibf_idx < ibf_count; ++ibf_idx)
+        if (is_kept[ibf_idx])
+            new_ibf_idx[ibf_idx] = new_ibf_count++;
+
+    std::vector<int64_t> new_user_bin_idx(bin_path.size(), -1);
+    size_t new_user_bin_count{};
+    for (size_t user_bin = 0; user_bin < bin_path.size(); ++user_bin)
+        if (!bin_path[user_bin].empty())
+            new_user_bin_idx[user_bin] = new_user_bin_count++;
+
+    index_structure::hibf result{};
+    result.ibf_vector.resize(new_ibf_count);
+    result.next_ibf_id.resize(new_ibf_count);
+    result.user_bins.set_ibf_count(new_ibf_count);
+    result.user_bins.set_user_bin_count(new_user_bin_count);
+
+    for (size_t ibf_idx = 0; ibf_idx < ibf_count; ++ibf_idx)
+    {
+        if (!is_kept[ibf_idx])
+            continue;
+
+        size_t const new_idx = new_ibf_idx[ibf_idx];
+        std::vector<size_t> bins{};
+        std::vector<int64_t> & filename_indices = result.user_bins.bin_indices_of_ibf(new_idx);
+
+        for (size_t bin = 0; bin < hibf.next_ibf_id[ibf_idx].size(); ++bin)
+        {
+            int64_t const filename_index = hibf.user_bins.filename_index(ibf_idx, bin);
+            int64_t const next_ibf = hibf.next_ibf_id[ibf_idx][bin];
+
+            if (filename_index >= 0)
+            {
+                result.next_ibf_id[new_idx].push_back(new_idx);
+                filename_indices.push_back(new_user_bin_idx[filename_index]);
+            }
+            else if (filename_index == -1 && is_kept[next_ibf])
+            {
+                result.next_ibf_id[new_idx].push_back(new_ibf_idx[next_ibf]);
+                filename_indices.push_back(-1);
+            }
+            else
+            {
+                continue;
+            }
+
+            bins.push_back(bin);
+        }
+
+        auto & ibf = hibf.ibf_vector[ibf_idx];
+        if (bins.size() == ibf.bin_count())
+            result.ibf_vector[new_idx] = std::move(ibf);
+        else
+            result.ibf_vector[new_idx] = compact_ibf(ibf, bins);
+        ibf = index_structure::hibf::ibf_t{};
+    }
+
+    for (size_t user_bin = 0; user_bin < hibf.user_bins.num_user_bins(); ++user_bin)
+        if (new_user_bin_idx[user_bin] >= 0)
+            result.user_bins.filename_of_user_bin(new_user_bin_idx[user_bin]) =
+                std::move(hibf.user_bins.filename_of_user_bin(user_bin));
+
+    std::erase_if(bin_path, [] (std::vector<std::string> const & file_names) { return file_names.empty(); });
+    hibf = std::move(result);
+}
+
+} // namespace raptor
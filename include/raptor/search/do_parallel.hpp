@@ -8,31 +8,64 @@
 #pragma once
 
 #include <chrono>
+#include <concepts>
 #include <future>
 #include <vector>
 
+#include <raptor/argument_parsing/search_arguments.hpp>
+#include <raptor/search/numa_topology.hpp>
+
 namespace raptor
 {
 
+/*!\brief Splits the records into `arguments.threads` batches and calls `worker(start, end)` for each in parallel.
+ * \details
+ * If the worker accepts a third argument, it is called with the index of the thread as `worker(start, end, i)`.
+ * If `arguments.numa` is not numa_policy::none, thread `i` is pinned to NUMA node `i % node_count`.
+ * The elapsed time is added to `compute_time` and, together with the time of each thread, to `arguments.metrics`.
+ */
 template <typename algorithm_t>
-void do_parallel(algorithm_t && worker, size_t const num_records, size_t const threads, double & compute_time)
+void do_parallel(algorithm_t && worker,
+                 size_t const num_records,
+                 search_arguments const & arguments,
+                 double & compute_time)
 {
     auto start = std::chrono::high_resolution_clock::now();
-    std::vector<decltype(std::async(std::launch::async, worker, size_t{}, size_t{}))> tasks;
+    std::vector<std::future<void>> tasks;
+    size_t const threads = arguments.threads;
     size_t const records_per_thread = num_records / threads;
+    numa_policy const numa = arguments.numa;
 
     for (size_t i = 0; i < threads; ++i)
     {
         size_t const start = records_per_thread * i;
         size_t const end = i == (threads-1) ? num_records: records_per_thread * (i+1);
-        tasks.emplace_back(std::async(std::launch::async, worker, start, end));
+        tasks.emplace_back(std::async(std::launch::async, [&worker, &arguments, numa, i, start, end] ()
+        {
+            if (numa != numa_policy::none)
+            {
+                numa_topology const & topology = numa_topology::system();
+                topology.pin_to_node(topology.node_of_thread(i));
+            }
+            auto thread_start = std::chrono::high_resolution_clock::now();
+            if constexpr (std::invocable<algorithm_t &, size_t, size_t, size_t>)
+                worker(start, end, i);
+            else
+                worker(start, end);
+            auto thread_end = std::chrono::high_resolution_clock::now();
+            arguments.metrics.add_thread_time("compute",
+                                              i,
+                                              std::chrono::duration<double>(thread_end - thread_start).count());
+        }));
     }
 
     for (auto && task : tasks)
         task.wait();
 
     auto end = std::chrono::high_resolution_clock::now();
-    compute_time += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    double const elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    compute_time += elapsed;
+    arguments.metrics.add_stage("compute", elapsed);
 }
 
 } // namespace raptor
@@ -10,38 +10,59 @@
 #include <chrono>
 
 #include <raptor/argument_parsing/search_arguments.hpp>
+#include <raptor/huge_pages.hpp>
 #include <raptor/index.hpp>
+#include <raptor/search/numa_topology.hpp>
 
 namespace raptor
 {
 
 template <typename index_t>
-void load_index(index_t & index, search_arguments const & arguments, size_t const part, double & index_io_time)
+void load_index(index_t & index,
+                search_arguments const & arguments,
+                std::filesystem::path const & index_file,
+                double & index_io_time)
 {
-    std::filesystem::path index_file{arguments.index_file};
-    index_file += "_" + std::to_string(part);
-
     std::ifstream is{index_file, std::ios::binary};
     cereal::BinaryInputArchive iarchive{is};
+    numa_memory_guard const memory_guard{arguments.numa};
 
     auto start = std::chrono::high_resolution_clock::now();
     iarchive(index);
+    if (arguments.huge_pages)
+        advise_huge_pages(index.ibf());
     auto end = std::chrono::high_resolution_clock::now();
 
-    index_io_time += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    double const elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    index_io_time += elapsed;
+    arguments.metrics.add_stage("index_io", elapsed);
+}
+
+template <typename index_t>
+void load_index(index_t & index, search_arguments const & arguments, size_t const part, double & index_io_time)
+{
+    std::filesystem::path index_file{arguments.index_file};
+    index_file += "_" + std::to_string(part);
+    load_index(index, arguments, index_file, index_io_time);
 }
 
+// With numa_policy::replicate, the index is placed on `node`.
 template <typename index_t>
-void load_index(index_t & index, search_arguments const & arguments, double & index_io_time)
+void load_index(index_t & index, search_arguments const & arguments, double & index_io_time, size_t const node = 0u)
 {
     std::ifstream is{arguments.index_file, std::ios::binary};
     cereal::BinaryInputArchive iarchive{is};
+    numa_memory_guard const memory_guard{arguments.numa, node};
 
     auto start = std::chrono::high_resolution_clock::now();
     iarchive(index);
+    if (arguments.huge_pages)
+        advise_huge_pages(index.ibf());
     auto end = std::chrono::high_resolution_clock::now();
 
-    index_io_time += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    double const elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    index_io_time += elapsed;
+    arguments.metrics.add_stage("index_io", elapsed);
 }
 
 } // namespace raptor
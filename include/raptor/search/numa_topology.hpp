@@ -0,0 +1,111 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace raptor
+{
+
+//!\brief Determines how the index is placed in memory on systems with multiple NUMA nodes.
+enum class numa_policy
+{
+    none,       //!< Let the operating system decide (first touch by the loading thread).
+    interleave, //!< Interleave the pages of the index across all nodes.
+    replicate   //!< Load one copy of the index per node.
+};
+
+/*!\brief The NUMA nodes of the system and the CPUs belonging to them.
+ * \details
+ * The topology is read from `/sys/devices/system/node`. If this information is not available, e.g. on non-Linux
+ * systems, the system is treated as a single node and all memory policy calls are no-ops.
+ */
+class numa_topology
+{
+public:
+    numa_topology() = default;
+    numa_topology(numa_topology const &) = default;
+    numa_topology & operator=(numa_topology const &) = default;
+    numa_topology(numa_topology &&) = default;
+    numa_topology & operator=(numa_topology &&) = default;
+    ~numa_topology() = default;
+
+    //!\brief Returns the topology of the running system. The topology is read only once.
+    static numa_topology const & system();
+
+    //!\brief Returns the number of nodes that have CPUs. Always at least 1.
+    size_t node_count() const noexcept
+    {
+        return node_ids.empty() ? 1u : node_ids.size();
+    }
+
+    //!\brief Worker threads are distributed round-robin over the nodes.
+    size_t node_of_thread(size_t const thread_id) const noexcept
+    {
+        return thread_id % node_count();
+    }
+
+    //!\brief Restricts the calling thread to the CPUs of `node`.
+    void pin_to_node(size_t const node) const;
+
+    //!\brief Interleaves all future allocations of the calling thread across all nodes.
+    void interleave_memory() const;
+
+    //!\brief Places all future allocations of the calling thread on `node`.
+    void bind_memory(size_t const node) const;
+
+    //!\brief Restores the default memory policy of the calling thread.
+    void reset_memory() const;
+
+    //!\brief Returns the free memory of `node` in bytes.
+    uint64_t free_memory(size_t const node) const;
+
+    //!\brief Returns the node the calling thread was pinned to via pin_to_node(). Defaults to 0.
+    static size_t current_node() noexcept;
+
+private:
+    //!\brief The system IDs of the nodes with CPUs. These need not be contiguous.
+    std::vector<size_t> node_ids{};
+    //!\brief The CPUs of each node.
+    std::vector<std::vector<size_t>> node_cpus{};
+};
+
+/*!\brief Applies the memory policy for loading an index and restores the default policy on destruction.
+ * \details
+ * numa_policy::interleave interleaves the pages, numa_policy::replicate places them on `node`.
+ */
+class numa_memory_guard
+{
+public:
+    numa_memory_guard() = delete;
+    numa_memory_guard(numa_memory_guard const &) = delete;
+    numa_memory_guard & operator=(numa_memory_guard const &) = delete;
+    numa_memory_guard(numa_memory_guard &&) = delete;
+    numa_memory_guard & operator=(numa_memory_guard &&) = delete;
+
+    explicit numa_memory_guard(numa_policy const policy_, size_t const node = 0u) : policy{policy_}
+    {
+        if (policy == numa_policy::interleave)
+            numa_topology::system().interleave_memory();
+        else if (policy == numa_policy::replicate)
+            numa_topology::system().bind_memory(node);
+    }
+
+    ~numa_memory_guard()
+    {
+        if (policy != numa_policy::none)
+            numa_topology::system().reset_memory();
+    }
+
+private:
+    numa_policy policy{numa_policy::none};
+};
+
+} // namespace raptor
@@ -0,0 +1,98 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace raptor
+{
+
+//!\brief The parts of the search worker that are measured by raptor::perf_counters.
+enum class perf_scope : uint8_t
+{
+    hashing,   //!< Computing the minimisers of a read.
+    counting,  //!< Querying the IBF or HIBF.
+    threshold, //!< Computing the threshold and evaluating the counts.
+    output     //!< Formatting and writing the result.
+};
+
+/*!\brief Hardware performance counters of the calling thread, attributed to raptor::perf_scope.
+ * \details
+ * Uses `perf_event_open` to count cycles, instructions, cache misses, dTLB load misses, and branch misses of the
+ * calling thread in user space. Events that are not supported by the CPU or kernel are skipped. If no event can be
+ * opened, e.g. on non-Linux systems, because of `/proc/sys/kernel/perf_event_paranoid`, or inside a container,
+ * available() returns `false` and all member functions are no-ops.
+ *
+ * Each call to enter() or leave() reads the counters once, hence the overhead is a few system calls per read.
+ * The counters are only opened if `enable` is `true`.
+ */
+class perf_counters
+{
+public:
+    //!\brief The number of scopes.
+    static constexpr size_t scope_count{4u};
+    //!\brief The number of events.
+    static constexpr size_t event_count{5u};
+
+    //!\brief Names of the scopes, in the order of raptor::perf_scope.
+    static constexpr std::array<char const *, scope_count> scope_names{"hashing", "counting", "threshold", "output"};
+    //!\brief Names of the events.
+    static constexpr std::array<char const *, event_count> event_names{"cycles",
+                                                                       "instructions",
+                                                                       "cache_misses",
+                                                                       "dtlb_load_misses",
+                                                                       "branch_misses"};
+
+    perf_counters() = default;
+    perf_counters(perf_counters const &) = delete;
+    perf_counters & operator=(perf_counters const &) = delete;
+    perf_counters(perf_counters &&) = delete;
+    perf_counters & operator=(perf_counters &&) = delete;
+    ~perf_counters();
+
+    //!\brief Opens the counters for the calling thread if `enable` is `true`.
+    explicit perf_counters(bool const enable);
+
+    //!\brief Whether at least one event could be opened.
+    bool available() const noexcept
+    {
+        return !event_ids.empty();
+    }
+
+    //!\brief Attributes the events since the last call to the current scope, and makes `scope` the current scope.
+    void enter(perf_scope const scope);
+
+    //!\brief Attributes the events since the last call to the current scope. Afterwards, no scope is active.
+    void leave();
+
+    //!\brief Returns the name and value of each opened event of `scope`.
+    std::vector<std::pair<std::string, uint64_t>> values(perf_scope const scope) const;
+
+private:
+    //!\brief File descriptor of the group leader.
+    int leader_fd{-1};
+    //!\brief File descriptors of all opened events, including the leader.
+    std::vector<int> fds{};
+    //!\brief The index into event_names for each opened event.
+    std::vector<size_t> event_ids{};
+    //!\brief The accumulated counts per scope and event.
+    std::array<std::array<uint64_t, event_count>, scope_count> totals{};
+    //!\brief The counts at the last call to enter() or leave().
+    std::array<uint64_t, event_count> last{};
+    //!\brief The current scope, scope_count if none.
+    size_t current{scope_count};
+
+    //!\brief Reads the current counts into `result`. Returns `false` on failure.
+    bool read_counts(std::array<uint64_t, event_count> & result) const;
+};
+
+} // namespace raptor
@@ -0,0 +1,31 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace raptor
+{
+
+/*!\brief Returns whether each user bin of an IBF was removed, see raptor::remove_user_bins.
+ * \details
+ * Removed user bins have no file names and are cleared. Since a threshold of 0 is reached by every bin, the searches
+ * skip the hits of removed user bins instead of raising the threshold of all user bins.
+ */
+inline std::vector<bool> removed_user_bins(std::vector<std::vector<std::string>> const & bin_path)
+{
+    std::vector<bool> result(bin_path.size());
+
+    for (size_t user_bin = 0; user_bin < bin_path.size(); ++user_bin)
+        result[user_bin] = bin_path[user_bin].empty();
+
+    return result;
+}
+
+} // namespace raptor
@@ -10,9 +10,14 @@
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
+#include <raptor/counter_width.hpp>
 #include <raptor/dna4_traits.hpp>
+#include <raptor/huge_pages.hpp>
+#include <raptor/prefetching_counting_agent.hpp>
 #include <raptor/search/do_parallel.hpp>
 #include <raptor/search/load_index.hpp>
+#include <raptor/search/perf_counters.hpp>
+#include <raptor/search/removed_user_bins.hpp>
 #include <raptor/search/sync_out.hpp>
 #include <raptor/threshold/threshold.hpp>
 
@@ -29,9 +34,27 @@ void search_single(search_arguments const & arguments, index_t && index)
     double reads_io_time{0.0};
     double compute_time{0.0};
 
+    // With numa_policy::replicate, node `i` uses replicas[i - 1]. Node 0 uses `index`.
+    size_t const number_of_replicas = arguments.numa == numa_policy::replicate ?
+                                      numa_topology::system().node_count() - 1u : 0u;
+    std::vector<std::remove_cvref_t<index_t>> replicas(number_of_replicas);
+
     auto cereal_worker = [&] ()
     {
+        std::vector<double> replica_io_times(number_of_replicas, 0.0);
+        std::vector<std::future<void>> replica_handles{};
+        for (size_t i = 0; i < number_of_replicas; ++i)
+            replica_handles.emplace_back(std::async(std::launch::async, [&, i] ()
+            {
+                load_index(replicas[i], arguments, replica_io_times[i], i + 1u);
+            }));
+
         load_index(index, arguments, index_io_time);
+
+        for (auto && handle : replica_handles)
+            handle.wait();
+        for (double const time : replica_io_times)
+            index_io_time = std::max(index_io_time, time);
     };
     auto cereal_handle = std::async(std::launch::async, cereal_worker);
 
@@ -62,19 +85,22 @@ void search_single(search_arguments const & arguments, index_t && index)
         synced_out << "#QUERY_NAME\tUSER_BINS\n";
     }
 
+    auto const threshold_start = std::chrono::high_resolution_clock::now();
     raptor::threshold::threshold const thresholder{arguments.make_threshold_parameters()};
+    auto const threshold_end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage("threshold",
+                                std::chrono::duration<double>(threshold_end - threshold_start).count());
+
+    std::vector<bool> const removed = raptor::removed_user_bins(arguments.bin_path);
+
+    bool const use_hardware_counters = arguments.hardware_counters && !arguments.metrics_file.empty();
 
-    auto worker = [&] (size_t const start, size_t const end)
+    auto search = [&] (size_t const start, size_t const end, size_t const thread_id, auto && counter)
     {
-        auto counter = [&index] ()
-        {
-            if constexpr (is_ibf)
-                return index.ibf().template counting_agent<uint16_t>();
-            else
-                return index.ibf().membership_agent();
-        }();
+        perf_counters perf{use_hardware_counters};
         std::string result_string{};
         std::vector<uint64_t> minimiser;
+        uint64_t total_minimiser_count{};
 
         auto hash_adaptor = seqan3::views::minimiser_hash(arguments.shape,
                                                           seqan3::window_size{arguments.window_size},
@@ -82,23 +108,29 @@ void search_single(search_arguments const & arguments, index_t && index)
 
         for (auto && [id, seq] : records | seqan3::views::slice(start, end))
         {
+            perf.enter(perf_scope::output);
             result_string.clear();
             result_string += id;
             result_string += '\t';
 
+            perf.enter(perf_scope::hashing);
             auto minimiser_view = seq | hash_adaptor | std::views::common;
             minimiser.assign(minimiser_view.begin(), minimiser_view.end());
 
+            perf.enter(perf_scope::threshold);
             size_t const minimiser_count{minimiser.size()};
             size_t const threshold = thresholder.get(minimiser_count);
+            total_minimiser_count += minimiser_count;
 
             if constexpr (is_ibf)
             {
+                perf.enter(perf_scope::counting);
                 auto & result = counter.bulk_count(minimiser);
+                perf.enter(perf_scope::threshold);
                 size_t current_bin{0};
                 for (auto && count : result)
                 {
-                    if (count >= threshold)
+                    if (count >= threshold && !removed[current_bin])
                     {
                         result_string += std::to_string(current_bin);
                         result_string += ',';
@@ -108,7 +140,9 @@ void search_single(search_arguments const & arguments, index_t && index)
             }
             else
             {
+                perf.enter(perf_scope::counting);
                 auto & result = counter.bulk_contains(minimiser, threshold); // Results contains user bin IDs
+                perf.enter(perf_scope::output);
                 for (auto && count : result)
                 {
                     result_string += std::to_string(count);
@@ -116,12 +150,55 @@ void search_single(search_arguments const & arguments, index_t && index)
                 }
             }
 
+            perf.enter(perf_scope::output);
             if (auto & last_char = result_string.back(); last_char == ',')
                 last_char = '\n';
             else
                 result_string += '\n';
             synced_out.write(result_string);
         }
+        perf.leave();
+
+        if (perf.available())
+            for (size_t scope = 0; scope < perf_counters::scope_count; ++scope)
+                arguments.metrics.add_hardware_counters(perf_counters::scope_names[scope],
+                                                        thread_id,
+                                                        perf.values(static_cast<perf_scope>(scope)));
+
+        arguments.metrics.minimisers += total_minimiser_count;
+        if constexpr (is_ibf)
+        {
+            arguments.metrics.lookups += total_minimiser_count;
+        }
+        else
+        {
+            arguments.metrics.lookups += counter.lookups;
+            arguments.metrics.ibfs_visited += counter.ibfs_visited;
+        }
+    };
+
+    auto worker = [&] (size_t const start, size_t const end, size_t const thread_id)
+    {
+        size_t const node = numa_topology::current_node();
+        auto & local_index = node == 0u || replicas.empty() ? index : replicas[node - 1u];
+
+        if constexpr (is_ibf)
+        {
+            // The counters are as narrow as the longest read of this batch allows.
+            size_t const max_count = max_minimiser_count(records | seqan3::views::slice(start, end),
+                                                         arguments.shape_size);
+            dispatch_counter_width(max_count, [&] <typename value_t> (std::type_identity<value_t>)
+            {
+                search(start,
+                       end,
+                       thread_id,
+                       make_counting_agent<value_t>(local_index.ibf(), arguments.prefetch_distance));
+            });
+        }
+        else
+        {
+            search(start, end, thread_id, local_index.ibf().membership_agent(arguments.prefetch_distance));
+        }
     };
 
     for (auto && chunked_records : fin | seqan3::views::chunk((1ULL<<20)*10))
@@ -130,11 +207,14 @@ void search_single(search_arguments const & arguments, index_t && index)
         auto start = std::chrono::high_resolution_clock::now();
         std::ranges::move(chunked_records, std::back_inserter(records));
         auto end = std::chrono::high_resolution_clock::now();
-        reads_io_time += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        double const reads_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        reads_io_time += reads_elapsed;
+        arguments.metrics.add_stage("reads_io", reads_elapsed);
+        arguments.metrics.reads += records.size();
 
         cereal_handle.wait();
 
-        do_parallel(worker, records.size(), arguments.threads, compute_time);
+        do_parallel(worker, records.size(), arguments, compute_time);
     }
 
 // GCOVR_EXCL_START
@@ -143,12 +223,14 @@ void search_single(search_arguments const & arguments, index_t && index)
         std::filesystem::path file_path{arguments.out_file};
         file_path += ".time";
         std::ofstream file_handle{file_path};
-        file_handle << "Index I/O\tReads I/O\tCompute\n";
+        file_handle << "Index I/O\tReads I/O\tCompute" << (arguments.huge_pages ? "\tHuge pages (MiB)\n" : "\n");
         file_handle << std::fixed
                     << std::setprecision(2)
                     << index_io_time << '\t'
                     << reads_io_time << '\t'
                     << compute_time;
+        if (arguments.huge_pages)
+            file_handle << '\t' << huge_page_bytes() / 1048576.0;
     }
 // GCOVR_EXCL_STOP
 }
@@ -0,0 +1,140 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace raptor
+{
+
+/*!\brief One end of a connection between the search coordinator and a worker process.
+ * \details
+ * The connection is a connected Unix domain socket. A message is a vector of 64-bit words, sent as its number of words
+ * followed by the words. Since messages are written and read completely, a message may be larger than the buffer of
+ * the socket as long as the other end reads concurrently.
+ * A closed connection is not an error: send() and receive() return `false`. Writing to a closed connection does not
+ * raise `SIGPIPE`. Other errors throw std::runtime_error.
+ */
+class worker_channel
+{
+public:
+    worker_channel() = default;
+    worker_channel(worker_channel const &) = delete;
+    worker_channel & operator=(worker_channel const &) = delete;
+    worker_channel(worker_channel && other) noexcept : fd{std::exchange(other.fd, -1)} {}
+    worker_channel & operator=(worker_channel && other) noexcept
+    {
+        std::swap(fd, other.fd);
+        return *this;
+    }
+    ~worker_channel()
+    {
+        close();
+    }
+
+    //!\brief Takes ownership of the connected socket `fd_`.
+    explicit worker_channel(int const fd_) : fd{fd_}
+    {
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+        int const on{1};
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    }
+
+    //!\brief Returns both ends of a new connection.
+    static std::pair<worker_channel, worker_channel> make_pair()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            throw std::runtime_error{std::string{"Cannot create socket pair: "} + std::strerror(errno)};
+
+        return {worker_channel{fds[0]}, worker_channel{fds[1]}};
+    }
+
+    //!\brief Closes this end of the connection. The other end receives end-of-file.
+    void close() noexcept
+    {
+        if (fd >= 0)
+            ::close(std::exchange(fd, -1));
+    }
+
+    //!\brief Sends `message`. Returns `false` if the other end was closed.
+    bool send(std::vector<uint64_t> const & message) const
+    {
+        uint64_t const size{message.size()};
+        return write_all(&size, sizeof(size)) && write_all(message.data(), size * sizeof(uint64_t));
+    }
+
+    //!\brief Receives the next message into `message`. Returns `false` if the other end was closed.
+    bool receive(std::vector<uint64_t> & message) const
+    {
+        uint64_t size{};
+        if (!read_all(&size, sizeof(size)))
+            return false;
+
+        message.resize(size);
+        return read_all(message.data(), size * sizeof(uint64_t));
+    }
+
+private:
+    int fd{-1};
+
+    bool write_all(void const * const data, size_t const bytes) const
+    {
+#if defined(MSG_NOSIGNAL)
+        constexpr int flags{MSG_NOSIGNAL};
+#else
+        constexpr int flags{0};
+#endif
+        char const * begin = static_cast<char const *>(data);
+        char const * const end = begin + bytes;
+
+        while (begin != end)
+        {
+            ssize_t const written = ::send(fd, begin, end - begin, flags);
+            if (written >= 0)
+                begin += written;
+            else if (errno == EPIPE || errno == ECONNRESET)
+                return false;
+            else if (errno != EINTR)
+                throw std::runtime_error{std::string{"Cannot send to worker channel: "} + std::strerror(errno)};
+        }
+
+        return true;
+    }
+
+    bool read_all(void * const data, size_t const bytes) const
+    {
+        char * begin = static_cast<char *>(data);
+        char * const end = begin + bytes;
+
+        while (begin != end)
+        {
+            ssize_t const received = ::recv(fd, begin, end - begin, 0);
+            if (received > 0)
+                begin += received;
+            else if (received == 0 || errno == ECONNRESET)
+                return false;
+            else if (errno != EINTR)
+                throw std::runtime_error{std::string{"Cannot receive from worker channel: "} + std::strerror(errno)};
+        }
+
+        return true;
+    }
+};
+
+} // namespace raptor
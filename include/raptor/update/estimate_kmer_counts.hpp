@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+namespace raptor
+{
+
+/*!\brief Estimates the number of distinct values stored in each bin of an uncompressed IBF.
+ * \details
+ * A Bloom filter of `m` bits and `h` hash functions with `x` bits set contains about `-m / h * ln(1 - x / m)` distinct
+ * values. Only the bits are needed, hence the fill of bins can be determined for existing indices.
+ * The result is infinity for bins that have all bits set.
+ */
+inline std::vector<double>
+estimate_kmer_counts(seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed> const & ibf)
+{
+    size_t const bin_count{ibf.bin_count()};
+    size_t const bin_size{ibf.bin_size()};
+    size_t const words_per_row{(bin_count + 63u) >> 6};
+    uint64_t const * const data{ibf.raw_data().data()};
+
+    // Row `i` contains bit `i` of each bin.
+    std::vector<size_t> set_bits(words_per_row << 6);
+    for (size_t row = 0; row < bin_size; ++row)
+    {
+        uint64_t const * const words = data + row * words_per_row;
+        for (size_t word = 0; word < words_per_row; ++word)
+            for (uint64_t bits = words[word]; bits != 0u; bits &= bits - 1u)
+                ++set_bits[(word << 6) + std::countr_zero(bits)];
+    }
+
+    double const m{static_cast<double>(bin_size)};
+    double const h{static_cast<double>(ibf.hash_function_count())};
+    std::vector<double> counts(bin_count);
+
+    for (size_t bin = 0; bin < bin_count; ++bin)
+    {
+        counts[bin] = set_bits[bin] < bin_size ? -m / h * std::log1p(-static_cast<double>(set_bits[bin]) / m)
+                                               : std::numeric_limits<double>::infinity();
+    }
+
+    return counts;
+}
+
+} // namespace raptor
@@ -0,0 +1,40 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <raptor/argument_parsing/build_arguments.hpp>
+#include <raptor/argument_parsing/update_arguments.hpp>
+
+namespace raptor::hibf
+{
+
+/*!\brief Adds the user bins of `arguments.bin_path` to an existing HIBF.
+ * \param arguments The arguments of `raptor update`.
+ * \param build_args The arguments used to compute and insert k-mers. `build_args.hash` is set to the number of hash
+ *                   functions of the HIBF.
+ * \details
+ * The new user bins are placed one after another, largest first. Each user bin is put into the first of the following
+ * places that exists:
+ *
+ * 1. Unused technical bins of any IBF whose bins can store the user bin. Only the root IBF may split a user bin into
+ *    multiple technical bins. Among all IBFs, the one with the smallest bins is chosen.
+ * 2. A new technical bin of a lower-level IBF whose bins can store the user bin. The IBF grows by 64 technical bins.
+ * 3. A lower-level IBF whose bins are too small. The IBF is rebuilt with larger bins, which requires reading all user
+ *    bins in its subtree again. The IBF with the least input is chosen. The lower-level IBFs of its merged bins are kept.
+ *    Further user bins may be added to a rebuilt IBF as in 1., and its bins may be enlarged again without extra cost.
+ * 4. A new lower-level IBF below a new merged bin of the root IBF. Further user bins may be added to it.
+ * 5. New technical bins of the root IBF.
+ *
+ * The merged bins on the path from the root to the chosen IBF must have room for the k-mers of the user bin, too.
+ * The number of k-mers in a bin is estimated from the number of set bits, see raptor::estimate_kmer_counts. Whether a
+ * bin has room depends on `build_args.fpr`, which should hence be the same as when building the HIBF.
+ * All IBFs that are not chosen stay unchanged.
+ */
+void update_hibf(update_arguments const & arguments, build_arguments & build_args);
+
+} // namespace raptor::hibf
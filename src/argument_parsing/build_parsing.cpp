@@ -10,6 +10,7 @@
 #include <raptor/argument_parsing/parse_bin_path.hpp>
 #include <raptor/argument_parsing/validators.hpp>
 #include <raptor/build/raptor_build.hpp>
+#include <raptor/index_shards.hpp>
 
 namespace raptor
 {
@@ -26,6 +27,39 @@ std::istream & operator>>(std::istream & s, window & window_)
     return s >> window_.v;
 }
 
+// Converts a size like "8g" to bytes.
+uint64_t size_in_bytes(std::string size, std::string const & option_name)
+{
+    size.erase(std::remove(size.begin(), size.end(), ' '), size.end());
+    uint64_t multiplier{};
+
+    switch (std::tolower(size.back()))
+    {
+// GCOVR_EXCL_START
+        case 't':
+            multiplier = 1024ull * 1024ull * 1024ull * 1024ull;
+            break;
+        case 'g':
+            multiplier = 1024ull * 1024ull * 1024ull;
+            break;
+        case 'm':
+            multiplier = 1024ull * 1024ull;
+            break;
+// GCOVR_EXCL_STOP
+        case 'k':
+            multiplier = 1024ull;
+            break;
+// GCOVR_EXCL_START
+        default:
+            throw seqan3::argument_parser_error{"Use {k, m, g, t} to pass size. E.g., --" + option_name + " 8g."};
+// GCOVR_EXCL_STOP
+    }
+
+    uint64_t result{};
+    std::from_chars(size.data(), size.data() + size.size() - 1, result);
+    return result * multiplier;
+}
+
 void init_build_parser(seqan3::argument_parser & parser, build_arguments & arguments)
 {
     init_shared_meta(parser);
@@ -42,6 +76,14 @@ void init_build_parser(seqan3::argument_parser & parser, build_arguments & argum
                       "Splits the index in this many parts.",
                       arguments.is_socks ? seqan3::option_spec::hidden : seqan3::option_spec::standard,
                       power_of_two_validator{});
+    parser.add_option(arguments.shards,
+                      '\0',
+                      "shards",
+                      "Splits the user bins into this many shards. Each shard is a complete index over a range of user "
+                      "bins and is written to the output path with the suffix _shard_0, _shard_1, and so on. There is "
+                      "at most one shard per 64 user bins. Mutually exclusive with --parts.",
+                      arguments.is_socks ? seqan3::option_spec::hidden : seqan3::option_spec::standard,
+                      positive_integer_validator{});
     parser.add_option(arguments.kmer_size,
                       '\0',
                       "kmer",
@@ -109,11 +151,45 @@ void init_build_parser(seqan3::argument_parser & parser, build_arguments & argum
                     "disable-cutoffs",
                     "Do not apply cutoffs when using --compute-minimiser.",
                     arguments.is_socks ? seqan3::option_spec::hidden : seqan3::option_spec::standard);
+    parser.add_option(arguments.memory_limit_string,
+                      '\0',
+                      "memory-limit",
+                      "Bound the memory used for counting minimisers with --compute-minimiser and for the k-mers of "
+                      "merged bins with --hibf. Data exceeding the limit is sorted and written to temporary files in "
+                      "the output directory. The limit does not include the IBFs, which are part of the index, and "
+                      "the k-mers of the user bins that are being inserted. With more than one thread, several of "
+                      "them are processed at the same time. Default: No limit.",
+                      seqan3::option_spec::advanced,
+                      size_validator{"\\d+\\s{0,1}[k,m,g,t,K,M,G,T]"});
+    parser.add_option(arguments.chunk_size_string,
+                      '\0',
+                      "chunk-size",
+                      "With more than one thread, uncompressed FASTA and FASTQ files larger than this are split into "
+                      "chunks of about this size, which are inserted in parallel. Default: 64m.",
+                      seqan3::option_spec::hidden,
+                      size_validator{"\\d+\\s{0,1}[k,m,g,t,K,M,G,T]"});
+    parser.add_option(arguments.available_memory_string,
+                      '\0',
+                      "available-memory",
+                      "With --parts, all parts are built in a single pass if they fit into this much memory. "
+                      "Otherwise, they are built one at a time. Default: The free physical memory.",
+                      seqan3::option_spec::hidden,
+                      size_validator{"\\d+\\s{0,1}[k,m,g,t,K,M,G,T]"});
     parser.add_flag(arguments.is_hibf,
                     '\0',
                     "hibf",
                     "Index is an HIBF.",
                     seqan3::option_spec::advanced);
+    parser.add_flag(arguments.huge_pages,
+                    '\0',
+                    "huge-pages",
+                    "Back the index with transparent huge pages during construction.",
+                    seqan3::option_spec::advanced);
+    parser.add_option(arguments.metrics_file,
+                      '\0',
+                      "metrics",
+                      "Write per-stage timings, per-thread timings, rates, and peak memory usage as JSON to this file.",
+                      seqan3::option_spec::advanced);
 }
 
 void build_parsing(seqan3::argument_parser & parser, bool const is_socks)
@@ -195,37 +271,39 @@ void build_parsing(seqan3::argument_parser & parser, bool const is_socks)
     // ==========================================
     if (!parser.is_option_set("hibf"))
     {
-        arguments.size.erase(std::remove(arguments.size.begin(), arguments.size.end(), ' '), arguments.size.end());
-        size_t multiplier{};
-
-        switch (std::tolower(arguments.size.back()))
-        {
-    // GCOVR_EXCL_START
-            case 't':
-                multiplier = 8ull * 1024ull * 1024ull * 1024ull * 1024ull;
-                break;
-            case 'g':
-                multiplier = 8ull * 1024ull * 1024ull * 1024ull;
-                break;
-            case 'm':
-                multiplier = 8ull * 1024ull * 1024ull;
-                break;
-    // GCOVR_EXCL_STOP
-            case 'k':
-                multiplier = 8ull * 1024ull;
-                break;
-    // GCOVR_EXCL_START
-            default:
-                throw seqan3::argument_parser_error{"Use {k, m, g, t} to pass size. E.g., --size 8g."};
-    // GCOVR_EXCL_STOP
-        }
-
-        size_t size{};
-        std::from_chars(arguments.size.data(), arguments.size.data() + arguments.size.size() - 1, size);
-        size *= multiplier;
+        size_t const size = size_in_bytes(arguments.size, "size") * 8u;
         arguments.bits = size / (((arguments.bins + 63) >> 6) << 6);
     }
 
+    // ==========================================
+    // Process --shards.
+    // ==========================================
+    if (arguments.shards > 1u)
+    {
+        if (arguments.parts > 1u)
+            throw seqan3::argument_parser_error{"You cannot set both --shards and --parts."};
+        if (arguments.is_hibf || arguments.compute_minimiser)
+            throw seqan3::argument_parser_error{"--shards can only be used to build an IBF."};
+    }
+
+    // ==========================================
+    // Process --memory-limit.
+    // ==========================================
+    if (parser.is_option_set("memory-limit"))
+        arguments.memory_limit = size_in_bytes(arguments.memory_limit_string, "memory-limit");
+
+    // ==========================================
+    // Process --chunk-size.
+    // ==========================================
+    if (parser.is_option_set("chunk-size"))
+        arguments.chunk_size = size_in_bytes(arguments.chunk_size_string, "chunk-size");
+
+    // ==========================================
+    // Process --available-memory.
+    // ==========================================
+    if (parser.is_option_set("available-memory"))
+        arguments.available_memory = size_in_bytes(arguments.available_memory_string, "available-memory");
+
     // ==========================================
     // Read w and k from minimiser header file
     // ==========================================
@@ -249,7 +327,36 @@ void build_parsing(seqan3::argument_parser & parser, bool const is_socks)
     // ==========================================
     // Dispatch
     // ==========================================
-    raptor_build(arguments);
+    if (arguments.shards == 1u)
+    {
+        raptor_build(arguments);
+
+        // With --compute-minimiser, the output is a directory.
+        if (!arguments.compute_minimiser)
+            remove_shards(arguments.out_path);
+        return;
+    }
+
+    // Each shard is built like an index of its user bins only. The bin size is the one of the whole index.
+    std::vector<std::vector<std::string>> const bin_path{std::move(arguments.bin_path)};
+    std::filesystem::path const out_path{arguments.out_path};
+    auto const ranges = shard_ranges(bin_path.size(), arguments.shards);
+
+    for (size_t shard = 0; shard < ranges.size(); ++shard)
+    {
+        auto const [first, last] = ranges[shard];
+        arguments.bin_path.assign(bin_path.begin() + first, bin_path.begin() + last);
+        arguments.bins = arguments.bin_path.size();
+        arguments.out_path = shard_path(out_path, shard);
+        raptor_build(arguments);
+    }
+
+    // Shards of an earlier build with more shards would be found by raptor search.
+    remove_shards(out_path, ranges.size());
+
+    // An unsharded or partitioned index of an earlier build would make raptor search fail.
+    std::filesystem::remove(out_path);
+    for (size_t part = 0; std::filesystem::remove(out_path.string() + "_" + std::to_string(part)); ++part) {}
 }
 
 } // namespace raptor
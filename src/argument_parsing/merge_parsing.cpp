@@ -0,0 +1,157 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <array>
+#include <bit>
+
+#include <raptor/argument_parsing/init_shared_meta.hpp>
+#include <raptor/argument_parsing/merge_parsing.hpp>
+#include <raptor/argument_parsing/validators.hpp>
+#include <raptor/index.hpp>
+#include <raptor/merge/merge.hpp>
+
+namespace raptor
+{
+
+/*!\brief Whether the stream `is`, positioned after the parameters of an index, continues with a valid IBF.
+ * \details
+ * The parameters of an HIBF are stored like the ones of an IBF. Reading an HIBF as IBF interprets the sizes of its IBFs
+ * as header of the IBF, which would allocate an arbitrary amount of memory. Hence, the header is checked against the
+ * number of user bins and the remaining size of the file before the IBF is deserialised. The stream is not reset.
+ */
+bool has_ibf_header(std::ifstream & is, size_t const user_bins)
+{
+    // The members of seqan3::interleaved_bloom_filter in the order they are serialised.
+    std::array<uint64_t, 6> header{};
+    auto & [bins, technical_bins, bin_size, hash_shift, bin_words, hash_funs] = header;
+
+    is.read(reinterpret_cast<char *>(header.data()), sizeof(header));
+    if (!is)
+        return false;
+
+    std::streamoff const position = is.tellg();
+    is.seekg(0, std::ios::end);
+    uint64_t const remaining_bytes = static_cast<uint64_t>(is.tellg() - position);
+
+    return bins == user_bins &&
+           technical_bins == ((bins + 63u) >> 6) << 6 &&
+           bin_words == technical_bins >> 6 &&
+           bin_size > 0u &&
+           hash_shift == static_cast<uint64_t>(std::countl_zero(bin_size)) &&
+           hash_funs > 0u && hash_funs <= 5u &&
+           bin_size <= remaining_bytes * 8u / std::max<uint64_t>(technical_bins, 1u);
+}
+
+void init_merge_parser(seqan3::argument_parser & parser, merge_arguments & arguments)
+{
+    init_shared_meta(parser);
+    parser.info.description.emplace_back("Merges IBFs into one IBF. The user bins of the merged IBF are the user bins "
+                                         "of the given indices, in the given order.");
+    parser.info.description.emplace_back("All indices must have been built with the same k-mer size or shape, window "
+                                         "size, size, number of hash functions, and number of parts. No file is read "
+                                         "again, and only one input index is loaded at a time. Only IBFs can be "
+                                         "merged, HIBFs cannot.");
+    parser.info.examples = {"raptor merge --output raptor.index node1.index node2.index node3.index"};
+    parser.add_positional_option(arguments.in_files, "The indices to merge. Parts: Without suffix _0");
+    parser.add_option(arguments.out_file,
+                      '\0',
+                      "output",
+                      "Path to the merged index.",
+                      seqan3::option_spec::required);
+    parser.add_option(arguments.threads,
+                      '\0',
+                      "threads",
+                      "The numer of threads to use.",
+                      seqan3::option_spec::standard,
+                      positive_integer_validator{});
+    parser.add_option(arguments.metrics_file,
+                      '\0',
+                      "metrics",
+                      "Write per-stage timings and peak memory usage as JSON to this file.",
+                      seqan3::option_spec::advanced);
+}
+
+void merge_parsing(seqan3::argument_parser & parser)
+{
+    merge_arguments arguments{};
+    init_merge_parser(parser, arguments);
+    parser.parse();
+
+    // ==========================================
+    // Various checks.
+    // ==========================================
+    if (arguments.in_files.size() < 2u)
+        throw seqan3::argument_parser_error{"At least two indices must be given."};
+
+    std::filesystem::path output_directory = arguments.out_file.parent_path();
+    std::error_code ec{};
+    std::filesystem::create_directories(output_directory, ec);
+
+// GCOVR_EXCL_START
+    if (!output_directory.empty() && ec)
+        throw seqan3::argument_parser_error{seqan3::detail::to_string("Failed to create directory\"",
+                                                                      output_directory.c_str(),
+                                                                      "\": ",
+                                                                      ec.message())};
+// GCOVR_EXCL_STOP
+
+    // ==========================================
+    // Read the parameters of the indices.
+    // ==========================================
+    raptor_index<> first{};
+    seqan3::input_file_validator validator{};
+
+    for (size_t i = 0; i < arguments.in_files.size(); ++i)
+    {
+        std::filesystem::path const & in_file = arguments.in_files[i];
+        bool partitioned{false};
+
+        try
+        {
+            validator(in_file.string() + std::string{"_0"});
+            partitioned = true;
+        }
+        catch (seqan3::validation_error const & e)
+        {
+            validator(in_file);
+        }
+
+        std::ifstream is{partitioned ? in_file.string() + std::string{"_0"} : in_file.string(), std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        raptor_index<> tmp{};
+        tmp.load_parameters(iarchive);
+
+        if (tmp.compressed())
+            throw seqan3::argument_parser_error{"Compressed indices cannot be merged."};
+
+        if (!has_ibf_header(is, tmp.bin_path().size()))
+            throw seqan3::argument_parser_error{"The index " + in_file.string() + " is not an IBF. HIBF indices "
+                                                "cannot be merged."};
+
+        if (i == 0u)
+        {
+            first = std::move(tmp);
+            arguments.parts = first.parts();
+            arguments.bins = first.bin_path().size();
+            continue;
+        }
+
+        if (tmp.window_size() != first.window_size() || tmp.shape() != first.shape() || tmp.parts() != first.parts())
+            throw seqan3::argument_parser_error{"The index " + in_file.string() + " was built with a different window "
+                                                "size, shape, or number of parts than " +
+                                                arguments.in_files[0].string() + "."};
+
+        arguments.bins += tmp.bin_path().size();
+    }
+
+    // ==========================================
+    // Dispatch
+    // ==========================================
+    raptor_merge(arguments);
+}
+
+} // namespace raptor
@@ -63,6 +63,11 @@ void parse_bin_path(build_arguments & arguments)
     raptor::detail::parse_bin_path(arguments.bin_file, arguments.bin_path, arguments.is_socks, arguments.is_hibf);
 }
 
+void parse_bin_path(update_arguments & arguments)
+{
+    raptor::detail::parse_bin_path(arguments.bin_file, arguments.bin_path, false, false);
+}
+
 void parse_bin_path(upgrade_arguments & arguments)
 {
     raptor::detail::parse_bin_path(arguments.bin_file, arguments.bin_path, false, false);
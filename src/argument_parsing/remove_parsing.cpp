@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <sstream>
+#include <unordered_set>
+
+#include <raptor/argument_parsing/init_shared_meta.hpp>
+#include <raptor/argument_parsing/remove_parsing.hpp>
+#include <raptor/index.hpp>
+#include <raptor/remove/remove.hpp>
+
+namespace raptor
+{
+
+void init_remove_parser(seqan3::argument_parser & parser, remove_arguments & arguments)
+{
+    init_shared_meta(parser);
+    parser.info.description.emplace_back("Removes user bins from an existing index. Each user bin that contains one of "
+                                         "the given files is cleared and marked as removed. The other user bins keep "
+                                         "their number, and search results never contain removed user bins.");
+    parser.info.description.emplace_back("With --compact, removed user bins, including the ones of earlier calls, are "
+                                         "dropped from the index and the remaining user bins are renumbered. The bin "
+                                         "file may then be empty.");
+    parser.info.examples = {"raptor remove --input raptor.index --output raptor.index retracted_bin_paths.txt"};
+    parser.add_positional_option(arguments.bin_file,
+                                 "File containing file names of user bins to remove, separated by whitespace. The "
+                                 "names must be the ones used for building the index.",
+                                 seqan3::input_file_validator{});
+    parser.add_option(arguments.in_file,
+                      '\0',
+                      "input",
+                      "The index to remove user bins from. Parts: Without suffix _0",
+                      seqan3::option_spec::required);
+    parser.add_option(arguments.out_file,
+                      '\0',
+                      "output",
+                      "Path to the resulting index. May be the same as --input.",
+                      seqan3::option_spec::required);
+    parser.add_flag(arguments.compact,
+                    '\0',
+                    "compact",
+                    "Drop removed user bins from the index. Changes the numbers of the remaining user bins.");
+    parser.add_flag(arguments.is_hibf,
+                    '\0',
+                    "hibf",
+                    "Index is an HIBF.",
+                    seqan3::option_spec::advanced);
+}
+
+void remove_parsing(seqan3::argument_parser & parser)
+{
+    remove_arguments arguments{};
+    init_remove_parser(parser, arguments);
+    parser.parse();
+
+    // ==========================================
+    // Various checks.
+    // ==========================================
+    std::filesystem::path output_directory = arguments.out_file.parent_path();
+    std::error_code ec{};
+    std::filesystem::create_directories(output_directory, ec);
+
+// GCOVR_EXCL_START
+    if (!output_directory.empty() && ec)
+        throw seqan3::argument_parser_error{seqan3::detail::to_string("Failed to create directory\"",
+                                                                      output_directory.c_str(),
+                                                                      "\": ",
+                                                                      ec.message())};
+// GCOVR_EXCL_STOP
+
+    bool partitioned{false};
+    seqan3::input_file_validator validator{};
+
+    try
+    {
+        validator(arguments.in_file.string() + std::string{"_0"});
+        partitioned = true;
+    }
+    catch (seqan3::validation_error const & e)
+    {
+        validator(arguments.in_file);
+    }
+
+    // ==========================================
+    // Read the parameters of the index.
+    // ==========================================
+    std::vector<std::vector<std::string>> bin_path{};
+    {
+        std::ifstream is{partitioned ? arguments.in_file.string() + std::string{"_0"} : arguments.in_file.string(),
+                         std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        raptor_index<> tmp{};
+        tmp.load_parameters(iarchive);
+
+        if (tmp.compressed())
+            throw seqan3::argument_parser_error{"User bins cannot be removed from compressed indices."};
+
+        arguments.parts = tmp.parts();
+        bin_path = tmp.bin_path();
+    }
+
+    // ==========================================
+    // Find the user bins to remove.
+    // ==========================================
+    std::unordered_set<std::string> file_names{};
+    {
+        std::ifstream istrm{arguments.bin_file};
+        std::string file_name{};
+        while (istrm >> file_name)
+            file_names.insert(file_name);
+    }
+
+    if (file_names.empty() && !arguments.compact)
+        throw seqan3::argument_parser_error{"The file " + arguments.bin_file.string() + " does not contain any file "
+                                            "names."};
+
+    std::unordered_set<std::string> found{};
+    arguments.removed.resize(bin_path.size());
+    for (size_t user_bin = 0; user_bin < bin_path.size(); ++user_bin)
+    {
+        auto check = [&] (std::string const & file_name)
+        {
+            if (file_names.contains(file_name))
+            {
+                arguments.removed[user_bin] = true;
+                found.insert(file_name);
+            }
+        };
+
+        for (auto const & file_name : bin_path[user_bin])
+        {
+            // The file names of a user bin of an HIBF are joined by ';', see raptor::hibf::update_user_bins.
+            if (!arguments.is_hibf)
+            {
+                check(file_name);
+                continue;
+            }
+
+            std::stringstream sstream{file_name};
+            std::string part{};
+            while (std::getline(sstream, part, ';'))
+                check(part);
+        }
+    }
+
+    for (auto const & file_name : file_names)
+        if (!found.contains(file_name))
+            throw seqan3::argument_parser_error{"The file " + file_name + " is not part of the index."};
+
+    bool keeps_user_bin{false};
+    for (size_t user_bin = 0; user_bin < bin_path.size(); ++user_bin)
+        keeps_user_bin |= !bin_path[user_bin].empty() && !arguments.removed[user_bin];
+
+    if (!keeps_user_bin)
+        throw seqan3::argument_parser_error{"At least one user bin must remain in the index."};
+
+    // ==========================================
+    // Dispatch
+    // ==========================================
+    raptor_remove(arguments);
+}
+
+} // namespace raptor
@@ -5,6 +5,8 @@
 // shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
 // -----------------------------------------------------------------------------------------------------
 
+#include <charconv>
+
 #include <seqan3/io/views/async_input_buffer.hpp>
 
 #include <raptor/argument_parsing/init_shared_meta.hpp>
@@ -12,6 +14,8 @@
 #include <raptor/argument_parsing/validators.hpp>
 #include <raptor/dna4_traits.hpp>
 #include <raptor/index.hpp>
+#include <raptor/index_shards.hpp>
+#include <raptor/search/perf_counters.hpp>
 #include <raptor/search/search.hpp>
 
 namespace raptor
@@ -99,6 +103,34 @@ void init_search_parser(seqan3::argument_parser & parser, search_arguments & arg
                     "Two files are stored:\n"
                     "\\fBthreshold_*.bin\\fP: Depends on pattern, window, kmer/shape, errors, and tau.\n"
                     "\\fBcorrection_*.bin\\fP: Depends on pattern, window, kmer/shape, p_max, and fpr.");
+    parser.add_option(arguments.numa_string,
+                      '\0',
+                      "numa",
+                      "Memory placement of the index on systems with multiple NUMA nodes. \\fBinterleave\\fP spreads "
+                      "the index across all nodes. \\fBreplicate\\fP loads one copy of the index per node if there "
+                      "is enough free memory, and falls back to \\fBinterleave\\fP otherwise. In both cases, threads "
+                      "are pinned to nodes.",
+                      seqan3::option_spec::advanced,
+                      seqan3::value_list_validator{"none", "interleave", "replicate"});
+    parser.add_flag(arguments.huge_pages,
+                    '\0',
+                    "huge-pages",
+                    "Back the index with transparent huge pages. Reduces TLB misses for large indices.",
+                    seqan3::option_spec::advanced);
+    parser.add_option(arguments.prefetch_distance_string,
+                      '\0',
+                      "prefetch-distance",
+                      "How many minimisers to look ahead when prefetching the index. 0 disables prefetching. "
+                      "\\fBauto\\fP chooses a distance based on the size and number of hash functions of the index.",
+                      seqan3::option_spec::advanced,
+                      seqan3::regex_validator{"auto|[0-9]+"});
+    parser.add_flag(arguments.worker_processes,
+                    '\0',
+                    "worker-processes",
+                    "Search each shard of a sharded index in its own worker process. The main process computes the "
+                    "minimisers of the queries once, sends them to all workers, and merges their results. Each worker "
+                    "uses --threads threads.",
+                    seqan3::option_spec::advanced);
     parser.add_flag(arguments.is_hibf,
                     '\0',
                     "hibf",
@@ -109,6 +141,19 @@ void init_search_parser(seqan3::argument_parser & parser, search_arguments & arg
                     "time",
                     "Write timing file.",
                     seqan3::option_spec::advanced);
+    parser.add_option(arguments.metrics_file,
+                      '\0',
+                      "metrics",
+                      "Write per-stage timings, per-thread timings, rates, lookups per read, and peak memory usage as "
+                      "JSON to this file.",
+                      seqan3::option_spec::advanced);
+    parser.add_flag(arguments.hardware_counters,
+                    '\0',
+                    "perf-counters",
+                    "Add hardware performance counters (cycles, instructions, cache misses, dTLB misses, branch "
+                    "misses) of minimiser hashing, counting, thresholding, and output to the --metrics file. "
+                    "Requires Linux and permission to use perf_event_open.",
+                    seqan3::option_spec::advanced);
 }
 
 void search_parsing(seqan3::argument_parser & parser, bool const is_socks)
@@ -141,17 +186,55 @@ void search_parsing(seqan3::argument_parser & parser, bool const is_socks)
 
     bool partitioned{false};
     seqan3::input_file_validator validator{};
+    arguments.shards = shard_count(arguments.index_file);
+    bool const sharded{arguments.shards > 0u};
 
-    try
+    if (sharded)
     {
-        validator(arguments.index_file.string() + std::string{"_0"});
-        partitioned = true;
+        validator(shard_path(arguments.index_file, 0u));
+
+        if (std::filesystem::exists(arguments.index_file)
+            || std::filesystem::exists(arguments.index_file.string() + std::string{"_0"}))
+            throw seqan3::argument_parser_error{"Both a sharded and an unsharded index exist for "
+                                                + arguments.index_file.string()
+                                                + ". Remove the stale one."};
     }
-    catch (seqan3::validation_error const & e)
+    else
     {
-        validator(arguments.index_file);
+        arguments.shards = 1u;
+
+        try
+        {
+            validator(arguments.index_file.string() + std::string{"_0"});
+            partitioned = true;
+        }
+        catch (seqan3::validation_error const & e)
+        {
+            validator(arguments.index_file);
+        }
     }
 
+    // Sharded indices are only built for IBFs, see raptor::shard_ranges.
+    if (sharded && (arguments.is_hibf || arguments.is_socks))
+        throw seqan3::argument_parser_error{"Sharded indices can only be searched with raptor search, without --hibf."};
+
+    if (arguments.worker_processes && !sharded)
+        throw seqan3::argument_parser_error{"--worker-processes can only be used with sharded indices."};
+
+    // ==========================================
+    // Process --numa.
+    // ==========================================
+    if (arguments.numa_string == "interleave")
+        arguments.numa = numa_policy::interleave;
+    else if (arguments.numa_string == "replicate")
+        arguments.numa = numa_policy::replicate;
+
+    // ==========================================
+    // Process --prefetch-distance.
+    // ==========================================
+    if (std::string const & value = arguments.prefetch_distance_string; value != "auto")
+        std::from_chars(value.data(), value.data() + value.size(), arguments.prefetch_distance);
+
     // ==========================================
     // Process --pattern.
     // ==========================================
@@ -178,7 +261,8 @@ void search_parsing(seqan3::argument_parser & parser, bool const is_socks)
     // Read window and kmer size, and the bin paths.
     // ==========================================
     {
-        std::ifstream is{partitioned ? arguments.index_file.string() + std::string{"_0"} :
+        std::ifstream is{sharded ? shard_path(arguments.index_file, 0u).string() :
+                         partitioned ? arguments.index_file.string() + std::string{"_0"} :
                                        arguments.index_file.string(),
                          std::ios::binary};
         cereal::BinaryInputArchive iarchive{is};
@@ -195,6 +279,31 @@ void search_parsing(seqan3::argument_parser & parser, bool const is_socks)
             arguments.pattern_size = arguments.shape_size;
     }
 
+    // ==========================================
+    // Sharded index: The user bins of all shards are numbered consecutively.
+    // ==========================================
+    for (size_t shard{1}; shard < arguments.shards; ++shard)
+    {
+        std::ifstream is{shard_path(arguments.index_file, shard), std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        raptor_index<> tmp{};
+        tmp.load_parameters(iarchive);
+
+        if (tmp.shape() != arguments.shape || tmp.window_size() != arguments.window_size ||
+            tmp.compressed() != arguments.compressed || tmp.parts() != 1u)
+            throw seqan3::argument_parser_error{"The shard " + shard_path(arguments.index_file, shard).string() +
+                                                " was built with different parameters than the first shard."};
+
+        arguments.bin_path.insert(arguments.bin_path.end(), tmp.bin_path().begin(), tmp.bin_path().end());
+    }
+
+    if (sharded && arguments.parts != 1u)
+        throw seqan3::argument_parser_error{"Shards cannot be partitioned."};
+
+    // A single shard is an ordinary IBF. The workers find their shards themselves, see raptor::search_processes.
+    if (arguments.shards == 1u && sharded && !arguments.worker_processes)
+        arguments.index_file = shard_path(arguments.index_file, 0u);
+
     // ==========================================
     // Temporary.
     // ==========================================
@@ -212,6 +321,41 @@ void search_parsing(seqan3::argument_parser & parser, bool const is_socks)
                   << "          To disable this warning, explicitly pass the FPR to raptor search (--fpr 0.05).\n";
     }
 
+    // ==========================================
+    // Replicating the index needs a full copy on every node.
+    // ==========================================
+    if (arguments.numa == numa_policy::replicate)
+    {
+        numa_topology const & topology = numa_topology::system();
+        uint64_t const index_size = std::filesystem::file_size(sharded ? shard_path(arguments.index_file, 0u).string() :
+                                                               partitioned ? arguments.index_file.string() + "_0" :
+                                                                             arguments.index_file.string());
+        bool enough_memory{true};
+        for (size_t node{0}; node < topology.node_count(); ++node)
+            enough_memory &= topology.free_memory(node) > index_size;
+
+        // Partitioned and sharded indices and SOCKS load the index once and use interleaving instead.
+        if (partitioned || sharded || arguments.is_socks || !enough_memory)
+        {
+            if (!enough_memory)
+                std::cerr << "[WARNING] Not enough free memory to replicate the index on each NUMA node. "
+                          << "Using --numa interleave instead.\n";
+            arguments.numa = numa_policy::interleave;
+        }
+    }
+
+    // ==========================================
+    // Hardware counters are only reported if they can be opened.
+    // ==========================================
+    if (arguments.hardware_counters)
+    {
+        if (arguments.metrics_file.empty())
+            std::cerr << "[WARNING] --perf-counters has no effect without --metrics.\n";
+        else if (!perf_counters{true}.available())
+            std::cerr << "[WARNING] Hardware performance counters are not available. Check "
+                      << "/proc/sys/kernel/perf_event_paranoid. Continuing without them.\n";
+    }
+
     // ==========================================
     // Partitioned index: Check that all parts are available.
     // ==========================================
@@ -0,0 +1,172 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <raptor/argument_parsing/init_shared_meta.hpp>
+#include <raptor/argument_parsing/parse_bin_path.hpp>
+#include <raptor/argument_parsing/update_parsing.hpp>
+#include <raptor/argument_parsing/validators.hpp>
+#include <raptor/index.hpp>
+#include <raptor/update/update.hpp>
+
+namespace raptor
+{
+
+void init_update_parser(seqan3::argument_parser & parser, update_arguments & arguments)
+{
+    init_shared_meta(parser);
+    parser.info.description.emplace_back("Appends user bins to an existing IBF. Only the new files are processed. "
+                                         "The size of each bin stays the same, hence the new user bins should not be "
+                                         "larger than the ones the index was built for.");
+    parser.info.description.emplace_back("For an HIBF, each new user bin is put into an IBF that still has room for "
+                                         "it. If no lower-level IBF has bins large enough, the smallest suitable one "
+                                         "is rebuilt with larger bins, or a new lower-level IBF is added. All other "
+                                         "IBFs are kept.");
+    parser.info.examples = {"raptor update --input raptor.index --output raptor.index new_bin_paths.txt"};
+    parser.add_positional_option(arguments.bin_file,
+                                 "File containing file names of the new user bins. " +
+                                 bin_validator{}.get_help_page_message(),
+                                 seqan3::input_file_validator{});
+    parser.add_option(arguments.in_file,
+                      '\0',
+                      "input",
+                      "The index to update. Parts: Without suffix _0",
+                      seqan3::option_spec::required);
+    parser.add_option(arguments.out_file,
+                      '\0',
+                      "output",
+                      "Path to the updated index. May be the same as --input.",
+                      seqan3::option_spec::required);
+    parser.add_option(arguments.threads,
+                      '\0',
+                      "threads",
+                      "The numer of threads to use.",
+                      seqan3::option_spec::standard,
+                      positive_integer_validator{});
+    parser.add_flag(arguments.is_hibf,
+                    '\0',
+                    "hibf",
+                    "Index is an HIBF.",
+                    seqan3::option_spec::advanced);
+    parser.add_option(arguments.fpr,
+                      '\0',
+                      "fpr",
+                      "False positive rate of the HIBF. Should be the one the HIBF was built with.",
+                      seqan3::option_spec::advanced,
+                      seqan3::arithmetic_range_validator{0.0, 1.0});
+    parser.add_flag(arguments.huge_pages,
+                    '\0',
+                    "huge-pages",
+                    "Back the index with transparent huge pages during the update.",
+                    seqan3::option_spec::advanced);
+    parser.add_option(arguments.metrics_file,
+                      '\0',
+                      "metrics",
+                      "Write per-stage timings, per-thread timings, rates, and peak memory usage as JSON to this file.",
+                      seqan3::option_spec::advanced);
+}
+
+void update_parsing(seqan3::argument_parser & parser)
+{
+    update_arguments arguments{};
+    init_update_parser(parser, arguments);
+    parser.parse();
+
+    // ==========================================
+    // Various checks.
+    // ==========================================
+    std::filesystem::path output_directory = arguments.out_file.parent_path();
+    std::error_code ec{};
+    std::filesystem::create_directories(output_directory, ec);
+
+// GCOVR_EXCL_START
+    if (!output_directory.empty() && ec)
+        throw seqan3::argument_parser_error{seqan3::detail::to_string("Failed to create directory\"",
+                                                                      output_directory.c_str(),
+                                                                      "\": ",
+                                                                      ec.message())};
+// GCOVR_EXCL_STOP
+
+    bool partitioned{false};
+    seqan3::input_file_validator validator{};
+
+    try
+    {
+        validator(arguments.in_file.string() + std::string{"_0"});
+        partitioned = true;
+    }
+    catch (seqan3::validation_error const & e)
+    {
+        validator(arguments.in_file);
+    }
+
+    // ==========================================
+    // Read the parameters of the index.
+    // ==========================================
+    std::vector<std::vector<std::string>> old_bin_path{};
+    {
+        std::ifstream is{partitioned ? arguments.in_file.string() + std::string{"_0"} : arguments.in_file.string(),
+                         std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        raptor_index<> tmp{};
+        tmp.load_parameters(iarchive);
+
+        if (tmp.compressed())
+            throw seqan3::argument_parser_error{"Compressed indices cannot be updated."};
+
+        arguments.window_size = tmp.window_size();
+        arguments.shape = tmp.shape();
+        arguments.parts = tmp.parts();
+        old_bin_path = tmp.bin_path();
+    }
+
+    // ==========================================
+    // Process bin_path
+    // ==========================================
+    parse_bin_path(arguments);
+
+    // An HIBF may need to read existing user bins again, see raptor::hibf::update_hibf. Removed user bins are empty.
+    auto old_user_bin = std::ranges::find_if(old_bin_path, [] (auto const & file_names) { return !file_names.empty(); });
+    if (arguments.is_hibf && old_user_bin != old_bin_path.end())
+    {
+        auto is_minimiser = [] (std::string const & filename)
+        {
+            return std::filesystem::path{filename.substr(0, filename.find(';'))}.extension() == ".minimiser";
+        };
+
+        if (is_minimiser((*old_user_bin)[0]) != is_minimiser(arguments.bin_path[0][0]))
+            throw seqan3::argument_parser_error{"The new user bins must be of the same kind (.minimiser or sequence "
+                                                "files) as the ones in the index."};
+    }
+
+    // ==========================================
+    // Check w and k of the minimiser header file
+    // ==========================================
+    if (std::filesystem::path header_file_path = arguments.bin_path[0][0]; header_file_path.extension() == ".minimiser")
+    {
+        arguments.is_minimiser = true;
+
+        if (arguments.parts > 1u)
+            throw seqan3::argument_parser_error{"Partitioned indices cannot be updated with .minimiser files."};
+
+        header_file_path.replace_extension("header");
+        std::ifstream file_stream{header_file_path};
+        std::string shape_string{};
+        uint32_t window_size{};
+        file_stream >> shape_string >> window_size;
+
+        if (shape_string != arguments.shape.to_string() || window_size != arguments.window_size)
+            throw seqan3::argument_parser_error{"The minimisers were computed with a different shape or window size "
+                                                "than the index."};
+    }
+
+    // ==========================================
+    // Dispatch
+    // ==========================================
+    raptor_update(arguments);
+}
+
+} // namespace raptor
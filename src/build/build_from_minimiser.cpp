@@ -5,35 +5,50 @@
 // shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
 // -----------------------------------------------------------------------------------------------------
 
+#include <raptor/build/atomic_insertion_agent.hpp>
 #include <raptor/build/build_from_minimiser.hpp>
 #include <raptor/build/call_parallel_on_bins.hpp>
+#include <raptor/build/minimiser_file.hpp>
 #include <raptor/build/store_index.hpp>
+#include <raptor/huge_pages.hpp>
 
 namespace raptor
 {
 
-void build_from_minimiser(build_arguments const & arguments)
+void insert_minimisers(build_arguments const & arguments, raptor_index<> & index, size_t const first_bin)
 {
-    raptor_index<> index{arguments};
+    atomic_insertion_agent const agent{index.ibf()};
 
     auto worker = [&] (auto && zipped_view, auto &&)
         {
-            uint64_t read_number;
-            auto & ibf = index.ibf();
+            uint64_t minimiser_count{};
 
             for (auto && [file_names, bin_number] : zipped_view)
             {
-                for (auto && file_name : file_names)
-                {
-                    std::ifstream infile{file_name, std::ios::binary};
+                seqan3::bin_index const bin_index{first_bin + bin_number};
 
-                    while(infile.read(reinterpret_cast<char*>(&read_number), sizeof(read_number)))
-                        ibf.emplace(read_number, seqan3::bin_index{bin_number});
-                }
+                // The files are read and decoded in the background while the minimisers are inserted.
+                for_each_minimiser_block(file_names, [&] (std::vector<uint64_t> const & minimisers)
+                {
+                    for (uint64_t const value : minimisers)
+                        agent.emplace(value, bin_index);
+                    minimiser_count += minimisers.size();
+                });
             }
+
+            arguments.metrics.minimisers += minimiser_count;
         };
 
     call_parallel_on_bins(std::move(worker), arguments);
+}
+
+void build_from_minimiser(build_arguments const & arguments)
+{
+    raptor_index<> index{arguments};
+    if (arguments.huge_pages)
+        advise_huge_pages(index.ibf());
+
+    insert_minimisers(arguments, index, 0u);
 
     if (arguments.compressed)
     {
@@ -5,14 +5,14 @@
 // shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
 // -----------------------------------------------------------------------------------------------------
 
-#include <robin_hood.h>
-
 #include <seqan3/io/sequence_file/input.hpp>
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
 #include <raptor/build/call_parallel_on_bins.hpp>
 #include <raptor/build/compute_minimiser.hpp>
+#include <raptor/build/minimiser_counter.hpp>
+#include <raptor/build/minimiser_file.hpp>
 #include <raptor/dna4_traits.hpp>
 
 namespace raptor
@@ -55,11 +55,17 @@ void compute_minimiser(build_arguments const & arguments)
     std::array<uint16_t, 4> const cutoffs{1, 3, 10, 20};
     std::array<uint64_t, 4> const cutoff_bounds{314'572'800, 524'288'000, 1'073'741'824, 3'221'225'472};
 
+    // Unlike raptor::index_factory, bins are not split into chunks: The cutoff depends on the size of the whole
+    // file, and the counts of all minimisers of a bin must be in one counter.
     auto worker = [&] (auto && zipped_view, auto &&)
     {
-        robin_hood::unordered_map<uint64_t, uint8_t> minimiser_table{};
+        // With --memory-limit, each thread gets an equal share of the limit.
+        minimiser_counter minimiser_table{arguments.memory_limit / arguments.threads, arguments.out_path};
         uint64_t count{0};
         uint16_t cutoff{0};
+        uint64_t sequence_count{0};
+        uint64_t minimiser_count{0};
+        std::vector<uint64_t> sorted_minimisers{};
 
         for (auto && [file_names, bin_number] : zipped_view)
         {
@@ -68,11 +74,17 @@ void compute_minimiser(build_arguments const & arguments)
                 seqan3::sequence_file_input<dna4_traits, seqan3::fields<seqan3::field::seq>> fin{file_name};
 
                 for (auto & [seq] : fin)
+                {
+                    ++sequence_count;
                     for (auto && hash : seq | minimiser_view)
-                        minimiser_table[hash] = std::min<uint8_t>(254u, minimiser_table[hash] + 1);
-                        // The hash table stores how often a minimiser appears. It does not matter whether a minimiser appears
+                    {
+                        // The counter stores how often a minimiser appears. It does not matter whether a minimiser appears
                         // 50 times or 2000 times, it is stored regardless because the biggest cutoff value is 50. Hence,
-                        // the hash table stores only values up to 254 to save memory.
+                        // the counter stores only values up to 254 to save memory.
+                        minimiser_table.add(hash);
+                        ++minimiser_count;
+                    }
+                }
             }
 
             std::filesystem::path const file_name{file_names[0]};
@@ -102,15 +114,30 @@ void compute_minimiser(build_arguments const & arguments)
             std::filesystem::path output_path{arguments.out_path};
             output_path /= is_compressed ? file_name.stem().stem() : file_name.stem();
             output_path += ".minimiser";
-            std::ofstream outfile{output_path, std::ios::binary};
-            for (auto && hash : minimiser_table)
+            minimiser_file_writer outfile{output_path};
+            // The minimisers must be written in ascending order. Only with a memory limit, they are already sorted.
+            if (arguments.memory_limit == 0u)
             {
-                if (hash.second >= cutoff)
+                minimiser_table.for_each([&] (uint64_t const hash, uint8_t const occurrences)
                 {
-                    outfile.write(reinterpret_cast<const char*>(&hash.first), sizeof(hash.first));
-                    ++count;
-                }
+                    if (occurrences >= cutoff)
+                        sorted_minimisers.push_back(hash);
+                });
+                std::ranges::sort(sorted_minimisers);
+                for (uint64_t const hash : sorted_minimisers)
+                    outfile.push_back(hash);
+                sorted_minimisers.clear();
             }
+            else
+            {
+                minimiser_table.for_each([&] (uint64_t const hash, uint8_t const occurrences)
+                {
+                    if (occurrences >= cutoff)
+                        outfile.push_back(hash);
+                });
+            }
+            outfile.close();
+            count = outfile.size();
 
             // Store header file
             output_path = arguments.out_path;
@@ -123,11 +150,13 @@ void compute_minimiser(build_arguments const & arguments)
                         << count << '\n';
 
             count = 0;
-            minimiser_table.clear();
         }
+
+        arguments.metrics.reads += sequence_count;
+        arguments.metrics.minimisers += minimiser_count;
     };
 
-    call_parallel_on_bins(worker, arguments);
+    call_parallel_on_bins(worker, arguments, "compute_minimiser");
 }
 
 } // namespace raptor
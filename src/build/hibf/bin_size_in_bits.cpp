@@ -5,6 +5,7 @@
 // shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
 // -----------------------------------------------------------------------------------------------------
 
+#include <cassert>
 #include <cmath>
 
 #include <raptor/build/hibf/bin_size_in_bits.hpp>
@@ -20,4 +21,26 @@ size_t bin_size_in_bits(build_arguments const & arguments, size_t const number_o
     return result;
 }
 
+size_t max_number_of_kmers(build_arguments const & arguments, size_t const bin_size)
+{
+    double const numerator{- static_cast<double>(bin_size) * std::log(1 - std::exp(std::log(arguments.fpr) / arguments.hash))};
+    return std::floor(numerator / arguments.hash);
+}
+
+std::vector<double> fp_correction_factors(size_t const tmax, size_t const hash, double const fpr)
+{
+    std::vector<double> fp_correction(tmax + 1, 1.0);
+
+    double const denominator = std::log(1 - std::exp(std::log(fpr) / hash));
+
+    for (size_t i = 2; i <= tmax; ++i)
+    {
+        double const tmp = 1.0 - std::pow(1 - fpr, static_cast<double>(i));
+        fp_correction[i] = std::log(1 - std::exp(std::log(tmp) / hash)) / denominator;
+        assert(fp_correction[i] >= 1.0);
+    }
+
+    return fp_correction;
+}
+
 } // namespace raptor::hibf
@@ -7,6 +7,8 @@
 
 #include <lemon/list_graph.h> /// Must be first include.
 
+#include <chrono>
+
 #include <raptor/build/hibf/chopper_build.hpp>
 #include <raptor/build/hibf/create_ibfs_from_chopper_pack.hpp>
 #include <raptor/build/store_index.hpp>
@@ -20,7 +22,10 @@ void chopper_build(build_arguments const & arguments)
 {
     build_data<data_layout_mode> data{};
 
+    auto start = std::chrono::high_resolution_clock::now();
     create_ibfs_from_chopper_pack(data, arguments);
+    auto end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage("hierarchical_build", std::chrono::duration<double>(end - start).count());
 
     std::vector<std::vector<std::string>> bin_path{};
     for (size_t i{0}; i < data.hibf.user_bins.num_user_bins(); ++i)
@@ -5,40 +5,94 @@
 // shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
 // -----------------------------------------------------------------------------------------------------
 
+#include <chrono>
+
+#include <robin_hood.h>
+
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
 #include <raptor/build/hibf/compute_kmers.hpp>
+#include <raptor/build/hibf/kmer_union.hpp>
+#include <raptor/build/minimiser_file.hpp>
 #include <raptor/dna4_traits.hpp>
 
 namespace raptor::hibf
 {
 
-void compute_kmers(robin_hood::unordered_flat_set<size_t> & kmers,
+void compute_kmers(std::vector<uint64_t> & kmers,
                    build_arguments const & arguments,
-                   chopper_pack_record const & record)
+                   chopper_pack_record const & record,
+                   size_t const set_capacity)
 {
-    if (arguments.is_minimiser)
+    auto start = std::chrono::high_resolution_clock::now();
+    uint64_t sequence_count{};
+    uint64_t minimiser_count{};
+
+    bool const is_split = record.number_of_bins.back() > 1;
+    robin_hood::unordered_flat_set<uint64_t> split_kmers{};
+    size_t compacted_size{};
+
+    if (is_split)
+        split_kmers.reserve(set_capacity);
+
+    auto insert = [&] (uint64_t const hash)
     {
-        uint64_t minimiser_value{};
-        for (auto const & filename : record.filenames)
+        if (is_split)
         {
-            std::ifstream infile{filename, std::ios::binary};
-
-            while(infile.read(reinterpret_cast<char*>(&minimiser_value), sizeof(minimiser_value)))
-                kmers.insert(minimiser_value);
+            split_kmers.insert(hash);
+        }
+        else
+        {
+            kmers.push_back(hash);
+            // Remove duplicates whenever the size doubles. Bounds the memory to twice the number of distinct k-mers.
+            if (kmers.size() >= 2u * compacted_size && kmers.size() >= (1u << 20))
+            {
+                sort_and_deduplicate(kmers);
+                compacted_size = kmers.size();
+            }
         }
+    };
+
+    if (arguments.is_minimiser)
+    {
+        for_each_minimiser_block(record.filenames, [&] (std::vector<uint64_t> const & minimisers)
+        {
+            if (is_split)
+                split_kmers.insert(minimisers.begin(), minimisers.end());
+            else
+                kmers.insert(kmers.end(), minimisers.begin(), minimisers.end());
+            minimiser_count += minimisers.size();
+        });
     }
     else
     {
         using sequence_file_t = seqan3::sequence_file_input<dna4_traits, seqan3::fields<seqan3::field::seq>>;
         for (auto const & filename : record.filenames)
+        {
             for (auto && [seq] : sequence_file_t{filename})
+            {
+                ++sequence_count;
                 for (auto hash : seq | seqan3::views::minimiser_hash(arguments.shape,
                                                                      seqan3::window_size{arguments.window_size},
                                                                      seqan3::seed{adjust_seed(arguments.shape.count())}))
-                    kmers.insert(hash);
+                {
+                    insert(hash);
+                    ++minimiser_count;
+                }
+            }
+        }
     }
+
+    if (is_split)
+        kmers.assign(split_kmers.begin(), split_kmers.end());
+    else
+        sort_and_deduplicate(kmers); // .minimiser files are sorted, this only merges multiple files.
+
+    auto end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_thread_time("compute_kmers", std::chrono::duration<double>(end - start).count());
+    arguments.metrics.reads += sequence_count;
+    arguments.metrics.minimisers += minimiser_count;
 }
 
 } // namespace raptor::hibf
@@ -10,13 +10,15 @@
 #include <raptor/build/hibf/bin_size_in_bits.hpp>
 #include <raptor/build/hibf/construct_ibf.hpp>
 #include <raptor/build/hibf/insert_into_ibf.hpp>
+#include <raptor/huge_pages.hpp>
 
 namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-seqan3::interleaved_bloom_filter<> construct_ibf(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                                                 robin_hood::unordered_flat_set<size_t> & kmers,
+seqan3::interleaved_bloom_filter<> construct_ibf(kmer_union & parent_kmers,
+                                                 std::vector<uint64_t> && kmers,
+                                                 kmer_union & favourite_kmers,
                                                  size_t const number_of_bins,
                                                  lemon::ListDigraph::Node const & node,
                                                  build_data<data_layout_mode> & data,
@@ -24,22 +26,30 @@ seqan3::interleaved_bloom_filter<> construct_ibf(robin_hood::unordered_flat_set<
                                                  bool is_root)
 {
     auto & node_data = data.node_map[node];
+    bool const max_bin_is_merged{node_data.favourite_child != lemon::INVALID};
 
-    size_t const kmers_per_bin{static_cast<size_t>(std::ceil(static_cast<double>(kmers.size()) / number_of_bins))};
+    size_t const max_bin_kmers{max_bin_is_merged ? favourite_kmers.size() : kmers.size()};
+    size_t const kmers_per_bin{static_cast<size_t>(std::ceil(static_cast<double>(max_bin_kmers) / number_of_bins))};
     double const bin_bits{static_cast<double>(bin_size_in_bits(arguments, kmers_per_bin))};
     seqan3::bin_size const bin_size{static_cast<size_t>(std::ceil(bin_bits * data.fp_correction[number_of_bins]))};
     seqan3::bin_count const bin_count{node_data.number_of_technical_bins};
     seqan3::interleaved_bloom_filter<> ibf{bin_count, bin_size, seqan3::hash_function_count{arguments.hash}};
+    if (arguments.huge_pages)
+        advise_huge_pages(ibf);
 
-    insert_into_ibf(parent_kmers, kmers, number_of_bins, node_data.max_bin_index, ibf, is_root);
+    if (max_bin_is_merged)
+        insert_into_ibf(parent_kmers, favourite_kmers, node_data.max_bin_index, ibf, is_root);
+    else
+        insert_into_ibf(parent_kmers, std::move(kmers), number_of_bins, node_data.max_bin_index, ibf, is_root);
 
     return ibf;
 }
 
 template
 seqan3::interleaved_bloom_filter<>
-construct_ibf<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<size_t> &,
-                                                 robin_hood::unordered_flat_set<size_t> &,
+construct_ibf<seqan3::data_layout::uncompressed>(kmer_union &,
+                                                 std::vector<uint64_t> &&,
+                                                 kmer_union &,
                                                  size_t const,
                                                  lemon::ListDigraph::Node const &,
                                                  build_data<seqan3::data_layout::uncompressed> &,
@@ -48,8 +58,9 @@ construct_ibf<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<
 
 template
 seqan3::interleaved_bloom_filter<>
-construct_ibf<seqan3::data_layout::compressed>(robin_hood::unordered_flat_set<size_t> &,
-                                               robin_hood::unordered_flat_set<size_t> &,
+construct_ibf<seqan3::data_layout::compressed>(kmer_union &,
+                                               std::vector<uint64_t> &&,
+                                               kmer_union &,
                                                size_t const,
                                                lemon::ListDigraph::Node const &,
                                                build_data<seqan3::data_layout::compressed> &,
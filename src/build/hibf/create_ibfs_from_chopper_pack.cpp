@@ -19,12 +19,18 @@ void create_ibfs_from_chopper_pack(build_data<data_layout_mode> & data, build_ar
 {
     read_chopper_pack_file(data, arguments.bin_file);
     lemon::ListDigraph::Node root = data.ibf_graph.nodeFromId(0); // root node = high level IBF node
-    robin_hood::unordered_flat_set<size_t> root_kmers{};
 
     size_t const t_max{data.node_map[root].number_of_technical_bins};
     data.compute_fp_correction(t_max, arguments.hash, arguments.fpr);
+    data.scheduler.emplace(arguments.threads);
+    // Spilled k-mers go next to the index, also if --output has no directory part.
+    data.storage.emplace(arguments.memory_limit, std::filesystem::absolute(arguments.out_path).parent_path());
+
+    kmer_union root_kmers{*data.storage};
 
     hierarchical_build(root_kmers, root, data, arguments, true);
+
+    arguments.metrics.spilled_files += data.storage->files();
 }
 
 template
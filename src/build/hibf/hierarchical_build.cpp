@@ -12,6 +12,7 @@
 #include <raptor/build/hibf/hierarchical_build.hpp>
 #include <raptor/build/hibf/initialise_max_bin_kmers.hpp>
 #include <raptor/build/hibf/insert_into_ibf.hpp>
+#include <raptor/build/hibf/kmer_union.hpp>
 #include <raptor/build/hibf/loop_over_children.hpp>
 #include <raptor/build/hibf/update_user_bins.hpp>
 
@@ -19,7 +20,7 @@ namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-size_t hierarchical_build(robin_hood::unordered_flat_set<size_t> & parent_kmers,
+size_t hierarchical_build(kmer_union & parent_kmers,
                           lemon::ListDigraph::Node const & current_node,
                           build_data<data_layout_mode> & data,
                           build_arguments const & arguments,
@@ -31,12 +32,17 @@ size_t hierarchical_build(robin_hood::unordered_flat_set<size_t> & parent_kmers,
 
     std::vector<int64_t> ibf_positions(current_node_data.number_of_technical_bins, ibf_pos);
     std::vector<int64_t> filename_indices(current_node_data.number_of_technical_bins, -1);
-    robin_hood::unordered_flat_set<size_t> kmers{};
+    std::vector<uint64_t> kmers{};
+    // The k-mers of the max bin if it is a merged bin.
+    kmer_union favourite_kmers{*data.storage};
 
     // initialize lower level IBF
-    size_t const max_bin_tbs = initialise_max_bin_kmers(kmers, ibf_positions, filename_indices, current_node, data, arguments);
-    auto && ibf = construct_ibf(parent_kmers, kmers, max_bin_tbs, current_node, data, arguments, is_root);
-    kmers.clear(); // reduce memory peak
+    size_t const max_bin_tbs =
+        initialise_max_bin_kmers(kmers, favourite_kmers, ibf_positions, filename_indices, current_node, data, arguments);
+    size_t max_kmer_count{std::max(kmers.size(), favourite_kmers.size())}; // See compute_kmers.
+    // All k-mers stored in this IBF are collected in parent_kmers.
+    auto && ibf = construct_ibf(parent_kmers, std::move(kmers), favourite_kmers, max_bin_tbs, current_node, data, arguments, is_root);
+    kmers = std::vector<uint64_t>{}; // reduce memory peak
 
     // parse all other children (merged bins) of the current ibf
     loop_over_children(parent_kmers, ibf, ibf_positions, current_node, data, arguments, is_root);
@@ -53,14 +59,19 @@ size_t hierarchical_build(robin_hood::unordered_flat_set<size_t> & parent_kmers,
         }
         else
         {
-            compute_kmers(kmers, arguments, record);
-            insert_into_ibf(parent_kmers, kmers, record.number_of_bins.back(), record.bin_indices.back(), ibf, is_root);
+            compute_kmers(kmers, arguments, record, max_kmer_count);
+            max_kmer_count = std::max(max_kmer_count, kmers.size());
+            insert_into_ibf(parent_kmers, std::move(kmers), record.number_of_bins.back(), record.bin_indices.back(), ibf, is_root);
         }
 
         update_user_bins(data, filename_indices, record);
-        kmers.clear();
+        kmers = std::vector<uint64_t>{};
     }
 
+    // The union is passed to the parent, or written to a temporary file if the memory limit is reached.
+    if (!is_root)
+        parent_kmers.merge();
+
     data.hibf.ibf_vector[ibf_pos] = std::move(ibf);
     data.hibf.next_ibf_id[ibf_pos] = std::move(ibf_positions);
     data.hibf.user_bins.bin_indices_of_ibf(ibf_pos) = std::move(filename_indices);
@@ -69,14 +80,14 @@ size_t hierarchical_build(robin_hood::unordered_flat_set<size_t> & parent_kmers,
 }
 
 template
-size_t hierarchical_build<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<size_t> &,
+size_t hierarchical_build<seqan3::data_layout::uncompressed>(kmer_union &,
                                                              lemon::ListDigraph::Node const &,
                                                              build_data<seqan3::data_layout::uncompressed> &,
                                                              build_arguments const &,
                                                              bool);
 
 template
-size_t hierarchical_build<seqan3::data_layout::compressed>(robin_hood::unordered_flat_set<size_t> &,
+size_t hierarchical_build<seqan3::data_layout::compressed>(kmer_union &,
                                                            lemon::ListDigraph::Node const &,
                                                            build_data<seqan3::data_layout::compressed> &,
                                                            build_arguments const &,
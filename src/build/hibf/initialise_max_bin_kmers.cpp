@@ -16,7 +16,8 @@ namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-size_t initialise_max_bin_kmers(robin_hood::unordered_flat_set<size_t> & kmers,
+size_t initialise_max_bin_kmers(std::vector<uint64_t> & kmers,
+                                kmer_union & favourite_kmers,
                                 std::vector<int64_t> & ibf_positions,
                                 std::vector<int64_t> & filename_indices,
                                 lemon::ListDigraph::Node const & node,
@@ -28,7 +29,7 @@ size_t initialise_max_bin_kmers(robin_hood::unordered_flat_set<size_t> & kmers,
     if (node_data.favourite_child != lemon::INVALID) // max bin is a merged bin
     {
         // recursively initialize favourite child first
-        ibf_positions[node_data.max_bin_index] = hierarchical_build(kmers, node_data.favourite_child, data, arguments, false);
+        ibf_positions[node_data.max_bin_index] = hierarchical_build(favourite_kmers, node_data.favourite_child, data, arguments, false);
         return 1;
     }
     else // max bin is not a merged bin
@@ -43,7 +44,8 @@ size_t initialise_max_bin_kmers(robin_hood::unordered_flat_set<size_t> & kmers,
 }
 
 template
-size_t initialise_max_bin_kmers<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<size_t> &,
+size_t initialise_max_bin_kmers<seqan3::data_layout::uncompressed>(std::vector<uint64_t> &,
+                                                                   kmer_union &,
                                                                    std::vector<int64_t> &,
                                                                    std::vector<int64_t> &,
                                                                    lemon::ListDigraph::Node const &,
@@ -51,7 +53,8 @@ size_t initialise_max_bin_kmers<seqan3::data_layout::uncompressed>(robin_hood::u
                                                                    build_arguments const &);
 
 template
-size_t initialise_max_bin_kmers<seqan3::data_layout::compressed>(robin_hood::unordered_flat_set<size_t> &,
+size_t initialise_max_bin_kmers<seqan3::data_layout::compressed>(std::vector<uint64_t> &,
+                                                                 kmer_union &,
                                                                  std::vector<int64_t> &,
                                                                  std::vector<int64_t> &,
                                                                  lemon::ListDigraph::Node const &,
@@ -8,15 +8,17 @@
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
+#include <raptor/build/atomic_insertion_agent.hpp>
 #include <raptor/build/hibf/insert_into_ibf.hpp>
+#include <raptor/build/minimiser_file.hpp>
 #include <raptor/dna4_traits.hpp>
 
 namespace raptor::hibf
 {
 
 // automatically does naive splitting if number_of_bins > 1
-void insert_into_ibf(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                     robin_hood::unordered_flat_set<size_t> const & kmers,
+void insert_into_ibf(kmer_union & parent_kmers,
+                     std::vector<uint64_t> && kmers,
                      size_t const number_of_bins,
                      size_t const bin_index,
                      seqan3::interleaved_bloom_filter<> & ibf,
@@ -30,13 +32,34 @@ void insert_into_ibf(robin_hood::unordered_flat_set<size_t> & parent_kmers,
         assert(chunk_number < number_of_bins);
         seqan3::bin_index const bin_idx{bin_index + chunk_number};
         ++chunk_number;
-        for (size_t const value : chunk)
-        {
+        for (uint64_t const value : chunk)
             ibf.emplace(value, bin_idx);
-            if (!is_root)
-                parent_kmers.insert(value);
-        }
     }
+
+    if (!is_root)
+        parent_kmers.add(std::move(kmers));
+}
+
+void insert_into_ibf(kmer_union & parent_kmers,
+                     kmer_union & kmers,
+                     size_t const bin_index,
+                     seqan3::interleaved_bloom_filter<> & ibf,
+                     bool is_root)
+{
+    seqan3::bin_index const bin_idx{bin_index};
+    // Other children of the same parent are inserted concurrently.
+    atomic_insertion_agent const agent{ibf};
+
+    kmers.for_each_block([&] (std::vector<uint64_t> const & block)
+    {
+        for (uint64_t const value : block)
+            agent.emplace(value, bin_idx);
+    });
+
+    if (!is_root)
+        parent_kmers.add(kmers);
+    else
+        kmers.clear();
 }
 
 void insert_into_ibf(build_arguments const & arguments,
@@ -47,14 +70,11 @@ void insert_into_ibf(build_arguments const & arguments,
 
     if (arguments.is_minimiser)
     {
-        uint64_t minimiser_value{};
-        for (auto const & filename : record.filenames)
+        for_each_minimiser_block(record.filenames, [&] (std::vector<uint64_t> const & minimisers)
         {
-            std::ifstream infile{filename, std::ios::binary};
-
-            while(infile.read(reinterpret_cast<char*>(&minimiser_value), sizeof(minimiser_value)))
-                ibf.emplace(minimiser_value, bin_index);
-        }
+            for (uint64_t const value : minimisers)
+                ibf.emplace(value, bin_index);
+        });
     }
     else
     {
@@ -7,8 +7,6 @@
 
 #include <lemon/list_graph.h> /// Must be first include.
 
-#include <seqan3/core/algorithm/detail/execution_handler_parallel.hpp>
-
 #include <raptor/build/hibf/hierarchical_build.hpp>
 #include <raptor/build/hibf/insert_into_ibf.hpp>
 #include <raptor/build/hibf/loop_over_children.hpp>
@@ -17,7 +15,7 @@ namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-void loop_over_children(robin_hood::unordered_flat_set<size_t> & parent_kmers,
+void loop_over_children(kmer_union & parent_kmers,
                         seqan3::interleaved_bloom_filter<> & ibf,
                         std::vector<int64_t> & ibf_positions,
                         lemon::ListDigraph::Node const & current_node,
@@ -34,48 +32,31 @@ void loop_over_children(robin_hood::unordered_flat_set<size_t> & parent_kmers,
     if (children.empty())
         return;
 
-    size_t const number_of_mutex = (data.node_map[current_node].number_of_technical_bins + 63) / 64;
-    std::vector<std::mutex> local_ibf_mutex(number_of_mutex);
-
-    auto worker = [&] (auto && index, auto &&)
+    auto worker = [&] (size_t const index)
     {
         auto & child = children[index];
 
         if (child != current_node_data.favourite_child)
         {
-            robin_hood::unordered_flat_set<size_t> kmers{};
+            kmer_union kmers{*data.storage};
             size_t const ibf_pos = hierarchical_build(kmers, child, data, arguments, false);
             auto parent_bin_index = data.node_map[child].parent_bin_index;
-            {
-                size_t const mutex_id{parent_bin_index / 64};
-                std::lock_guard<std::mutex> guard{local_ibf_mutex[mutex_id]};
-                ibf_positions[parent_bin_index] = ibf_pos;
-                insert_into_ibf(parent_kmers, kmers, 1, parent_bin_index, ibf, is_root);
-            }
+            ibf_positions[parent_bin_index] = ibf_pos;
+            insert_into_ibf(parent_kmers, kmers, parent_bin_index, ibf, is_root);
         }
     };
 
-    size_t number_of_threads{};
-    auto indices_view = std::views::iota(0u, children.size()) | std::views::common;
-    std::vector<size_t> indices{indices_view.begin(), indices_view.end()};
-
-    if (is_root)
-    {
-        // Shuffle indices: More likely to not block each other. Optimal: Interleave
-        std::shuffle(indices.begin(), indices.end(), std::mt19937_64{std::random_device{}()});
-        number_of_threads = arguments.threads;
-    }
-    else
-    {
-        number_of_threads = 1u;
-    }
-
-    seqan3::detail::execution_handler_parallel executioner{number_of_threads};
-    executioner.bulk_execute(std::move(worker), std::move(indices), [] () {});
+    // Each child is a task. Children of children are tasks as well, hence all subtrees are built in parallel.
+    // While waiting, this thread builds children itself.
+    // The children are inserted into different bins of `ibf` without locking, see raptor::atomic_insertion_agent.
+    task_scheduler::task_group children_group{};
+    for (size_t index = 0; index < children.size(); ++index)
+        data.scheduler->run(children_group, [&worker, index] () { worker(index); });
+    data.scheduler->wait(children_group);
 }
 
 template
-void loop_over_children<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<size_t> &,
+void loop_over_children<seqan3::data_layout::uncompressed>(kmer_union &,
                                                            seqan3::interleaved_bloom_filter<> &,
                                                            std::vector<int64_t> &,
                                                            lemon::ListDigraph::Node const &,
@@ -85,7 +66,7 @@ void loop_over_children<seqan3::data_layout::uncompressed>(robin_hood::unordered
 
 
 template
-void loop_over_children<seqan3::data_layout::compressed>(robin_hood::unordered_flat_set<size_t> &,
+void loop_over_children<seqan3::data_layout::compressed>(kmer_union &,
                                                          seqan3::interleaved_bloom_filter<> &,
                                                          std::vector<int64_t> &,
                                                          lemon::ListDigraph::Node const &,
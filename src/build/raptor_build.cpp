@@ -5,6 +5,8 @@
 // shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
 // -----------------------------------------------------------------------------------------------------
 
+#include <chrono>
+
 #include <raptor/build/build_from_files.hpp>
 #include <raptor/build/build_from_minimiser.hpp>
 #include <raptor/build/compute_minimiser.hpp>
@@ -16,6 +18,18 @@ namespace raptor
 
 void raptor_build(build_arguments const & arguments)
 {
+    for (auto const & file_list : arguments.bin_path)
+    {
+        for (auto const & file_name : file_list)
+        {
+            std::error_code ec{};
+            if (uint64_t const file_size = std::filesystem::file_size(file_name, ec); !ec)
+                arguments.metrics.bytes += file_size;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
     if (arguments.compute_minimiser)
         compute_minimiser(arguments);
     else if (arguments.is_hibf)
@@ -29,6 +43,12 @@ void raptor_build(build_arguments const & arguments)
         build_from_files<true>(arguments);
     else
         build_from_files<false>(arguments);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage("total", std::chrono::duration<double>(end - start).count());
+
+    if (!arguments.metrics_file.empty())
+        arguments.metrics.write(arguments.metrics_file, "build");
 }
 
 } // namespace raptor
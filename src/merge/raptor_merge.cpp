@@ -0,0 +1,97 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <chrono>
+
+#include <raptor/build/store_index.hpp>
+#include <raptor/merge/merge.hpp>
+#include <raptor/merge/merge_ibf.hpp>
+
+namespace raptor
+{
+
+// Merges each part separately. Only the merged IBF and one input IBF are in memory at the same time.
+void raptor_merge(merge_arguments const & arguments)
+{
+    auto total_start = std::chrono::high_resolution_clock::now();
+
+    for (size_t part = 0; part < arguments.parts; ++part)
+    {
+        std::filesystem::path out_file{arguments.out_file};
+        if (arguments.parts > 1u)
+            out_file += "_" + std::to_string(part);
+
+        raptor_index<> merged{};
+        std::vector<std::vector<std::string>> bin_path{};
+        bin_path.reserve(arguments.bins);
+
+        for (size_t i = 0; i < arguments.in_files.size(); ++i)
+        {
+            std::filesystem::path in_file{arguments.in_files[i]};
+            if (arguments.parts > 1u)
+                in_file += "_" + std::to_string(part);
+
+            raptor_index<> index{};
+            {
+                auto start = std::chrono::high_resolution_clock::now();
+                std::ifstream is{in_file, std::ios::binary};
+                cereal::BinaryInputArchive iarchive{is};
+                iarchive(index);
+                auto end = std::chrono::high_resolution_clock::now();
+                arguments.metrics.add_stage("index_io", std::chrono::duration<double>(end - start).count());
+            }
+
+            auto const & ibf = index.ibf();
+
+            // The first index determines the bin size and number of hash functions.
+            if (i == 0u)
+            {
+                merged = raptor_index<>{window{index.window_size()},
+                                        index.shape(),
+                                        index.parts(),
+                                        false,
+                                        {},
+                                        index_structure::ibf{seqan3::bin_count{arguments.bins},
+                                                             seqan3::bin_size{ibf.bin_size()},
+                                                             seqan3::hash_function_count{ibf.hash_function_count()}}};
+            }
+            else if (ibf.bin_size() != merged.ibf().bin_size() ||
+                     ibf.hash_function_count() != merged.ibf().hash_function_count())
+            {
+                throw seqan3::argument_parser_error{"The index " + in_file.string() + " has a different size or "
+                                                    "number of hash functions than " +
+                                                    arguments.in_files[0].string() + "."};
+            }
+
+            if (ibf.bin_count() != index.bin_path().size() || bin_path.size() + ibf.bin_count() > arguments.bins)
+                throw seqan3::argument_parser_error{"The index " + in_file.string() + " is inconsistent."};
+
+            auto start = std::chrono::high_resolution_clock::now();
+            merge_into(merged.ibf(), ibf, bin_path.size(), arguments.threads);
+            auto end = std::chrono::high_resolution_clock::now();
+            arguments.metrics.add_stage("merge", std::chrono::duration<double>(end - start).count());
+
+            bin_path.insert(bin_path.end(), index.bin_path().begin(), index.bin_path().end());
+        }
+
+        raptor_index<> result{window{merged.window_size()},
+                              merged.shape(),
+                              merged.parts(),
+                              false,
+                              bin_path,
+                              std::move(merged.ibf())};
+        store_index(out_file, result, arguments);
+    }
+
+    auto total_end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage("total", std::chrono::duration<double>(total_end - total_start).count());
+
+    if (!arguments.metrics_file.empty())
+        arguments.metrics.write(arguments.metrics_file, "merge");
+}
+
+} // namespace raptor
@@ -7,7 +7,10 @@
 
 #include <raptor/argument_parsing/build_parsing.hpp>
 #include <raptor/argument_parsing/init_shared_meta.hpp>
+#include <raptor/argument_parsing/merge_parsing.hpp>
+#include <raptor/argument_parsing/remove_parsing.hpp>
 #include <raptor/argument_parsing/search_parsing.hpp>
+#include <raptor/argument_parsing/update_parsing.hpp>
 #include <raptor/argument_parsing/upgrade_parsing.hpp>
 #include <raptor/raptor.hpp>
 
@@ -15,7 +18,7 @@ int main(int argc, char ** argv)
 {
     try
     {
-        seqan3::argument_parser top_level_parser{"raptor", argc, argv, seqan3::update_notifications::on, {"build", "search", "socks", "upgrade"}};
+        seqan3::argument_parser top_level_parser{"raptor", argc, argv, seqan3::update_notifications::on, {"build", "merge", "remove", "search", "socks", "update", "upgrade"}};
         raptor::init_shared_meta(top_level_parser);
         top_level_parser.info.description.emplace_back("Raptor is a system for approximately searching many queries such as "
                                                        "next-generation sequencing reads or transcripts in large collections of "
@@ -30,6 +33,10 @@ int main(int argc, char ** argv)
         seqan3::argument_parser & sub_parser = top_level_parser.get_sub_parser();
         if (sub_parser.info.app_name == std::string_view{"raptor-build"})
             raptor::build_parsing(sub_parser, false);
+        if (sub_parser.info.app_name == std::string_view{"raptor-merge"})
+            raptor::merge_parsing(sub_parser);
+        if (sub_parser.info.app_name == std::string_view{"raptor-remove"})
+            raptor::remove_parsing(sub_parser);
         if (sub_parser.info.app_name == std::string_view{"raptor-search"})
             raptor::search_parsing(sub_parser, false);
         if (sub_parser.info.app_name == std::string_view{"raptor-socks"})
@@ -42,6 +49,8 @@ int main(int argc, char ** argv)
             if (socks_sub_parser.info.app_name == std::string_view{"socks-lookup-kmer"})
                 raptor::search_parsing(socks_sub_parser, true);
         }
+        if (sub_parser.info.app_name == std::string_view{"raptor-update"})
+            raptor::update_parsing(sub_parser);
         if (sub_parser.info.app_name == std::string_view{"raptor-upgrade"})
             raptor::upgrade_parsing(sub_parser);
     }
@@ -0,0 +1,108 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <raptor/build/store_index.hpp>
+#include <raptor/remove/remove.hpp>
+#include <raptor/remove/remove_user_bins.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+template <typename data_t>
+raptor_index<data_t> load(std::filesystem::path const & in_file)
+{
+    raptor_index<data_t> index{};
+    std::ifstream is{in_file, std::ios::binary};
+    cereal::BinaryInputArchive iarchive{is};
+    iarchive(index);
+    return index;
+}
+
+// Removed user bins have no file names in the index.
+std::vector<std::vector<std::string>> remove_from_bin_path(std::vector<std::vector<std::string>> bin_path,
+                                                           std::vector<bool> const & removed)
+{
+    for (size_t user_bin = 0; user_bin < bin_path.size(); ++user_bin)
+        if (removed[user_bin])
+            bin_path[user_bin].clear();
+
+    return bin_path;
+}
+
+} // namespace detail
+
+void remove_from_ibf(remove_arguments const & arguments)
+{
+    for (size_t part = 0; part < arguments.parts; ++part)
+    {
+        std::filesystem::path in_file{arguments.in_file};
+        std::filesystem::path out_file{arguments.out_file};
+        if (arguments.parts > 1u)
+        {
+            in_file += "_" + std::to_string(part);
+            out_file += "_" + std::to_string(part);
+        }
+
+        auto index = detail::load<index_structure::ibf>(in_file);
+        auto bin_path = detail::remove_from_bin_path(index.bin_path(), arguments.removed);
+
+        if (arguments.compact)
+        {
+            std::vector<size_t> kept_bins{};
+            for (size_t bin = 0; bin < bin_path.size(); ++bin)
+                if (!bin_path[bin].empty())
+                    kept_bins.push_back(bin);
+
+            if (kept_bins.size() < index.ibf().bin_count())
+                index.ibf() = compact_ibf(index.ibf(), kept_bins);
+            std::erase_if(bin_path, [] (std::vector<std::string> const & file_names) { return file_names.empty(); });
+        }
+        else
+        {
+            remove_user_bins(index.ibf(), arguments.removed);
+        }
+
+        raptor_index<> updated{window{index.window_size()},
+                               index.shape(),
+                               index.parts(),
+                               false,
+                               bin_path,
+                               std::move(index.ibf())};
+        store_index(out_file, updated, arguments);
+    }
+}
+
+void remove_from_hibf(remove_arguments const & arguments)
+{
+    auto index = detail::load<index_structure::hibf>(arguments.in_file);
+    auto bin_path = detail::remove_from_bin_path(index.bin_path(), arguments.removed);
+
+    remove_user_bins(index.ibf(), arguments.removed);
+    if (arguments.compact)
+        compact(index.ibf(), bin_path);
+
+    raptor_index<index_structure::hibf> updated{window{index.window_size()},
+                                                index.shape(),
+                                                index.parts(),
+                                                false,
+                                                bin_path,
+                                                std::move(index.ibf())};
+    store_index(arguments.out_file, updated, arguments);
+}
+
+void raptor_remove(remove_arguments const & arguments)
+{
+    if (arguments.is_hibf)
+        remove_from_hibf(arguments);
+    else
+        remove_from_ibf(arguments);
+}
+
+} // namespace raptor
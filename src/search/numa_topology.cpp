@@ -0,0 +1,199 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <linux/mempolicy.h>
+#endif
+
+#include <raptor/search/numa_topology.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+// Parses lists like "0-3,8,10-11".
+std::vector<size_t> parse_cpu_list(std::string const & list)
+{
+    std::vector<size_t> result{};
+    char const * it = list.data();
+    char const * const end = list.data() + list.size();
+
+    while (it < end)
+    {
+        size_t first{};
+        auto [ptr, ec] = std::from_chars(it, end, first);
+        if (ec != std::errc{})
+            break;
+
+        size_t last{first};
+        if (ptr < end && *ptr == '-')
+            ptr = std::from_chars(ptr + 1, end, last).ptr;
+
+        for (size_t cpu = first; cpu <= last; ++cpu)
+            result.push_back(cpu);
+
+        it = ptr + 1; // skip ','
+    }
+
+    return result;
+}
+
+thread_local size_t current_numa_node{0u};
+
+#if defined(__linux__)
+// The kernel expects a bitmask of node IDs and the number of bits in the mask plus one.
+void set_memory_policy(int const mode, std::vector<size_t> const & nodes)
+{
+    if (nodes.empty())
+        return;
+
+    size_t const max_node = std::ranges::max(nodes);
+    std::vector<unsigned long> mask((max_node + 1 + 63) / 64, 0ULL);
+    for (size_t const node : nodes)
+        mask[node / 64] |= 1ULL << (node % 64);
+
+    // Failing to set a memory policy only affects performance. Ignore errors, e.g., when running in a container.
+    [[maybe_unused]] long const ret = syscall(SYS_set_mempolicy, mode, mask.data(), mask.size() * 64 + 1);
+}
+#endif
+
+} // namespace detail
+
+numa_topology const & numa_topology::system()
+{
+    static numa_topology const topology = [] ()
+    {
+        numa_topology result{};
+#if defined(__linux__)
+        std::filesystem::path const node_directory{"/sys/devices/system/node"};
+        std::error_code ec{};
+
+        std::vector<size_t> ids{};
+        for (auto const & entry : std::filesystem::directory_iterator{node_directory, ec})
+        {
+            std::string const name = entry.path().filename().string();
+            size_t id{};
+            if (name.starts_with("node") &&
+                std::from_chars(name.data() + 4, name.data() + name.size(), id).ec == std::errc{})
+            {
+                ids.push_back(id);
+            }
+        }
+        std::ranges::sort(ids);
+
+        for (size_t const id : ids)
+        {
+            std::ifstream cpu_list_file{node_directory / ("node" + std::to_string(id)) / "cpulist"};
+            std::string cpu_list{};
+            std::getline(cpu_list_file, cpu_list);
+            std::vector<size_t> cpus = detail::parse_cpu_list(cpu_list);
+
+            if (!cpus.empty()) // Memory-only nodes cannot run worker threads.
+            {
+                result.node_ids.push_back(id);
+                result.node_cpus.push_back(std::move(cpus));
+            }
+        }
+#endif
+        return result;
+    }();
+
+    return topology;
+}
+
+void numa_topology::pin_to_node(size_t const node) const
+{
+    detail::current_numa_node = node;
+#if defined(__linux__)
+    if (node >= node_cpus.size())
+        return;
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (size_t const cpu : node_cpus[node])
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &cpu_set);
+
+    // Pinning is an optimisation. If it is not permitted, the thread keeps running unpinned.
+    [[maybe_unused]] int const ret = sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#endif
+}
+
+void numa_topology::interleave_memory() const
+{
+#if defined(__linux__)
+    if (node_ids.size() > 1u)
+        detail::set_memory_policy(MPOL_INTERLEAVE, node_ids);
+#endif
+}
+
+void numa_topology::bind_memory([[maybe_unused]] size_t const node) const
+{
+#if defined(__linux__)
+    // MPOL_PREFERRED falls back to other nodes instead of invoking the OOM killer.
+    if (node_ids.size() > 1u && node < node_ids.size())
+        detail::set_memory_policy(MPOL_PREFERRED, {node_ids[node]});
+#endif
+}
+
+void numa_topology::reset_memory() const
+{
+#if defined(__linux__)
+    if (node_ids.size() > 1u)
+    {
+        [[maybe_unused]] long const ret = syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+    }
+#endif
+}
+
+uint64_t numa_topology::free_memory([[maybe_unused]] size_t const node) const
+{
+    uint64_t result{};
+#if defined(__linux__)
+    if (node >= node_ids.size())
+    {
+        result = static_cast<uint64_t>(sysconf(_SC_AVPHYS_PAGES)) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+    else
+    {
+        // Line format: "Node 0 MemFree:        12345678 kB"
+        std::ifstream meminfo{"/sys/devices/system/node/node" + std::to_string(node_ids[node]) + "/meminfo"};
+        std::string line{};
+        while (std::getline(meminfo, line))
+        {
+            if (size_t const pos = line.find("MemFree:"); pos != std::string::npos)
+            {
+                size_t const value_start = line.find_first_not_of(' ', pos + 8);
+                if (value_start != std::string::npos)
+                    std::from_chars(line.data() + value_start, line.data() + line.size(), result);
+                result *= 1024u;
+                break;
+            }
+        }
+    }
+#endif
+    return result;
+}
+
+size_t numa_topology::current_node() noexcept
+{
+    return detail::current_numa_node;
+}
+
+} // namespace raptor
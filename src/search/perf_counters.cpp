@@ -0,0 +1,144 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <linux/perf_event.h>
+#endif
+
+#include <raptor/search/perf_counters.hpp>
+
+namespace raptor
+{
+
+#if defined(__linux__)
+namespace detail
+{
+
+// The type and config of each event, in the order of perf_counters::event_names.
+static constexpr std::array<std::pair<uint32_t, uint64_t>, perf_counters::event_count> perf_events
+{{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+}};
+
+int open_perf_event(uint32_t const type, uint64_t const config, int const group_fd)
+{
+    perf_event_attr attributes{};
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = group_fd == -1; // The leader starts the whole group.
+    attributes.exclude_kernel = 1; // Allowed with perf_event_paranoid <= 2.
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP;
+
+    // Measure the calling thread (pid 0) on any CPU (-1).
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group_fd, 0));
+}
+
+} // namespace detail
+#endif
+
+perf_counters::perf_counters([[maybe_unused]] bool const enable)
+{
+#if defined(__linux__)
+    if (!enable)
+        return;
+
+    for (size_t event = 0; event < event_count; ++event)
+    {
+        auto const [type, config] = detail::perf_events[event];
+        int const fd = detail::open_perf_event(type, config, leader_fd);
+
+        if (fd == -1) // Not supported or not permitted.
+            continue;
+
+        if (leader_fd == -1)
+            leader_fd = fd;
+
+        fds.push_back(fd);
+        event_ids.push_back(event);
+    }
+
+    if (leader_fd != -1)
+    {
+        ioctl(leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+perf_counters::~perf_counters()
+{
+#if defined(__linux__)
+    for (int const fd : fds)
+        close(fd);
+#endif
+}
+
+bool perf_counters::read_counts([[maybe_unused]] std::array<uint64_t, event_count> & result) const
+{
+#if defined(__linux__)
+    // With PERF_FORMAT_GROUP, the layout is {number of events, value of event 0, value of event 1, ...}.
+    std::array<uint64_t, event_count + 1u> buffer{};
+    ssize_t const bytes = ::read(leader_fd, buffer.data(), sizeof(uint64_t) * (event_ids.size() + 1u));
+
+    if (bytes != static_cast<ssize_t>(sizeof(uint64_t) * (event_ids.size() + 1u)))
+        return false;
+
+    for (size_t i = 0; i < event_ids.size(); ++i)
+        result[event_ids[i]] = buffer[i + 1u];
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void perf_counters::enter(perf_scope const scope)
+{
+    leave();
+    current = static_cast<size_t>(scope);
+}
+
+void perf_counters::leave()
+{
+    if (!available())
+        return;
+
+    std::array<uint64_t, event_count> now{};
+    if (!read_counts(now))
+        return;
+
+    if (current < scope_count)
+        for (size_t event = 0; event < event_count; ++event)
+            totals[current][event] += now[event] - last[event];
+
+    last = now;
+    current = scope_count;
+}
+
+std::vector<std::pair<std::string, uint64_t>> perf_counters::values(perf_scope const scope) const
+{
+    std::vector<std::pair<std::string, uint64_t>> result{};
+
+    for (size_t const event : event_ids)
+        result.emplace_back(event_names[event], totals[static_cast<size_t>(scope)][event]);
+
+    return result;
+}
+
+} // namespace raptor
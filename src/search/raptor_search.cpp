@@ -8,6 +8,8 @@
 #include <raptor/search/search_hibf.hpp>
 #include <raptor/search/search_ibf.hpp>
 #include <raptor/search/search_multiple.hpp>
+#include <raptor/search/search_processes.hpp>
+#include <raptor/search/search_shards.hpp>
 #include <raptor/search/search_socks.hpp>
 
 namespace raptor
@@ -15,6 +17,10 @@ namespace raptor
 
 void raptor_search(search_arguments const & arguments)
 {
+    std::error_code ec{};
+    if (uint64_t const query_size = std::filesystem::file_size(arguments.query_file, ec); !ec)
+        arguments.metrics.bytes += query_size;
+
     if (arguments.is_hibf)
     {
         if (arguments.compressed)
@@ -22,6 +28,20 @@ void raptor_search(search_arguments const & arguments)
         else
             search_hibf<false>(arguments);
     }
+    else if (arguments.worker_processes)
+    {
+        if (arguments.compressed)
+            search_processes<true>(arguments);
+        else
+            search_processes<false>(arguments);
+    }
+    else if (arguments.shards > 1u)
+    {
+        if (arguments.compressed)
+            search_shards<true>(arguments);
+        else
+            search_shards<false>(arguments);
+    }
     else if (arguments.parts == 1)
     {
         if (arguments.is_socks)
@@ -47,6 +67,9 @@ void raptor_search(search_arguments const & arguments)
             search_multiple<false>(arguments);
     }
 
+    if (!arguments.metrics_file.empty())
+        arguments.metrics.write(arguments.metrics_file, "search");
+
     return;
 }
 
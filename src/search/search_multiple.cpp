@@ -8,9 +8,13 @@
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
+#include <raptor/counter_width.hpp>
 #include <raptor/dna4_traits.hpp>
+#include <raptor/huge_pages.hpp>
+#include <raptor/prefetching_counting_agent.hpp>
 #include <raptor/search/do_parallel.hpp>
 #include <raptor/search/load_index.hpp>
+#include <raptor/search/removed_user_bins.hpp>
 #include <raptor/search/search_multiple.hpp>
 #include <raptor/search/sync_out.hpp>
 #include <raptor/threshold/threshold.hpp>
@@ -60,7 +64,13 @@ void search_multiple(search_arguments const & arguments)
         synced_out << "#QUERY_NAME\tUSER_BINS\n";
     }
 
+    auto const threshold_start = std::chrono::high_resolution_clock::now();
     raptor::threshold::threshold const thresholder{arguments.make_threshold_parameters()};
+    auto const threshold_end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage("threshold",
+                                std::chrono::duration<double>(threshold_end - threshold_start).count());
+
+    std::vector<bool> const removed = raptor::removed_user_bins(arguments.bin_path);
 
     for (auto && chunked_records : fin | seqan3::views::chunk((1ULL<<20)*10))
     {
@@ -70,85 +80,100 @@ void search_multiple(search_arguments const & arguments)
         auto start = std::chrono::high_resolution_clock::now();
         std::ranges::move(chunked_records, std::back_inserter(records));
         auto end = std::chrono::high_resolution_clock::now();
-        reads_io_time += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        double const reads_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        reads_io_time += reads_elapsed;
+        arguments.metrics.add_stage("reads_io", reads_elapsed);
+        arguments.metrics.reads += records.size();
 
         cereal_handle.wait();
 
-        std::vector<seqan3::counting_vector<uint16_t>> counts(records.size(),
-                                                              seqan3::counting_vector<uint16_t>(index.ibf().bin_count(), 0));
-
-        auto count_task = [&](size_t const start, size_t const end)
+        // The counters are as narrow as the longest read of this chunk allows.
+        // Each minimiser is contained in exactly one part, hence the sum over all parts is bounded as well.
+        size_t const max_count = max_minimiser_count(records, arguments.shape_size);
+        dispatch_counter_width(max_count, [&] <typename value_t> (std::type_identity<value_t>)
         {
-            auto & ibf = index.ibf();
-            auto counter = ibf.template counting_agent<uint16_t>();
-            size_t counter_id = start;
+            std::vector<seqan3::counting_vector<value_t>> counts(records.size(),
+                                                                 seqan3::counting_vector<value_t>(index.ibf().bin_count(), 0));
 
-            auto hash_view = seqan3::views::minimiser_hash(arguments.shape,
-                                                           seqan3::window_size{arguments.window_size},
-                                                           seqan3::seed{adjust_seed(arguments.shape_weight)});
-
-            for (auto && [id, seq] : records | seqan3::views::slice(start, end))
+            auto count_task = [&](size_t const start, size_t const end)
             {
-                (void) id;
-                auto & result = counter.bulk_count(seq | hash_view);
-                counts[counter_id++] += result;
-            }
-        };
+                auto & ibf = index.ibf();
+                auto counter = make_counting_agent<value_t>(ibf, arguments.prefetch_distance);
+                size_t counter_id = start;
 
-        do_parallel(count_task, records.size(), arguments.threads, compute_time);
+                auto hash_view = seqan3::views::minimiser_hash(arguments.shape,
+                                                               seqan3::window_size{arguments.window_size},
+                                                               seqan3::seed{adjust_seed(arguments.shape_weight)});
 
-        for (size_t const part : std::views::iota(1u, static_cast<unsigned int>(arguments.parts - 1)))
-        {
-            load_index(index, arguments, part, index_io_time);
-            do_parallel(count_task, records.size(), arguments.threads, compute_time);
-        }
+                for (auto && [id, seq] : records | seqan3::views::slice(start, end))
+                {
+                    (void) id;
+                    auto & result = counter.bulk_count(seq | hash_view);
+                    counts[counter_id++] += result;
+                }
+            };
 
-        load_index(index, arguments, arguments.parts - 1, index_io_time);
+            do_parallel(count_task, records.size(), arguments, compute_time);
 
-        auto output_task = [&](size_t const start, size_t const end)
-        {
-            auto & ibf = index.ibf();
-            auto counter = ibf.template counting_agent<uint16_t>();
-            size_t counter_id = start;
-            std::string result_string{};
-            std::vector<uint64_t> minimiser;
+            for (size_t const part : std::views::iota(1u, static_cast<unsigned int>(arguments.parts - 1)))
+            {
+                load_index(index, arguments, part, index_io_time);
+                do_parallel(count_task, records.size(), arguments, compute_time);
+            }
 
-            auto hash_adaptor = seqan3::views::minimiser_hash(arguments.shape,
-                                                              seqan3::window_size{arguments.window_size},
-                                                              seqan3::seed{adjust_seed(arguments.shape_weight)});
+            load_index(index, arguments, arguments.parts - 1, index_io_time);
 
-            for (auto && [id, seq] : records | seqan3::views::slice(start, end))
+            auto output_task = [&](size_t const start, size_t const end)
             {
-                result_string.clear();
-                result_string += id;
-                result_string += '\t';
+                auto & ibf = index.ibf();
+                auto counter = make_counting_agent<value_t>(ibf, arguments.prefetch_distance);
+                size_t counter_id = start;
+                std::string result_string{};
+                std::vector<uint64_t> minimiser;
+                uint64_t total_minimiser_count{};
+
+                auto hash_adaptor = seqan3::views::minimiser_hash(arguments.shape,
+                                                                  seqan3::window_size{arguments.window_size},
+                                                                  seqan3::seed{adjust_seed(arguments.shape_weight)});
+
+                for (auto && [id, seq] : records | seqan3::views::slice(start, end))
+                {
+                    result_string.clear();
+                    result_string += id;
+                    result_string += '\t';
 
-                auto minimiser_view = seq | hash_adaptor | std::views::common;
-                minimiser.assign(minimiser_view.begin(), minimiser_view.end());
+                    auto minimiser_view = seq | hash_adaptor | std::views::common;
+                    minimiser.assign(minimiser_view.begin(), minimiser_view.end());
 
-                counts[counter_id] += counter.bulk_count(minimiser);
-                size_t const minimiser_count{minimiser.size()};
-                size_t current_bin{0};
+                    counts[counter_id] += counter.bulk_count(minimiser);
+                    size_t const minimiser_count{minimiser.size()};
+                    size_t current_bin{0};
+                    total_minimiser_count += minimiser_count;
 
-                size_t const threshold = thresholder.get(minimiser_count);
-                for (auto && count : counts[counter_id++])
-                {
-                    if (count >= threshold)
+                    size_t const threshold = thresholder.get(minimiser_count);
+                    for (auto && count : counts[counter_id++])
                     {
-                        result_string += std::to_string(current_bin);
-                        result_string += ',';
+                        if (count >= threshold && !removed[current_bin])
+                        {
+                            result_string += std::to_string(current_bin);
+                            result_string += ',';
+                        }
+                        ++current_bin;
                     }
-                    ++current_bin;
+                    if (auto & last_char = result_string.back(); last_char == ',')
+                        last_char = '\n';
+                    else
+                        result_string += '\n';
+                    synced_out.write(result_string);
                 }
-                if (auto & last_char = result_string.back(); last_char == ',')
-                    last_char = '\n';
-                else
-                    result_string += '\n';
-                synced_out.write(result_string);
-            }
-        };
 
-        do_parallel(output_task, records.size(), arguments.threads, compute_time);
+                // Each minimiser is looked up in exactly one part.
+                arguments.metrics.minimisers += total_minimiser_count;
+                arguments.metrics.lookups += total_minimiser_count;
+            };
+
+            do_parallel(output_task, records.size(), arguments, compute_time);
+        });
     }
 
 // GCOVR_EXCL_START
@@ -157,12 +182,14 @@ void search_multiple(search_arguments const & arguments)
         std::filesystem::path file_path{arguments.out_file};
         file_path += ".time";
         std::ofstream file_handle{file_path};
-        file_handle << "Index I/O\tReads I/O\tCompute\n";
+        file_handle << "Index I/O\tReads I/O\tCompute" << (arguments.huge_pages ? "\tHuge pages (MiB)\n" : "\n");
         file_handle << std::fixed
                     << std::setprecision(2)
                     << index_io_time << '\t'
                     << reads_io_time << '\t'
                     << compute_time;
+        if (arguments.huge_pages)
+            file_handle << '\t' << huge_page_bytes() / 1048576.0;
     }
 // GCOVR_EXCL_STOP
 }
@@ -0,0 +1,350 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <span>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <seqan3/search/views/minimiser_hash.hpp>
+
+#include <raptor/adjust_seed.hpp>
+#include <raptor/counter_width.hpp>
+#include <raptor/dna4_traits.hpp>
+#include <raptor/index_shards.hpp>
+#include <raptor/prefetching_counting_agent.hpp>
+#include <raptor/search/do_parallel.hpp>
+#include <raptor/search/load_index.hpp>
+#include <raptor/search/removed_user_bins.hpp>
+#include <raptor/search/search_processes.hpp>
+#include <raptor/search/sync_out.hpp>
+#include <raptor/search/worker_channel.hpp>
+#include <raptor/threshold/threshold.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+// The messages between the coordinator and the worker of a shard, see raptor::worker_channel:
+// 1. The worker loads its shard and sends {number of user bins}.
+// 2. The coordinator sends batches {number of reads, [threshold, number of minimisers, minimisers...] per read}.
+//    The worker answers each batch with {[number of hits, user bins of the shard...] per read}.
+// 3. The coordinator closes the connection, and the worker exits.
+template <bool compressed>
+void run_worker(search_arguments const & arguments, size_t const shard, worker_channel const & channel)
+{
+    using index_structure_t = std::conditional_t<compressed, index_structure::ibf_compressed, index_structure::ibf>;
+    auto index = raptor_index<index_structure_t>{};
+    double index_io_time{0.0};
+    double compute_time{0.0};
+
+    load_index(index, arguments, shard_path(arguments.index_file, shard), index_io_time);
+
+    if (!channel.send({index.bin_path().size()}))
+        return;
+
+    std::vector<uint64_t> batch{};
+    std::vector<size_t> read_begin{};
+    std::vector<std::vector<uint64_t>> hits{};
+    std::vector<uint64_t> response{};
+
+    while (channel.receive(batch))
+    {
+        size_t const number_of_reads{batch.at(0)};
+        size_t max_count{};
+        read_begin.resize(number_of_reads);
+        hits.resize(number_of_reads);
+
+        for (size_t read = 0, position = 1u; read < number_of_reads; ++read)
+        {
+            read_begin[read] = position;
+            max_count = std::max<size_t>(max_count, batch[position + 1u]);
+            position += 2u + batch[position + 1u];
+        }
+
+        // The counters are as narrow as the longest read of this batch allows.
+        dispatch_counter_width(max_count, [&] <typename value_t> (std::type_identity<value_t>)
+        {
+            auto count_task = [&] (size_t const start, size_t const end)
+            {
+                auto counter = make_counting_agent<value_t>(index.ibf(), arguments.prefetch_distance);
+
+                for (size_t read = start; read < end; ++read)
+                {
+                    uint64_t const * const data = batch.data() + read_begin[read];
+                    uint64_t const threshold{data[0]};
+                    std::span<uint64_t const> const minimiser{data + 2u, data[1]};
+
+                    hits[read].clear();
+                    size_t current_bin{0};
+                    for (auto && count : counter.bulk_count(minimiser))
+                    {
+                        if (count >= threshold)
+                            hits[read].push_back(current_bin);
+                        ++current_bin;
+                    }
+                }
+            };
+
+            do_parallel(count_task, number_of_reads, arguments, compute_time);
+        });
+
+        response.clear();
+        for (auto const & read_hits : hits)
+        {
+            response.push_back(read_hits.size());
+            response.insert(response.end(), read_hits.begin(), read_hits.end());
+        }
+
+        if (!channel.send(response))
+            return;
+    }
+}
+
+inline seqan3::argument_parser_error worker_error(size_t const shard)
+{
+    return seqan3::argument_parser_error{"The worker process of shard " + std::to_string(shard) + " exited "
+                                         "unexpectedly."};
+}
+
+} // namespace detail
+
+template <bool compressed>
+void search_processes(search_arguments const & arguments)
+{
+    // One worker process per shard. The workers are started before the coordinator starts any thread.
+    std::vector<worker_channel> channels{};
+    std::vector<pid_t> workers{};
+
+    for (size_t shard = 0; shard < arguments.shards; ++shard)
+    {
+        auto [coordinator_end, worker_end] = worker_channel::make_pair();
+        pid_t const pid = fork();
+
+// GCOVR_EXCL_START
+        if (pid < 0)
+            throw seqan3::argument_parser_error{"Cannot start a worker process: " + std::string{std::strerror(errno)}};
+// GCOVR_EXCL_STOP
+
+        if (pid == 0)
+        {
+            // The worker only keeps its own end of its own connection. Otherwise, it would keep other workers alive.
+            coordinator_end.close();
+            for (auto & channel : channels)
+                channel.close();
+
+            int exit_code{EXIT_SUCCESS};
+            try
+            {
+                detail::run_worker<compressed>(arguments, shard, worker_end);
+            }
+            catch (std::exception const & e)
+            {
+                std::cerr << "[Error] Worker of shard " << shard << ": " << e.what() << '\n';
+                exit_code = EXIT_FAILURE;
+            }
+            _exit(exit_code);
+        }
+
+        channels.push_back(std::move(coordinator_end));
+        workers.push_back(pid);
+    }
+
+    double index_io_time{0.0};
+    double reads_io_time{0.0};
+    double compute_time{0.0};
+
+    std::vector<uint64_t> batch{};
+    std::vector<std::vector<uint64_t>> responses(arguments.shards);
+
+    // The global number of the first user bin of each shard. The workers report their shard size when they are ready.
+    std::vector<size_t> first_bin(arguments.shards, 0u);
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t bins{};
+        for (size_t shard = 0; shard < arguments.shards; ++shard)
+        {
+            if (!channels[shard].receive(batch) || batch.size() != 1u)
+                throw detail::worker_error(shard);
+            first_bin[shard] = bins;
+            bins += batch[0];
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        index_io_time += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        arguments.metrics.add_stage("index_io", index_io_time);
+
+        if (bins != arguments.bin_path.size())
+            throw seqan3::argument_parser_error{"The shards changed during the search."};
+    }
+
+    seqan3::sequence_file_input<dna4_traits, seqan3::fields<seqan3::field::id, seqan3::field::seq>> fin{arguments.query_file};
+    using record_type = typename decltype(fin)::record_type;
+    std::vector<record_type> records{};
+
+    sync_out synced_out{arguments.out_file};
+
+    {
+        size_t position{};
+        std::string line{};
+        for (auto const & file_list : arguments.bin_path)
+        {
+            line.clear();
+            line = '#';
+            line += std::to_string(position);
+            line += '\t';
+            for (auto const & filename : file_list)
+            {
+                line += filename;
+                line += ',';
+            }
+            line.back() = '\n';
+            synced_out << line;
+            ++position;
+        }
+        synced_out << "#QUERY_NAME\tUSER_BINS\n";
+    }
+
+    auto const threshold_start = std::chrono::high_resolution_clock::now();
+    raptor::threshold::threshold const thresholder{arguments.make_threshold_parameters()};
+    auto const threshold_end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage("threshold",
+                                std::chrono::duration<double>(threshold_end - threshold_start).count());
+
+    std::vector<bool> const removed = raptor::removed_user_bins(arguments.bin_path);
+
+    std::vector<std::vector<uint64_t>> minimisers{};
+    std::vector<size_t> thresholds{};
+
+    auto hash_task = [&] (size_t const start, size_t const end)
+    {
+        auto hash_adaptor = seqan3::views::minimiser_hash(arguments.shape,
+                                                          seqan3::window_size{arguments.window_size},
+                                                          seqan3::seed{adjust_seed(arguments.shape_weight)});
+        uint64_t total_minimiser_count{};
+
+        for (size_t read = start; read < end; ++read)
+        {
+            auto minimiser_view = records[read].sequence() | hash_adaptor | std::views::common;
+            minimisers[read].assign(minimiser_view.begin(), minimiser_view.end());
+            thresholds[read] = thresholder.get(minimisers[read].size());
+            total_minimiser_count += minimisers[read].size();
+        }
+
+        // Each minimiser is looked up in every shard.
+        arguments.metrics.minimisers += total_minimiser_count;
+        arguments.metrics.lookups += total_minimiser_count * arguments.shards;
+    };
+
+    // The batches are smaller than in the other searches, since each batch is copied to all workers.
+    for (auto && chunked_records : fin | seqan3::views::chunk(1ULL<<16))
+    {
+        records.clear();
+        auto start = std::chrono::high_resolution_clock::now();
+        std::ranges::move(chunked_records, std::back_inserter(records));
+        auto end = std::chrono::high_resolution_clock::now();
+        double const reads_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        reads_io_time += reads_elapsed;
+        arguments.metrics.add_stage("reads_io", reads_elapsed);
+        arguments.metrics.reads += records.size();
+
+        // The minimisers are computed once and sent to all workers.
+        minimisers.resize(records.size());
+        thresholds.resize(records.size());
+        do_parallel(hash_task, records.size(), arguments, compute_time);
+
+        batch.clear();
+        batch.push_back(records.size());
+        for (size_t read = 0; read < records.size(); ++read)
+        {
+            batch.push_back(thresholds[read]);
+            batch.push_back(minimisers[read].size());
+            batch.insert(batch.end(), minimisers[read].begin(), minimisers[read].end());
+        }
+
+        // Scatter: The workers count while the batch is sent to the next worker.
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t shard = 0; shard < arguments.shards; ++shard)
+            if (!channels[shard].send(batch))
+                throw detail::worker_error(shard);
+
+        // Gather: The hits of each read are ordered by shard, hence by global user bin.
+        for (size_t shard = 0; shard < arguments.shards; ++shard)
+            if (!channels[shard].receive(responses[shard]))
+                throw detail::worker_error(shard);
+        end = std::chrono::high_resolution_clock::now();
+        double const workers_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        compute_time += workers_elapsed;
+        arguments.metrics.add_stage("workers", workers_elapsed);
+
+        std::vector<size_t> position(arguments.shards, 0u);
+        std::string result_string{};
+
+        for (auto & record : records)
+        {
+            result_string.clear();
+            result_string += record.id();
+            result_string += '\t';
+
+            for (size_t shard = 0; shard < arguments.shards; ++shard)
+            {
+                std::vector<uint64_t> const & response = responses[shard];
+                size_t const number_of_hits = response.at(position[shard]++);
+
+                for (size_t hit = 0; hit < number_of_hits; ++hit)
+                {
+                    size_t const user_bin = first_bin[shard] + response.at(position[shard]++);
+                    if (removed[user_bin])
+                        continue;
+
+                    result_string += std::to_string(user_bin);
+                    result_string += ',';
+                }
+            }
+
+            if (auto & last_char = result_string.back(); last_char == ',')
+                last_char = '\n';
+            else
+                result_string += '\n';
+            synced_out.write(result_string);
+        }
+    }
+
+    // Closing the connections stops the workers.
+    channels.clear();
+    for (size_t shard = 0; shard < arguments.shards; ++shard)
+    {
+        int status{};
+        if (waitpid(workers[shard], &status, 0) != workers[shard] || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS)
+            throw detail::worker_error(shard);
+    }
+
+// GCOVR_EXCL_START
+    if (arguments.write_time)
+    {
+        std::filesystem::path file_path{arguments.out_file};
+        file_path += ".time";
+        std::ofstream file_handle{file_path};
+        file_handle << "Index I/O\tReads I/O\tCompute\n";
+        file_handle << std::fixed
+                    << std::setprecision(2)
+                    << index_io_time << '\t'
+                    << reads_io_time << '\t'
+                    << compute_time;
+    }
+// GCOVR_EXCL_STOP
+}
+
+template
+void search_processes<false>(search_arguments const & arguments);
+
+template
+void search_processes<true>(search_arguments const & arguments);
+
+} // namespace raptor
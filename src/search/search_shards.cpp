@@ -0,0 +1,203 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <seqan3/search/views/minimiser_hash.hpp>
+
+#include <raptor/adjust_seed.hpp>
+#include <raptor/counter_width.hpp>
+#include <raptor/dna4_traits.hpp>
+#include <raptor/huge_pages.hpp>
+#include <raptor/index_shards.hpp>
+#include <raptor/prefetching_counting_agent.hpp>
+#include <raptor/search/do_parallel.hpp>
+#include <raptor/search/load_index.hpp>
+#include <raptor/search/removed_user_bins.hpp>
+#include <raptor/search/search_shards.hpp>
+#include <raptor/search/sync_out.hpp>
+#include <raptor/threshold/threshold.hpp>
+
+namespace raptor
+{
+
+template <bool compressed>
+void search_shards(search_arguments const & arguments)
+{
+    using index_structure_t = std::conditional_t<compressed, index_structure::ibf_compressed, index_structure::ibf>;
+    std::vector<raptor_index<index_structure_t>> shards(arguments.shards);
+
+    double index_io_time{0.0};
+    double reads_io_time{0.0};
+    double compute_time{0.0};
+
+    // The shards are loaded in parallel. The index I/O time is the one of the slowest shard.
+    auto cereal_worker = [&] ()
+    {
+        std::vector<double> shard_io_times(arguments.shards, 0.0);
+        std::vector<std::future<void>> shard_handles{};
+        for (size_t shard = 0; shard < arguments.shards; ++shard)
+            shard_handles.emplace_back(std::async(std::launch::async, [&, shard] ()
+            {
+                load_index(shards[shard], arguments, shard_path(arguments.index_file, shard), shard_io_times[shard]);
+            }));
+
+        for (auto && handle : shard_handles)
+            handle.get();
+        for (double const time : shard_io_times)
+            index_io_time = std::max(index_io_time, time);
+    };
+    auto cereal_handle = std::async(std::launch::async, cereal_worker);
+
+    seqan3::sequence_file_input<dna4_traits, seqan3::fields<seqan3::field::id, seqan3::field::seq>> fin{arguments.query_file};
+    using record_type = typename decltype(fin)::record_type;
+    std::vector<record_type> records{};
+
+    sync_out synced_out{arguments.out_file};
+
+    {
+        size_t position{};
+        std::string line{};
+        for (auto const & file_list : arguments.bin_path)
+        {
+            line.clear();
+            line = '#';
+            line += std::to_string(position);
+            line += '\t';
+            for (auto const & filename : file_list)
+            {
+                line += filename;
+                line += ',';
+            }
+            line.back() = '\n';
+            synced_out << line;
+            ++position;
+        }
+        synced_out << "#QUERY_NAME\tUSER_BINS\n";
+    }
+
+    auto const threshold_start = std::chrono::high_resolution_clock::now();
+    raptor::threshold::threshold const thresholder{arguments.make_threshold_parameters()};
+    auto const threshold_end = std::chrono::high_resolution_clock::now();
+    arguments.metrics.add_stage("threshold",
+                                std::chrono::duration<double>(threshold_end - threshold_start).count());
+
+    std::vector<bool> const removed = raptor::removed_user_bins(arguments.bin_path);
+
+    // The global number of the first user bin of each shard.
+    std::vector<size_t> first_bin(arguments.shards, 0u);
+
+    auto worker = [&] (size_t const start, size_t const end)
+    {
+        // The counters are as narrow as the longest read of this batch allows.
+        size_t const max_count = max_minimiser_count(records | seqan3::views::slice(start, end), arguments.shape_size);
+        dispatch_counter_width(max_count, [&] <typename value_t> (std::type_identity<value_t>)
+        {
+            using counter_t = decltype(make_counting_agent<value_t>(shards[0].ibf(), arguments.prefetch_distance));
+            std::vector<counter_t> counters{};
+            counters.reserve(arguments.shards);
+            for (auto const & shard : shards)
+                counters.push_back(make_counting_agent<value_t>(shard.ibf(), arguments.prefetch_distance));
+
+            std::string result_string{};
+            std::vector<uint64_t> minimiser;
+            uint64_t total_minimiser_count{};
+
+            auto hash_adaptor = seqan3::views::minimiser_hash(arguments.shape,
+                                                              seqan3::window_size{arguments.window_size},
+                                                              seqan3::seed{adjust_seed(arguments.shape_weight)});
+
+            for (auto && [id, seq] : records | seqan3::views::slice(start, end))
+            {
+                result_string.clear();
+                result_string += id;
+                result_string += '\t';
+
+                // The minimisers are computed once and looked up in each shard.
+                auto minimiser_view = seq | hash_adaptor | std::views::common;
+                minimiser.assign(minimiser_view.begin(), minimiser_view.end());
+
+                size_t const minimiser_count{minimiser.size()};
+                size_t const threshold = thresholder.get(minimiser_count);
+                total_minimiser_count += minimiser_count;
+
+                for (size_t shard = 0; shard < arguments.shards; ++shard)
+                {
+                    size_t current_bin{first_bin[shard]};
+                    for (auto && count : counters[shard].bulk_count(minimiser))
+                    {
+                        if (count >= threshold && !removed[current_bin])
+                        {
+                            result_string += std::to_string(current_bin);
+                            result_string += ',';
+                        }
+                        ++current_bin;
+                    }
+                }
+
+                if (auto & last_char = result_string.back(); last_char == ',')
+                    last_char = '\n';
+                else
+                    result_string += '\n';
+                synced_out.write(result_string);
+            }
+
+            // Each minimiser is looked up in every shard.
+            arguments.metrics.minimisers += total_minimiser_count;
+            arguments.metrics.lookups += total_minimiser_count * arguments.shards;
+        });
+    };
+
+    for (auto && chunked_records : fin | seqan3::views::chunk((1ULL<<20)*10))
+    {
+        records.clear();
+        auto start = std::chrono::high_resolution_clock::now();
+        std::ranges::move(chunked_records, std::back_inserter(records));
+        auto end = std::chrono::high_resolution_clock::now();
+        double const reads_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        reads_io_time += reads_elapsed;
+        arguments.metrics.add_stage("reads_io", reads_elapsed);
+        arguments.metrics.reads += records.size();
+
+        if (cereal_handle.valid())
+        {
+            cereal_handle.get();
+
+            for (size_t shard = 1; shard < arguments.shards; ++shard)
+                first_bin[shard] = first_bin[shard - 1u] + shards[shard - 1u].bin_path().size();
+
+            // The shards may have been rebuilt since the parameters were read.
+            if (first_bin.back() + shards.back().bin_path().size() != arguments.bin_path.size())
+                throw seqan3::argument_parser_error{"The shards changed during the search."};
+        }
+
+        do_parallel(worker, records.size(), arguments, compute_time);
+    }
+
+// GCOVR_EXCL_START
+    if (arguments.write_time)
+    {
+        std::filesystem::path file_path{arguments.out_file};
+        file_path += ".time";
+        std::ofstream file_handle{file_path};
+        file_handle << "Index I/O\tReads I/O\tCompute" << (arguments.huge_pages ? "\tHuge pages (MiB)\n" : "\n");
+        file_handle << std::fixed
+                    << std::setprecision(2)
+                    << index_io_time << '\t'
+                    << reads_io_time << '\t'
+                    << compute_time;
+        if (arguments.huge_pages)
+            file_handle << '\t' << huge_page_bytes() / 1048576.0;
+    }
+// GCOVR_EXCL_STOP
+}
+
+template
+void search_shards<false>(search_arguments const & arguments);
+
+template
+void search_shards<true>(search_arguments const & arguments);
+
+} // namespace raptor
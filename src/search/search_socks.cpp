@@ -9,6 +9,8 @@
 
 #include <raptor/adjust_seed.hpp>
 #include <raptor/dna4_traits.hpp>
+#include <raptor/huge_pages.hpp>
+#include <raptor/prefetching_counting_agent.hpp>
 #include <raptor/search/do_parallel.hpp>
 #include <raptor/search/load_index.hpp>
 #include <raptor/search/search_socks.hpp>
@@ -42,7 +44,7 @@ void search_socks(search_arguments const & arguments)
     auto worker = [&] (size_t const start, size_t const end)
     {
         auto & ibf = index.ibf();
-        auto counter = ibf.template counting_agent<uint8_t>();
+        auto counter = make_counting_agent<uint8_t>(ibf, arguments.prefetch_distance);
         std::string result_string{};
 
         auto hash_view = seqan3::views::minimiser_hash(arguments.shape,
@@ -81,11 +83,14 @@ void search_socks(search_arguments const & arguments)
             ++entries;
         }
         auto end = std::chrono::high_resolution_clock::now();
-        reads_io_time += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        double const reads_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        reads_io_time += reads_elapsed;
+        arguments.metrics.add_stage("reads_io", reads_elapsed);
+        arguments.metrics.reads += records.size();
 
         cereal_handle.wait();
 
-        do_parallel(worker, records.size(), arguments.threads, compute_time);
+        do_parallel(worker, records.size(), arguments, compute_time);
     }
 
 // GCOVR_EXCL_START
@@ -94,12 +99,14 @@ void search_socks(search_arguments const & arguments)
         std::filesystem::path file_path{arguments.out_file};
         file_path += ".time";
         std::ofstream file_handle{file_path};
-        file_handle << "Index I/O\tReads I/O\tCompute\n";
+        file_handle << "Index I/O\tReads I/O\tCompute" << (arguments.huge_pages ? "\tHuge pages (MiB)\n" : "\n");
         file_handle << std::fixed
                     << std::setprecision(2)
                     << index_io_time << '\t'
                     << reads_io_time << '\t'
                     << compute_time;
+        if (arguments.huge_pages)
+            file_handle << '\t' << huge_page_bytes() / 1048576.0;
     }
 // GCOVR_EXCL_STOP
 }
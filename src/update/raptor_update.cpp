@@ -0,0 +1,124 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <chrono>
+
+#include <raptor/build/build_from_files.hpp>
+#include <raptor/build/build_from_minimiser.hpp>
+#include <raptor/update/update.hpp>
+#include <raptor/update/update_hibf.hpp>
+
+namespace raptor
+{
+
+// Appends the new user bins to each part of an IBF.
+void update_ibf(update_arguments const & arguments, build_arguments const & build_args)
+{
+    std::vector<size_t> const part_lookup = part_of_suffix(arguments.parts);
+    size_t const mask{part_lookup.size() - 1u};
+
+    for (size_t part = 0; part < arguments.parts; ++part)
+    {
+        std::filesystem::path in_file{arguments.in_file};
+        std::filesystem::path out_file{arguments.out_file};
+        if (arguments.parts > 1u)
+        {
+            in_file += "_" + std::to_string(part);
+            out_file += "_" + std::to_string(part);
+        }
+
+        raptor_index<> index{};
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            std::ifstream is{in_file, std::ios::binary};
+            cereal::BinaryInputArchive iarchive{is};
+            iarchive(index);
+            auto end = std::chrono::high_resolution_clock::now();
+            build_args.metrics.add_stage("index_io", std::chrono::duration<double>(end - start).count());
+        }
+
+        // Spare technical bins are used first. Otherwise, the bit vector is resized and the existing bins are moved to
+        // their new position in a single pass.
+        size_t const first_bin{index.ibf().bin_count()};
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            index.ibf().increase_bin_number_to(seqan3::bin_count{first_bin + arguments.bin_path.size()});
+            auto end = std::chrono::high_resolution_clock::now();
+            build_args.metrics.add_stage("resize", std::chrono::duration<double>(end - start).count());
+        }
+
+        if (arguments.huge_pages)
+            advise_huge_pages(index.ibf());
+
+        if (arguments.is_minimiser)
+        {
+            insert_minimisers(build_args, index, first_bin);
+        }
+        else if (arguments.parts == 1u)
+        {
+            index_factory<false>{build_args}.append(index, first_bin);
+        }
+        else
+        {
+            auto filter_view = std::views::filter([&] (auto && hash)
+                { return part_lookup[hash & mask] == part; });
+            index_factory<false>{build_args}.append(index, first_bin, std::move(filter_view));
+        }
+
+        std::vector<std::vector<std::string>> bin_path{index.bin_path()};
+        bin_path.insert(bin_path.end(), arguments.bin_path.begin(), arguments.bin_path.end());
+
+        raptor_index<> updated{window{index.window_size()},
+                               index.shape(),
+                               index.parts(),
+                               false,
+                               bin_path,
+                               std::move(index.ibf())};
+        store_index(out_file, updated, build_args);
+    }
+}
+
+void raptor_update(update_arguments const & arguments)
+{
+    auto total_start = std::chrono::high_resolution_clock::now();
+
+    // The new bins are processed like in `raptor build`.
+    build_arguments build_args{};
+    build_args.window_size = arguments.window_size;
+    build_args.shape = arguments.shape;
+    build_args.parts = arguments.parts;
+    build_args.threads = arguments.threads;
+    build_args.huge_pages = arguments.huge_pages;
+    build_args.is_minimiser = arguments.is_minimiser;
+    build_args.is_hibf = arguments.is_hibf;
+    build_args.fpr = arguments.fpr;
+    build_args.bin_path = arguments.bin_path;
+    build_args.bins = arguments.bin_path.size();
+
+    for (auto const & file_list : arguments.bin_path)
+    {
+        for (auto const & file_name : file_list)
+        {
+            std::error_code ec{};
+            if (uint64_t const file_size = std::filesystem::file_size(file_name, ec); !ec)
+                build_args.metrics.bytes += file_size;
+        }
+    }
+
+    if (arguments.is_hibf)
+        hibf::update_hibf(arguments, build_args);
+    else
+        update_ibf(arguments, build_args);
+
+    auto total_end = std::chrono::high_resolution_clock::now();
+    build_args.metrics.add_stage("total", std::chrono::duration<double>(total_end - total_start).count());
+
+    if (!arguments.metrics_file.empty())
+        build_args.metrics.write(arguments.metrics_file, "update");
+}
+
+} // namespace raptor
@@ -0,0 +1,534 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+
+#include <raptor/build/atomic_insertion_agent.hpp>
+#include <raptor/build/bin_cost.hpp>
+#include <raptor/build/call_parallel_on_bins.hpp>
+#include <raptor/build/hibf/bin_size_in_bits.hpp>
+#include <raptor/build/hibf/compute_kmers.hpp>
+#include <raptor/build/store_index.hpp>
+#include <raptor/build/task_scheduler.hpp>
+#include <raptor/huge_pages.hpp>
+#include <raptor/index.hpp>
+#include <raptor/update/estimate_kmer_counts.hpp>
+#include <raptor/update/update_hibf.hpp>
+
+namespace raptor::hibf
+{
+
+namespace detail
+{
+
+using hibf_t = index_structure::hibf;
+using ibf_t = hibf_t::ibf_t;
+
+//!\brief The state of an IBF of the HIBF after the update.
+struct ibf_plan
+{
+    //!\brief The IBF containing the merged bin that this IBF belongs to. -1 for the root IBF.
+    int64_t parent_ibf{-1};
+    //!\brief The merged bin in `parent_ibf`.
+    size_t parent_bin{};
+    size_t bin_count{};
+    size_t bin_size{};
+    //!\brief Whether the IBF is added by the update.
+    bool is_new{false};
+    //!\brief Whether the IBF is rebuilt with larger bins.
+    bool rebuild{false};
+    //!\brief The estimated number of k-mers in each bin.
+    std::vector<double> kmer_counts{};
+
+    //!\brief Whether the IBF is constructed from scratch. Its size can then be chosen freely.
+    bool is_constructed() const noexcept
+    {
+        return is_new || rebuild;
+    }
+
+    //!\brief The number of technical bins that can be added without resizing the IBF.
+    size_t spare_bins() const noexcept
+    {
+        return (((bin_count + 63u) >> 6) << 6) - bin_count;
+    }
+};
+
+//!\brief The technical bins a new user bin is stored in.
+struct placement
+{
+    size_t ibf{};
+    size_t first_bin{};
+    size_t number_of_bins{};
+};
+
+//!\brief Existing user bins that are inserted into a rebuilt IBF.
+struct rebuild_job
+{
+    size_t ibf{};
+    std::vector<std::string> filenames{};
+    size_t first_bin{};
+    size_t number_of_bins{};
+};
+
+//!\brief Splits the name of a user bin of an HIBF into the names of its files, see raptor::hibf::update_user_bins.
+std::vector<std::string> split_filenames(std::string const & filenames)
+{
+    std::vector<std::string> result{};
+    size_t begin{};
+
+    for (size_t end = filenames.find(';'); end != std::string::npos; end = filenames.find(';', begin))
+    {
+        result.push_back(filenames.substr(begin, end - begin));
+        begin = end + 1u;
+    }
+    result.push_back(filenames.substr(begin));
+
+    return result;
+}
+
+//!\brief Returns the user bins stored in the IBF `ibf_idx` and all IBFs below it.
+std::vector<size_t> user_bins_of_subtree(hibf_t const & hibf, size_t const ibf_idx)
+{
+    std::vector<size_t> result{};
+    std::vector<size_t> stack{ibf_idx};
+
+    while (!stack.empty())
+    {
+        size_t const current = stack.back();
+        stack.pop_back();
+
+        for (size_t bin = 0; bin < hibf.next_ibf_id[current].size(); ++bin)
+        {
+            int64_t const user_bin = hibf.user_bins.filename_index(current, bin);
+
+            if (user_bin == -1) // merged bin
+                stack.push_back(hibf.next_ibf_id[current][bin]);
+            else if (user_bin >= 0 && // not removed
+                     (bin == 0u || user_bin != hibf.user_bins.filename_index(current, bin - 1u))) // not a split bin
+                result.push_back(user_bin);
+        }
+    }
+
+    return result;
+}
+
+//!\brief Inserts `kmers` into `number_of_bins` technical bins starting at `first_bin`, like insert_into_ibf().
+void insert_kmers(atomic_insertion_agent const & agent,
+                  std::vector<uint64_t> const & kmers,
+                  size_t const first_bin,
+                  size_t const number_of_bins)
+{
+    size_t const chunk_size = kmers.size() / number_of_bins + 1;
+
+    for (size_t i = 0; i < kmers.size(); ++i)
+        agent.emplace(kmers[i], seqan3::bin_index{first_bin + i / chunk_size});
+}
+
+//!\brief Decides where new user bins are stored, see raptor::hibf::update_hibf.
+class update_planner
+{
+public:
+    //!\brief The state of each IBF after placing all user bins so far.
+    std::vector<ibf_plan> plans{};
+
+    update_planner(hibf_t & hibf_, build_arguments const & arguments_, task_scheduler & scheduler) :
+        hibf{hibf_},
+        arguments{arguments_},
+        rebuild_costs(hibf.ibf_vector.size(), -1.0)
+    {
+        plans.resize(hibf.ibf_vector.size());
+
+        for (size_t ibf_idx = 0; ibf_idx < plans.size(); ++ibf_idx)
+        {
+            plans[ibf_idx].bin_count = hibf.ibf_vector[ibf_idx].bin_count();
+            plans[ibf_idx].bin_size = hibf.ibf_vector[ibf_idx].bin_size();
+
+            for (size_t bin = 0; bin < hibf.next_ibf_id[ibf_idx].size(); ++bin)
+            {
+                if (size_t const child = hibf.next_ibf_id[ibf_idx][bin]; child != ibf_idx)
+                {
+                    plans[child].parent_ibf = ibf_idx;
+                    plans[child].parent_bin = bin;
+                }
+            }
+        }
+
+        task_scheduler::task_group group{};
+        for (size_t ibf_idx = 0; ibf_idx < plans.size(); ++ibf_idx)
+        {
+            scheduler.run(group, [this, ibf_idx] ()
+            {
+                plans[ibf_idx].kmer_counts = estimate_kmer_counts(hibf.ibf_vector[ibf_idx]);
+            });
+        }
+        scheduler.wait(group);
+    }
+
+    //!\brief Places a user bin with `kmer_count` k-mers and updates the plans accordingly.
+    placement place(size_t const kmer_count)
+    {
+        size_t const kmer_bits{std::max<size_t>(1u, bin_size_in_bits(arguments, kmer_count))};
+
+        // The lowest category wins, then the lowest cost. See update_hibf() for the categories.
+        candidate best{.category = std::numeric_limits<size_t>::max()};
+        auto consider = [&best] (candidate const & other)
+        {
+            if (other < best)
+                best = other;
+        };
+
+        // Only the root IBF splits user bins, into at most as many technical bins as it has.
+        size_t const max_split{std::max<size_t>(64u, plans[0].bin_count)};
+        if (size_t const number_of_bins = bins_needed(kmer_count, plans[0].bin_size, max_split); number_of_bins > 0u)
+        {
+            size_t const category = number_of_bins <= plans[0].spare_bins() ? 0u : 4u;
+            consider({category, static_cast<double>(plans[0].bin_size), 0u, number_of_bins});
+        }
+
+        for (size_t ibf_idx = 1; ibf_idx < plans.size(); ++ibf_idx)
+        {
+            ibf_plan const & plan = plans[ibf_idx];
+
+            if (!ancestors_have_room(ibf_idx, kmer_count))
+                continue;
+
+            bool const fits{kmer_bits <= plan.bin_size};
+            double const bin_size{static_cast<double>(plan.bin_size)};
+
+            if (fits && (plan.spare_bins() > 0u || plan.is_constructed()))
+                consider({0u, bin_size, ibf_idx, 1u});
+            else if (fits || plan.is_constructed())
+                consider({1u, bin_size, ibf_idx, 1u});
+            else
+                consider({2u, rebuild_cost(ibf_idx), ibf_idx, 1u});
+        }
+
+        // A new lower-level IBF. Its merged bin in the root IBF only contains this user bin.
+        if (kmer_count <= max_number_of_kmers(arguments, plans[0].bin_size))
+            consider({3u, 0.0, plans.size(), 1u});
+
+        if (best.category == std::numeric_limits<size_t>::max())
+            throw std::runtime_error{"A user bin is too large to be added to the HIBF. Please rebuild the HIBF."};
+
+        if (best.category == 3u)
+        {
+            plans.push_back(ibf_plan{.parent_ibf = 0, .parent_bin = plans[0].bin_count, .is_new = true});
+            ++plans[0].bin_count;
+            plans[0].kmer_counts.push_back(0.0);
+        }
+        else if (best.category == 2u)
+        {
+            plans[best.ibf].rebuild = true;
+        }
+
+        ibf_plan & plan = plans[best.ibf];
+        if (plan.is_constructed())
+            plan.bin_size = std::max(plan.bin_size, kmer_bits);
+
+        placement const result{best.ibf, plan.bin_count, best.number_of_bins};
+        plan.bin_count += best.number_of_bins;
+        plan.kmer_counts.insert(plan.kmer_counts.end(),
+                                best.number_of_bins,
+                                static_cast<double>(kmer_count) / best.number_of_bins);
+
+        for (size_t child = best.ibf; plans[child].parent_ibf >= 0; child = plans[child].parent_ibf)
+            plans[plans[child].parent_ibf].kmer_counts[plans[child].parent_bin] += kmer_count;
+
+        return result;
+    }
+
+private:
+    //!\brief A possible placement of a user bin.
+    struct candidate
+    {
+        size_t category{};
+        double cost{};
+        size_t ibf{};
+        size_t number_of_bins{};
+
+        auto operator<=>(candidate const &) const = default;
+    };
+
+    hibf_t & hibf;
+    build_arguments const & arguments;
+    //!\brief The correction factors for splitting a user bin, see raptor::hibf::fp_correction_factors.
+    std::vector<double> fp_correction{};
+    //!\brief The estimated cost of reading all user bins below an IBF. Negative if not computed yet.
+    std::vector<double> rebuild_costs{};
+
+    //!\brief Whether the merged bins above the IBF `ibf_idx` can store `kmer_count` more k-mers.
+    bool ancestors_have_room(size_t const ibf_idx, size_t const kmer_count) const
+    {
+        for (size_t child = ibf_idx; plans[child].parent_ibf >= 0; child = plans[child].parent_ibf)
+        {
+            ibf_plan const & parent = plans[plans[child].parent_ibf];
+            double const capacity = max_number_of_kmers(arguments, parent.bin_size);
+
+            if (parent.kmer_counts[plans[child].parent_bin] + kmer_count > capacity)
+                return false;
+        }
+
+        return true;
+    }
+
+    /*!\brief The number of technical bins needed to store `kmer_count` k-mers in bins of `bin_size` bits.
+     * \details
+     * Returns 0 if more than `max_bins` bins would be needed. Since a query matches a split user bin if it matches any
+     * of its technical bins, splitting into more bins does not always help.
+     */
+    size_t bins_needed(size_t const kmer_count, size_t const bin_size, size_t const max_bins)
+    {
+        if (max_bins >= fp_correction.size())
+            fp_correction = fp_correction_factors(max_bins, arguments.hash, arguments.fpr);
+
+        size_t const capacity{std::max<size_t>(1u, max_number_of_kmers(arguments, bin_size))};
+
+        for (size_t number_of_bins = std::max<size_t>(1u, (kmer_count + capacity - 1u) / capacity);
+             number_of_bins <= max_bins;
+             ++number_of_bins)
+        {
+            size_t const kmers_per_bin = (kmer_count + number_of_bins - 1u) / number_of_bins;
+
+            if (bin_size_in_bits(arguments, kmers_per_bin) * fp_correction[number_of_bins] <= bin_size)
+                return number_of_bins;
+        }
+
+        return 0u;
+    }
+
+    //!\brief The amount of input of all user bins below the IBF `ibf_idx`, see raptor::estimate_bin_cost.
+    double rebuild_cost(size_t const ibf_idx)
+    {
+        if (rebuild_costs[ibf_idx] < 0.0)
+        {
+            rebuild_costs[ibf_idx] = 0.0;
+            for (size_t const user_bin : user_bins_of_subtree(hibf, ibf_idx))
+                rebuild_costs[ibf_idx] += estimate_bin_cost(split_filenames(hibf.user_bins.filename_of_user_bin(user_bin)));
+        }
+
+        return rebuild_costs[ibf_idx];
+    }
+};
+
+} // namespace detail
+
+void update_hibf(update_arguments const & arguments, build_arguments & build_args)
+{
+    raptor_index<index_structure::hibf> index{};
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::ifstream is{arguments.in_file, std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        iarchive(index);
+        auto end = std::chrono::high_resolution_clock::now();
+        build_args.metrics.add_stage("index_io", std::chrono::duration<double>(end - start).count());
+    }
+
+    auto & hibf = index.ibf();
+    build_args.hash = hibf.ibf_vector[0].hash_function_count();
+
+    size_t const old_user_bin_count{hibf.user_bins.num_user_bins()};
+    size_t const new_user_bin_count{arguments.bin_path.size()};
+
+    // ==========================================
+    // Compute the k-mers of the new user bins.
+    // ==========================================
+    std::vector<std::vector<uint64_t>> kmers(new_user_bin_count);
+    call_parallel_on_bins([&] (auto && zipped_view, auto &&)
+        {
+            for (auto && [file_names, bin_number] : zipped_view)
+            {
+                chopper_pack_record const record{.filenames = file_names, .bin_indices = {0u}, .number_of_bins = {1u}};
+                compute_kmers(kmers[bin_number], build_args, record);
+            }
+        },
+        build_args,
+        "new_user_bins");
+
+    // ==========================================
+    // Place the new user bins, largest first.
+    // ==========================================
+    task_scheduler scheduler{build_args.threads};
+    std::vector<size_t> order(new_user_bin_count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, [&kmers] (size_t const lhs, size_t const rhs)
+    {
+        return kmers[lhs].size() > kmers[rhs].size();
+    });
+
+    auto start = std::chrono::high_resolution_clock::now();
+    detail::update_planner planner{hibf, build_args, scheduler};
+    std::vector<detail::placement> placements(new_user_bin_count);
+    for (size_t const user_bin : order)
+        placements[user_bin] = planner.place(kmers[user_bin].size());
+    std::vector<detail::ibf_plan> const & plans = planner.plans;
+    auto end = std::chrono::high_resolution_clock::now();
+    build_args.metrics.add_stage("plan", std::chrono::duration<double>(end - start).count());
+
+    // ==========================================
+    // Collect the content of the rebuilt IBFs.
+    // ==========================================
+    std::vector<detail::rebuild_job> rebuild_jobs{};
+    for (size_t ibf_idx = 0; ibf_idx < hibf.ibf_vector.size(); ++ibf_idx)
+    {
+        if (!plans[ibf_idx].rebuild)
+            continue;
+
+        auto const & next_ibf_ids = hibf.next_ibf_id[ibf_idx];
+        for (size_t bin = 0; bin < next_ibf_ids.size();)
+        {
+            int64_t const user_bin = hibf.user_bins.filename_index(ibf_idx, bin);
+
+            if (user_bin == -2) // removed bin: stays empty
+            {
+                ++bin;
+            }
+            else if (user_bin == -1) // merged bin: all user bins below
+            {
+                for (size_t const child_user_bin : detail::user_bins_of_subtree(hibf, next_ibf_ids[bin]))
+                {
+                    auto filenames = detail::split_filenames(hibf.user_bins.filename_of_user_bin(child_user_bin));
+                    rebuild_jobs.push_back({ibf_idx, std::move(filenames), bin, 1u});
+                }
+                ++bin;
+            }
+            else // single or split bin
+            {
+                size_t number_of_bins{1u};
+                while (bin + number_of_bins < next_ibf_ids.size() &&
+                       hibf.user_bins.filename_index(ibf_idx, bin + number_of_bins) == user_bin)
+                    ++number_of_bins;
+
+                auto filenames = detail::split_filenames(hibf.user_bins.filename_of_user_bin(user_bin));
+                rebuild_jobs.push_back({ibf_idx, std::move(filenames), bin, number_of_bins});
+                bin += number_of_bins;
+            }
+        }
+    }
+
+    // ==========================================
+    // Resize, rebuild, and add IBFs.
+    // ==========================================
+    start = std::chrono::high_resolution_clock::now();
+    hibf.ibf_vector.resize(plans.size());
+    for (size_t ibf_idx = 0; ibf_idx < plans.size(); ++ibf_idx)
+    {
+        auto const & plan = plans[ibf_idx];
+        auto & ibf = hibf.ibf_vector[ibf_idx];
+
+        if (plan.is_constructed())
+        {
+            ibf = detail::ibf_t{seqan3::bin_count{plan.bin_count},
+                                seqan3::bin_size{plan.bin_size},
+                                seqan3::hash_function_count{build_args.hash}};
+        }
+        else if (plan.bin_count > ibf.bin_count())
+        {
+            ibf.increase_bin_number_to(seqan3::bin_count{plan.bin_count});
+        }
+        else
+        {
+            continue;
+        }
+
+        if (arguments.huge_pages)
+            advise_huge_pages(ibf);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    build_args.metrics.add_stage("resize", std::chrono::duration<double>(end - start).count());
+
+    // ==========================================
+    // Insert the k-mers.
+    // ==========================================
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<atomic_insertion_agent> agents{};
+    agents.reserve(hibf.ibf_vector.size());
+    for (auto & ibf : hibf.ibf_vector)
+        agents.emplace_back(ibf);
+
+    task_scheduler::task_group group{};
+
+    for (size_t const user_bin : order)
+    {
+        scheduler.run(group, [&, user_bin] ()
+        {
+            detail::placement const & place = placements[user_bin];
+            detail::insert_kmers(agents[place.ibf], kmers[user_bin], place.first_bin, place.number_of_bins);
+
+            // Merged bins contain the k-mers of all user bins below them.
+            for (size_t child = place.ibf; plans[child].parent_ibf >= 0; child = plans[child].parent_ibf)
+                detail::insert_kmers(agents[plans[child].parent_ibf], kmers[user_bin], plans[child].parent_bin, 1u);
+
+            kmers[user_bin] = std::vector<uint64_t>{};
+        });
+    }
+
+    for (auto const & job : rebuild_jobs)
+    {
+        scheduler.run(group, [&] ()
+        {
+            std::vector<uint64_t> job_kmers{};
+            chopper_pack_record const record{.filenames = job.filenames,
+                                             .bin_indices = {job.first_bin},
+                                             .number_of_bins = {job.number_of_bins}};
+            compute_kmers(job_kmers, build_args, record);
+            detail::insert_kmers(agents[job.ibf], job_kmers, job.first_bin, job.number_of_bins);
+        });
+    }
+
+    scheduler.wait(group);
+    end = std::chrono::high_resolution_clock::now();
+    build_args.metrics.add_stage("insert", std::chrono::duration<double>(end - start).count());
+
+    // ==========================================
+    // Bookkeeping.
+    // ==========================================
+    hibf.next_ibf_id.resize(plans.size());
+    hibf.user_bins.set_ibf_count(plans.size());
+    hibf.user_bins.set_user_bin_count(old_user_bin_count + new_user_bin_count);
+
+    for (size_t ibf_idx = 0; ibf_idx < plans.size(); ++ibf_idx)
+    {
+        hibf.next_ibf_id[ibf_idx].resize(plans[ibf_idx].bin_count, ibf_idx);
+        hibf.user_bins.bin_indices_of_ibf(ibf_idx).resize(plans[ibf_idx].bin_count, -1);
+
+        if (plans[ibf_idx].is_new)
+            hibf.next_ibf_id[plans[ibf_idx].parent_ibf][plans[ibf_idx].parent_bin] = ibf_idx;
+    }
+
+    std::vector<std::vector<std::string>> bin_path{index.bin_path()};
+    for (size_t user_bin = 0; user_bin < new_user_bin_count; ++user_bin)
+    {
+        size_t const user_bin_idx{old_user_bin_count + user_bin};
+        detail::placement const & place = placements[user_bin];
+        std::fill_n(hibf.user_bins.bin_indices_of_ibf(place.ibf).begin() + place.first_bin,
+                    place.number_of_bins,
+                    user_bin_idx);
+
+        std::string & filenames = hibf.user_bins.filename_of_user_bin(user_bin_idx);
+        for (auto const & filename : arguments.bin_path[user_bin])
+        {
+            filenames += filename;
+            filenames += ';';
+        }
+        filenames.pop_back();
+        bin_path.push_back(std::vector<std::string>{filenames});
+    }
+
+    raptor_index<index_structure::hibf> updated{window{index.window_size()},
+                                                index.shape(),
+                                                index.parts(),
+                                                false,
+                                                bin_path,
+                                                std::move(hibf)};
+    store_index(arguments.out_file, updated, build_args);
+}
+
+} // namespace raptor::hibf
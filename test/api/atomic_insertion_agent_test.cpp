@@ -0,0 +1,72 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <thread>
+
+#include <raptor/build/atomic_insertion_agent.hpp>
+
+using ibf_t = seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed>;
+
+// The agent replicates the hashing of the seqan3 IBF. Any change there must be detected.
+TEST(atomic_insertion_agent, same_as_seqan3)
+{
+    std::mt19937_64 rng{42u};
+
+    for (size_t const bins : {1u, 63u, 64u, 65u, 200u})
+    {
+        for (size_t const hash : {1u, 2u, 3u, 4u, 5u})
+        {
+            ibf_t expected{seqan3::bin_count{bins}, seqan3::bin_size{1024u}, seqan3::hash_function_count{hash}};
+            ibf_t ibf{seqan3::bin_count{bins}, seqan3::bin_size{1024u}, seqan3::hash_function_count{hash}};
+            raptor::atomic_insertion_agent const agent{ibf};
+
+            for (size_t i = 0; i < 5000u; ++i)
+            {
+                uint64_t const value = rng() % 2000u;
+                seqan3::bin_index const bin{rng() % bins};
+                expected.emplace(value, bin);
+                agent.emplace(value, bin);
+            }
+
+            EXPECT_TRUE(ibf.raw_data() == expected.raw_data()) << "bins: " << bins << " hash: " << hash;
+        }
+    }
+}
+
+// Threads insert into interleaved bins, i.e. all threads write to the same words.
+TEST(atomic_insertion_agent, concurrent)
+{
+    size_t const threads{4u};
+    size_t const bins{130u};
+
+    ibf_t expected{seqan3::bin_count{bins}, seqan3::bin_size{1024u}, seqan3::hash_function_count{2u}};
+    ibf_t ibf{seqan3::bin_count{bins}, seqan3::bin_size{1024u}, seqan3::hash_function_count{2u}};
+
+    for (size_t bin = 0; bin < bins; ++bin)
+        for (uint64_t value = 0; value < 500u; ++value)
+            expected.emplace(value * bins + bin, seqan3::bin_index{bin});
+
+    std::vector<std::thread> workers{};
+    for (size_t thread = 0; thread < threads; ++thread)
+    {
+        workers.emplace_back([&ibf, thread] ()
+        {
+            raptor::atomic_insertion_agent const agent{ibf};
+            for (size_t bin = thread; bin < bins; bin += threads)
+                for (uint64_t value = 0; value < 500u; ++value)
+                    agent.emplace(value * bins + bin, seqan3::bin_index{bin});
+        });
+    }
+
+    for (auto & worker : workers)
+        worker.join();
+
+    EXPECT_TRUE(ibf.raw_data() == expected.raw_data());
+}
@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <raptor/build/bin_cost.hpp>
+
+struct bin_cost : public ::testing::Test
+{
+    std::filesystem::path const directory{std::filesystem::temp_directory_path() / "raptor_bin_cost_test"};
+
+    void SetUp() override
+    {
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    std::string write(std::string const & name, std::string const & content) const
+    {
+        std::filesystem::path const path = directory / name;
+        std::ofstream{path} << content;
+        return path.string();
+    }
+};
+
+TEST_F(bin_cost, file_size)
+{
+    std::string const small = write("small.fasta", ">1\nACGT\n");
+    std::string const large = write("large.fasta", ">1\n" + std::string(100u, 'A') + '\n');
+
+    EXPECT_EQ(raptor::estimate_bin_cost({small}), 8u);
+    EXPECT_EQ(raptor::estimate_bin_cost({small, large}), 8u + 104u);
+    EXPECT_EQ(raptor::estimate_bin_cost({(directory / "missing.fasta").string()}), 0u);
+}
+
+TEST_F(bin_cost, header)
+{
+    // The header's minimiser count is used instead of the size of the compressed .minimiser file.
+    std::string const with_header = write("with_header.minimiser", "0123456789");
+    write("with_header.header", "1111111111111111111\t19\t1\t5000\n");
+    EXPECT_EQ(raptor::estimate_bin_cost({with_header}), 5000u);
+
+    std::string const without_header = write("without_header.minimiser", "0123456789");
+    EXPECT_EQ(raptor::estimate_bin_cost({without_header}), 10u);
+
+    std::string const broken_header = write("broken_header.minimiser", "0123456789");
+    write("broken_header.header", "1111\n");
+    EXPECT_EQ(raptor::estimate_bin_cost({broken_header}), 10u);
+}
+
+TEST_F(bin_cost, largest_first)
+{
+    std::string const a = write("a.fasta", std::string(10u, 'A'));
+    std::string const b = write("b.fasta", std::string(30u, 'A'));
+    std::string const c = write("c.fasta", std::string(20u, 'A'));
+    std::string const d = write("d.fasta", std::string(30u, 'A'));
+
+    // Bins 1 and 3 have the same cost and keep their order.
+    EXPECT_EQ(raptor::largest_first({{a}, {b}, {c}, {d}, {a, c}}), (std::vector<size_t>{1u, 3u, 4u, 2u, 0u}));
+    EXPECT_TRUE(raptor::largest_first({}).empty());
+}
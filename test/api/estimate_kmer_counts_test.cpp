@@ -0,0 +1,53 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <raptor/update/estimate_kmer_counts.hpp>
+
+using ibf_t = seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed>;
+
+TEST(estimate_kmer_counts, empty)
+{
+    ibf_t const ibf{seqan3::bin_count{70u}, seqan3::bin_size{1024u}, seqan3::hash_function_count{2u}};
+    std::vector<double> const counts = raptor::estimate_kmer_counts(ibf);
+
+    ASSERT_EQ(counts.size(), 70u);
+    for (double const count : counts)
+        EXPECT_EQ(count, 0.0);
+}
+
+TEST(estimate_kmer_counts, estimate)
+{
+    ibf_t ibf{seqan3::bin_count{130u}, seqan3::bin_size{8192u}, seqan3::hash_function_count{2u}};
+
+    // Bin 129 is in the third word of each row.
+    for (size_t const bin : {0u, 63u, 64u, 129u})
+        for (uint64_t value = 0; value < 1000u * (bin + 1u); value += bin + 1u)
+            ibf.emplace(value * 0x9E3779B97F4A7C15ULL, seqan3::bin_index{bin});
+
+    std::vector<double> const counts = raptor::estimate_kmer_counts(ibf);
+
+    ASSERT_EQ(counts.size(), 130u);
+    for (size_t bin = 0; bin < counts.size(); ++bin)
+    {
+        if (bin == 0u || bin == 63u || bin == 64u || bin == 129u)
+            EXPECT_NEAR(counts[bin], 1000.0, 50.0) << "bin: " << bin;
+        else
+            EXPECT_EQ(counts[bin], 0.0) << "bin: " << bin;
+    }
+}
+
+TEST(estimate_kmer_counts, full)
+{
+    ibf_t ibf{seqan3::bin_count{1u}, seqan3::bin_size{64u}, seqan3::hash_function_count{2u}};
+
+    for (uint64_t value = 0; value < 10000u; ++value)
+        ibf.emplace(value, seqan3::bin_index{0u});
+
+    EXPECT_EQ(raptor::estimate_kmer_counts(ibf)[0], std::numeric_limits<double>::infinity());
+}
@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include <raptor/build/hibf/kmer_union.hpp>
+
+TEST(kmer_union, sort_and_deduplicate)
+{
+    std::vector<uint64_t> kmers{5u, 3u, 5u, 1u, 3u, 9u};
+    raptor::hibf::sort_and_deduplicate(kmers);
+    EXPECT_EQ(kmers, (std::vector<uint64_t>{1u, 3u, 5u, 9u}));
+
+    std::vector<uint64_t> empty{};
+    raptor::hibf::sort_and_deduplicate(empty);
+    EXPECT_TRUE(empty.empty());
+}
+
+// Returns all k-mers of a merged kmer_union.
+static std::vector<uint64_t> collect(raptor::hibf::kmer_union const & kmer_union)
+{
+    std::vector<uint64_t> result{};
+    kmer_union.for_each_block([&result] (std::vector<uint64_t> const & block)
+    {
+        result.insert(result.end(), block.begin(), block.end());
+    });
+    return result;
+}
+
+// Adds `number_of_sets` overlapping sets of k-mers to `kmer_union` and returns their union.
+static std::vector<uint64_t> fill(raptor::hibf::kmer_union & kmer_union, size_t const number_of_sets)
+{
+    std::mt19937_64 rng{42u};
+    std::set<uint64_t> expected{};
+
+    for (size_t i = 0; i < number_of_sets; ++i)
+    {
+        // Distinct, but unsorted k-mers. Different sets overlap.
+        std::set<uint64_t> distinct{};
+        for (size_t j = 0; j < 1000u; ++j)
+            distinct.insert(rng() % 10'000u);
+        std::vector<uint64_t> kmers(distinct.begin(), distinct.end());
+        std::shuffle(kmers.begin(), kmers.end(), rng);
+
+        expected.insert(kmers.begin(), kmers.end());
+        kmer_union.add(std::move(kmers));
+    }
+    kmer_union.add(std::vector<uint64_t>{});
+
+    return {expected.begin(), expected.end()};
+}
+
+TEST(kmer_union, merge)
+{
+    for (size_t const number_of_sets : {0u, 1u, 2u, 17u})
+    {
+        raptor::hibf::kmer_union kmer_union{};
+        std::vector<uint64_t> const expected = fill(kmer_union, number_of_sets);
+
+        kmer_union.merge();
+        EXPECT_EQ(kmer_union.size(), expected.size()) << "number_of_sets: " << number_of_sets;
+        EXPECT_EQ(collect(kmer_union), expected) << "number_of_sets: " << number_of_sets;
+
+        kmer_union.clear();
+        EXPECT_EQ(kmer_union.size(), 0u);
+        EXPECT_TRUE(collect(kmer_union).empty());
+    }
+}
+
+// With a memory limit of 10'000 bytes, some sets and the merged result are written to temporary files.
+TEST(kmer_union, memory_limit)
+{
+    std::filesystem::path const temp_directory = std::filesystem::temp_directory_path() / "raptor_kmer_union_test";
+    std::filesystem::create_directories(temp_directory);
+
+    for (size_t const number_of_sets : {0u, 1u, 2u, 17u})
+    {
+        {
+            raptor::hibf::kmer_storage storage{10'000u, temp_directory};
+            raptor::hibf::kmer_union kmer_union{storage};
+            std::vector<uint64_t> const expected = fill(kmer_union, number_of_sets);
+
+            kmer_union.merge();
+            EXPECT_EQ(kmer_union.size(), expected.size()) << "number_of_sets: " << number_of_sets;
+            EXPECT_EQ(collect(kmer_union), expected) << "number_of_sets: " << number_of_sets;
+
+            // The merged k-mers are moved to the parent.
+            raptor::hibf::kmer_union parent{storage};
+            parent.add(std::vector<uint64_t>{1u, 20'000u});
+            parent.add(kmer_union);
+            parent.merge();
+
+            std::vector<uint64_t> expected_parent{expected};
+            expected_parent.insert(expected_parent.begin(), 1u);
+            expected_parent.push_back(20'000u);
+            raptor::hibf::sort_and_deduplicate(expected_parent);
+
+            EXPECT_EQ(collect(parent), expected_parent) << "number_of_sets: " << number_of_sets;
+            EXPECT_EQ(kmer_union.size(), 0u);
+        }
+
+        // Temporary files are removed.
+        EXPECT_TRUE(std::filesystem::is_empty(temp_directory)) << "number_of_sets: " << number_of_sets;
+    }
+
+    std::filesystem::remove_all(temp_directory);
+}
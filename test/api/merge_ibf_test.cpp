@@ -0,0 +1,54 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include <raptor/merge/merge_ibf.hpp>
+
+using ibf_t = raptor::index_structure::ibf;
+
+// Bin `b` contains the values [100 * (first_value + b), 100 * (first_value + b) + 100).
+static ibf_t make_ibf(size_t const bins, size_t const first_value)
+{
+    ibf_t ibf{seqan3::bin_count{bins}, seqan3::bin_size{1000u}, seqan3::hash_function_count{2u}};
+
+    for (size_t bin = 0; bin < bins; ++bin)
+        for (uint64_t value = 100u * (first_value + bin); value < 100u * (first_value + bin) + 100u; ++value)
+            ibf.emplace(value, seqan3::bin_index{bin});
+
+    return ibf;
+}
+
+// The merged IBF is the same as one that was built from all bins.
+TEST(merge_ibf, merge_into)
+{
+    for (std::vector<size_t> const & bins : std::vector<std::vector<size_t>>{{3u, 5u},
+                                                                             {64u, 1u},
+                                                                             {1u, 64u},
+                                                                             {65u, 63u, 2u},
+                                                                             {10u, 130u, 10u}})
+    {
+        size_t const total = std::accumulate(bins.begin(), bins.end(), size_t{});
+        ibf_t const expected = make_ibf(total, 0u);
+
+        for (size_t const threads : {1u, 3u})
+        {
+            ibf_t merged{seqan3::bin_count{total}, seqan3::bin_size{1000u}, seqan3::hash_function_count{2u}};
+            size_t first_bin{};
+
+            for (size_t const count : bins)
+            {
+                raptor::merge_into(merged, make_ibf(count, first_bin), first_bin, threads);
+                first_bin += count;
+            }
+
+            EXPECT_TRUE(merged == expected) << "bins: " << total << " threads: " << threads;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+
+#include <raptor/build/minimiser_counter.hpp>
+
+// Adds 20'000 minimisers to `counter`. Some minimisers occur more often than raptor::minimiser_counter::max_count.
+static void fill(raptor::minimiser_counter & counter)
+{
+    std::mt19937_64 engine{42u};
+    std::uniform_int_distribution<uint64_t> distribution{0u, 3000u};
+
+    for (size_t i = 0; i < 20'000u; ++i)
+        counter.add(i % 10u == 0u ? 7u : distribution(engine) * 0x9E3779B97F4A7C15ULL);
+}
+
+static std::map<uint64_t, uint8_t> collect(raptor::minimiser_counter & counter)
+{
+    std::map<uint64_t, uint8_t> result{};
+    counter.for_each([&result] (uint64_t const hash, uint8_t const count)
+    {
+        EXPECT_TRUE(result.emplace(hash, count).second);
+    });
+    return result;
+}
+
+static size_t number_of_files(std::filesystem::path const & directory)
+{
+    return std::distance(std::filesystem::directory_iterator{directory}, std::filesystem::directory_iterator{});
+}
+
+// Small limits produce many runs, which are merged in several passes. The counts are the same as without a limit.
+TEST(minimiser_counter, spill)
+{
+    std::filesystem::path const directory{"minimiser_counter_spill"};
+    std::filesystem::create_directory(directory);
+
+    raptor::minimiser_counter unlimited{};
+    fill(unlimited);
+    std::map<uint64_t, uint8_t> const expected = collect(unlimited);
+    EXPECT_EQ(expected.at(7u), raptor::minimiser_counter::max_count);
+
+    // 256 bytes: 32 minimisers per run, the runs are merged two at a time.
+    // 4 KiB: 512 minimisers per run, 40 runs are merged seven at a time.
+    // 64 KiB: 8192 minimisers per run, all runs are merged at once.
+    for (uint64_t const memory_limit : {256u, 4096u, 65536u})
+    {
+        raptor::minimiser_counter counter{memory_limit, directory};
+        fill(counter);
+        EXPECT_GT(number_of_files(directory), 1u) << "memory_limit: " << memory_limit;
+
+        std::map<uint64_t, uint8_t> const result = collect(counter);
+        EXPECT_EQ(result, expected) << "memory_limit: " << memory_limit;
+        EXPECT_EQ(number_of_files(directory), 0u) << "memory_limit: " << memory_limit;
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+// Without spilling, the minimisers are sorted in memory.
+TEST(minimiser_counter, no_spill)
+{
+    std::filesystem::path const directory{"minimiser_counter_no_spill"};
+    std::filesystem::create_directory(directory);
+
+    raptor::minimiser_counter counter{1ULL << 20, directory};
+    for (uint64_t const hash : {5u, 3u, 5u, 1u})
+        counter.add(hash);
+    EXPECT_EQ(number_of_files(directory), 0u);
+
+    EXPECT_EQ(collect(counter), (std::map<uint64_t, uint8_t>{{1u, 1u}, {3u, 1u}, {5u, 2u}}));
+
+    std::filesystem::remove_all(directory);
+}
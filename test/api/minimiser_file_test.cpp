@@ -0,0 +1,184 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include <raptor/build/minimiser_file.hpp>
+
+struct minimiser_file : public ::testing::Test
+{
+    std::filesystem::path const directory{std::filesystem::temp_directory_path() / "raptor_minimiser_file_test"};
+    std::filesystem::path const path{directory / "test.minimiser"};
+
+    void SetUp() override
+    {
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    std::vector<uint64_t> read_all() const
+    {
+        std::vector<uint64_t> result{};
+        raptor::for_each_minimiser(path, [&result] (uint64_t const value)
+        {
+            result.push_back(value);
+        });
+        return result;
+    }
+};
+
+TEST_F(minimiser_file, round_trip)
+{
+    std::mt19937_64 rng{42u};
+
+    for (size_t const size : {0u, 1u, 1000u, 100'000u})
+    {
+        for (uint32_t const block_size : {1u, 7u, raptor::minimiser_file::default_block_size})
+        {
+            // Hashes of 19-mers use at most 38 bits. Also test the full range.
+            for (uint64_t const mask : {(1ULL << 38) - 1u, ~0ULL})
+            {
+                std::vector<uint64_t> values(size);
+                for (auto & value : values)
+                    value = rng() & mask;
+                if (size > 0u)
+                    values[0] = mask; // Largest possible value.
+                std::ranges::sort(values);
+
+                {
+                    raptor::minimiser_file_writer writer{path, block_size};
+                    for (uint64_t const value : values)
+                        writer.push_back(value);
+                }
+
+                values.erase(std::unique(values.begin(), values.end()), values.end());
+                EXPECT_EQ(raptor::minimiser_file_reader{path}.size(), values.size());
+                EXPECT_EQ(read_all(), values) << "size: " << size << " block_size: " << block_size;
+            }
+        }
+    }
+}
+
+TEST_F(minimiser_file, duplicates)
+{
+    {
+        raptor::minimiser_file_writer writer{path, 2u};
+        for (uint64_t const value : {0u, 0u, 3u, 3u, 3u, 5u})
+            writer.push_back(value);
+        EXPECT_EQ(writer.size(), 3u);
+    }
+    EXPECT_EQ(read_all(), (std::vector<uint64_t>{0u, 3u, 5u}));
+}
+
+TEST_F(minimiser_file, compression)
+{
+    std::mt19937_64 rng{42u};
+
+    // One million distinct 19-mer hashes.
+    std::vector<uint64_t> values(1'000'000u);
+    for (auto & value : values)
+        value = rng() & ((1ULL << 38) - 1u);
+    std::ranges::sort(values);
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+    {
+        raptor::minimiser_file_writer writer{path};
+        for (uint64_t const value : values)
+            writer.push_back(value);
+    }
+
+    // At least 2.5 times smaller than 8 bytes per value.
+    EXPECT_LT(std::filesystem::file_size(path) * 5u, values.size() * sizeof(uint64_t) * 2u);
+}
+
+// Files written by older versions of raptor contain the raw values.
+TEST_F(minimiser_file, legacy)
+{
+    std::vector<uint64_t> const values{42u, 7u, ~0ULL, 0u, 1000u};
+
+    {
+        std::ofstream out{path, std::ios::binary};
+        out.write(reinterpret_cast<char const *>(values.data()), values.size() * sizeof(uint64_t));
+    }
+
+    EXPECT_EQ(raptor::minimiser_file_reader{path}.size(), values.size());
+    EXPECT_EQ(read_all(), values);
+
+    {
+        std::ofstream out{path, std::ios::binary};
+    }
+    EXPECT_TRUE(read_all().empty());
+}
+
+TEST_F(minimiser_file, corrupted)
+{
+    {
+        raptor::minimiser_file_writer writer{path};
+        for (uint64_t value = 0u; value < 1000u; ++value)
+            writer.push_back(value * 1000u);
+    }
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1u);
+    EXPECT_THROW(read_all(), std::runtime_error);
+}
+
+TEST_F(minimiser_file, block_reader)
+{
+    std::vector<std::filesystem::path> paths{};
+    std::vector<uint64_t> expected{};
+
+    for (size_t file = 0; file < 5u; ++file)
+    {
+        paths.push_back(directory / (std::to_string(file) + ".minimiser"));
+        raptor::minimiser_file_writer writer{paths.back(), 100u};
+        for (uint64_t value = 0u; value < file * 1000u; ++value)
+        {
+            writer.push_back(value * 3u);
+            expected.push_back(value * 3u);
+        }
+    }
+
+    for (size_t const capacity : {1u, 4u, 100u})
+    {
+        std::vector<uint64_t> result{};
+        std::vector<uint64_t> block{};
+        raptor::minimiser_block_reader reader{paths, capacity};
+        while (reader.next(block))
+            result.insert(result.end(), block.begin(), block.end());
+        EXPECT_EQ(result, expected) << "capacity: " << capacity;
+        EXPECT_FALSE(reader.next(block));
+    }
+
+    { // Stop reading early.
+        raptor::minimiser_block_reader reader{paths, 1u};
+        std::vector<uint64_t> block{};
+        EXPECT_TRUE(reader.next(block));
+    }
+
+    { // No files.
+        std::vector<uint64_t> block{};
+        EXPECT_FALSE(raptor::minimiser_block_reader{std::vector<std::string>{}}.next(block));
+    }
+
+    { // Missing files are reported after the blocks of the previous files.
+        paths.push_back(directory / "missing.minimiser");
+        size_t count{};
+        EXPECT_THROW(raptor::for_each_minimiser_block(paths, [&count] (std::vector<uint64_t> const & block)
+                     {
+                         count += block.size();
+                     }),
+                     std::runtime_error);
+        EXPECT_EQ(count, expected.size());
+    }
+}
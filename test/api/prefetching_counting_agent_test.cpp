@@ -0,0 +1,56 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <raptor/prefetching_counting_agent.hpp>
+
+using ibf_t = seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed>;
+
+// The prefetching agent replicates the hashing of the seqan3 IBF. Any change there must be detected.
+TEST(prefetching_counting_agent, same_as_seqan3)
+{
+    std::mt19937_64 rng{42u};
+
+    for (size_t const bins : {1u, 63u, 64u, 65u, 200u})
+    {
+        for (size_t const hash : {1u, 2u, 3u, 4u, 5u})
+        {
+            ibf_t ibf{seqan3::bin_count{bins}, seqan3::bin_size{1024u}, seqan3::hash_function_count{hash}};
+
+            for (size_t i = 0; i < 5000u; ++i)
+                ibf.emplace(rng() % 2000u, seqan3::bin_index{rng() % bins});
+
+            std::vector<uint64_t> values(300u);
+            for (auto & value : values)
+                value = rng() % 4000u;
+
+            auto expected_agent = ibf.template counting_agent<uint16_t>();
+            auto & expected = expected_agent.bulk_count(values);
+
+            for (size_t const distance : {size_t{0u}, size_t{1u}, size_t{7u}, size_t{1000u}, raptor::auto_prefetch_distance})
+            {
+                raptor::prefetching_counting_agent<uint16_t> agent{ibf, distance};
+                EXPECT_EQ(agent.bulk_count(values), expected) << "bins: " << bins << " hash: " << hash
+                                                              << " distance: " << distance;
+                // A second call must reset the counters.
+                EXPECT_EQ(agent.bulk_count(values), expected);
+            }
+        }
+    }
+}
+
+TEST(prefetching_counting_agent, empty_query)
+{
+    ibf_t ibf{seqan3::bin_count{64u}, seqan3::bin_size{1024u}, seqan3::hash_function_count{2u}};
+    ibf.emplace(1u, seqan3::bin_index{3u});
+
+    raptor::prefetching_counting_agent<uint16_t> agent{ibf, 4u};
+    EXPECT_EQ(agent.bulk_count(std::vector<uint64_t>{}), (seqan3::counting_vector<uint16_t>(64u, 0u)));
+}
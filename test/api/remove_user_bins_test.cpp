@@ -0,0 +1,156 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include <raptor/remove/remove_user_bins.hpp>
+
+using ibf_t = raptor::index_structure::ibf;
+using hibf_t = raptor::index_structure::hibf;
+
+// Bin `b` contains the values [100 * values_of_bin[b], 100 * values_of_bin[b] + 100).
+static ibf_t make_ibf(size_t const bins, std::vector<size_t> const & values_of_bin)
+{
+    ibf_t ibf{seqan3::bin_count{bins}, seqan3::bin_size{1024u}, seqan3::hash_function_count{2u}};
+
+    for (size_t bin = 0; bin < values_of_bin.size(); ++bin)
+        for (uint64_t value = 100u * values_of_bin[bin]; value < 100u * values_of_bin[bin] + 100u; ++value)
+            ibf.emplace(value, seqan3::bin_index{bin});
+
+    return ibf;
+}
+
+// The compacted IBF is the same as one that was built from the kept bins only.
+TEST(remove_user_bins, compact_ibf)
+{
+    for (size_t const bins : {3u, 64u, 65u, 130u})
+    {
+        std::vector<size_t> all_bins(bins);
+        std::iota(all_bins.begin(), all_bins.end(), 0u);
+
+        std::vector<size_t> kept_bins{};
+        for (size_t bin = 0; bin < bins; ++bin)
+            if (bin % 3u != 1u)
+                kept_bins.push_back(bin);
+
+        ibf_t const ibf = make_ibf(bins, all_bins);
+        ibf_t const expected = make_ibf(kept_bins.size(), kept_bins);
+
+        EXPECT_TRUE(raptor::compact_ibf(ibf, kept_bins).raw_data() == expected.raw_data()) << "bins: " << bins;
+    }
+}
+
+TEST(remove_user_bins, ibf)
+{
+    ibf_t ibf = make_ibf(4u, {0u, 1u, 2u, 3u});
+    raptor::remove_user_bins(ibf, {false, true, false, true});
+
+    ibf_t expected = make_ibf(4u, {});
+    for (size_t const bin : {0u, 2u})
+        for (uint64_t value = 100u * bin; value < 100u * bin + 100u; ++value)
+            expected.emplace(value, seqan3::bin_index{bin});
+
+    EXPECT_TRUE(ibf.raw_data() == expected.raw_data());
+}
+
+struct remove_user_bins_hibf : public ::testing::Test
+{
+    // IBF 0: user bin 0, user bin 1 (split), merged bin (IBF 1), merged bin (IBF 2)
+    // IBF 1: user bins 2 and 3
+    // IBF 2: user bin 4, merged bin (IBF 3)
+    // IBF 3: user bin 5
+    // All bins contain the values [0, 100).
+    hibf_t hibf{};
+    std::vector<std::vector<std::string>> bin_path{};
+    std::vector<uint64_t> values{};
+
+    void SetUp() override
+    {
+        values.resize(100u);
+        std::iota(values.begin(), values.end(), 0u);
+
+        std::vector<size_t> const bin_counts{5u, 2u, 2u, 1u};
+        hibf.next_ibf_id = {{0, 0, 0, 1, 2}, {1, 1}, {2, 3}, {3}};
+        hibf.user_bins.set_ibf_count(4u);
+        hibf.user_bins.set_user_bin_count(6u);
+        hibf.user_bins.bin_indices_of_ibf(0) = {0, 1, 1, -1, -1};
+        hibf.user_bins.bin_indices_of_ibf(1) = {2, 3};
+        hibf.user_bins.bin_indices_of_ibf(2) = {4, -1};
+        hibf.user_bins.bin_indices_of_ibf(3) = {5};
+
+        for (size_t const bins : bin_counts)
+            hibf.ibf_vector.push_back(make_ibf(bins, std::vector<size_t>(bins, 0u)));
+
+        for (size_t user_bin = 0; user_bin < 6u; ++user_bin)
+        {
+            hibf.user_bins.filename_of_user_bin(user_bin) = "bin" + std::to_string(user_bin) + ".fa";
+            bin_path.push_back({hibf.user_bins.filename_of_user_bin(user_bin)});
+        }
+    }
+
+    void remove(std::vector<bool> const & removed)
+    {
+        raptor::remove_user_bins(hibf, removed);
+        for (size_t user_bin = 0; user_bin < removed.size(); ++user_bin)
+            if (removed[user_bin])
+                bin_path[user_bin].clear();
+    }
+};
+
+TEST_F(remove_user_bins_hibf, remove)
+{
+    remove({false, true, false, false, true, true});
+
+    EXPECT_EQ(hibf.user_bins.bin_indices_of_ibf(0), (std::vector<int64_t>{0, -2, -2, -1, -1}));
+    EXPECT_EQ(hibf.user_bins.bin_indices_of_ibf(2), (std::vector<int64_t>{-2, -1}));
+    EXPECT_EQ(hibf.user_bins.bin_indices_of_ibf(3), (std::vector<int64_t>{-2}));
+    EXPECT_TRUE(hibf.ibf_vector[3].raw_data() == make_ibf(1u, {}).raw_data());
+
+    // Even a threshold of 0 does not report removed user bins.
+    auto agent = hibf.membership_agent();
+    EXPECT_EQ(agent.bulk_contains(values, 0u), (std::vector<int64_t>{0, 2, 3}));
+    EXPECT_EQ(agent.bulk_contains(values, 100u), (std::vector<int64_t>{0, 2, 3}));
+}
+
+TEST_F(remove_user_bins_hibf, compact)
+{
+    remove({false, true, false, false, true, true});
+    raptor::compact(hibf, bin_path);
+
+    // IBFs 2 and 3 are dropped.
+    ASSERT_EQ(hibf.ibf_vector.size(), 2u);
+    EXPECT_EQ(hibf.ibf_vector[0].bin_count(), 2u);
+    EXPECT_EQ(hibf.ibf_vector[1].bin_count(), 2u);
+    EXPECT_EQ(hibf.next_ibf_id, (std::vector<std::vector<int64_t>>{{0, 1}, {1, 1}}));
+    EXPECT_EQ(hibf.user_bins.bin_indices_of_ibf(0), (std::vector<int64_t>{0, -1}));
+    EXPECT_EQ(hibf.user_bins.bin_indices_of_ibf(1), (std::vector<int64_t>{1, 2}));
+    EXPECT_EQ(hibf.user_bins.num_user_bins(), 3u);
+    EXPECT_EQ(hibf.user_bins.filename_of_user_bin(1), "bin2.fa");
+    EXPECT_EQ(bin_path, (std::vector<std::vector<std::string>>{{"bin0.fa"}, {"bin2.fa"}, {"bin3.fa"}}));
+
+    auto agent = hibf.membership_agent();
+    EXPECT_EQ(agent.bulk_contains(values, 100u), (std::vector<int64_t>{0, 1, 2}));
+}
+
+TEST_F(remove_user_bins_hibf, compact_nothing)
+{
+    hibf_t const expected{hibf};
+    raptor::compact(hibf, bin_path);
+
+    EXPECT_EQ(hibf.next_ibf_id, expected.next_ibf_id);
+    EXPECT_EQ(hibf.user_bins.num_user_bins(), 6u);
+    for (size_t ibf_idx = 0; ibf_idx < 4u; ++ibf_idx)
+        EXPECT_TRUE(hibf.ibf_vector[ibf_idx].raw_data() == expected.ibf_vector[ibf_idx].raw_data());
+}
+
+TEST_F(remove_user_bins_hibf, compact_all)
+{
+    remove(std::vector<bool>(6u, true));
+    EXPECT_THROW(raptor::compact(hibf, bin_path), std::runtime_error);
+}
@@ -0,0 +1,104 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <raptor/build/sequence_file_chunks.hpp>
+
+struct sequence_file_chunks : public ::testing::Test
+{
+    std::filesystem::path const directory{std::filesystem::temp_directory_path() / "raptor_sequence_file_chunks_test"};
+
+    void SetUp() override
+    {
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    std::string write(std::string const & name, std::string const & content) const
+    {
+        std::filesystem::path const path = directory / name;
+        std::ofstream{path, std::ios::binary} << content;
+        return path.string();
+    }
+
+    // The chunks must cover the file, and each chunk must start with a record.
+    static void check(std::vector<raptor::sequence_file_chunk> const & chunks,
+                      std::string const & content,
+                      char const record_start)
+    {
+        std::string concatenated{};
+        for (auto const & chunk : chunks)
+        {
+            std::string const chunk_content = raptor::read_chunk(chunk);
+            ASSERT_FALSE(chunk_content.empty());
+            EXPECT_EQ(chunk_content[0], record_start);
+            concatenated += chunk_content;
+        }
+        EXPECT_EQ(concatenated, content);
+    }
+};
+
+TEST_F(sequence_file_chunks, fasta)
+{
+    std::string content{};
+    for (size_t i = 0; i < 100u; ++i)
+        content += ">seq" + std::to_string(i) + '\n' + std::string(i % 7u + 1u, 'A') + '\n' + "CGT\n";
+    std::string const file_name = write("file.fasta", content);
+
+    for (uint64_t const chunk_size : {1u, 10u, 64u, 1000u})
+    {
+        auto const chunks = raptor::split_sequence_file(file_name, chunk_size);
+        EXPECT_GT(chunks.size(), 1u);
+        EXPECT_EQ(chunks[0].format, raptor::chunk_format::fasta);
+        check(chunks, content, '>');
+    }
+}
+
+TEST_F(sequence_file_chunks, fastq)
+{
+    // Quality lines starting with '@' and '+' must not be mistaken for headers.
+    std::string content{};
+    for (size_t i = 0; i < 100u; ++i)
+        content += "@seq" + std::to_string(i) + "\nACGT\n+\n" + (i % 2u ? "@+II" : "+@II") + '\n';
+    std::string const file_name = write("file.fastq", content);
+
+    for (uint64_t const chunk_size : {1u, 10u, 64u, 1000u})
+    {
+        auto const chunks = raptor::split_sequence_file(file_name, chunk_size);
+        EXPECT_GT(chunks.size(), 1u);
+        EXPECT_EQ(chunks[0].format, raptor::chunk_format::fastq);
+        check(chunks, content, '@');
+
+        for (auto const & chunk : chunks)
+            EXPECT_EQ(raptor::read_chunk(chunk).substr(0, 4), "@seq");
+    }
+}
+
+TEST_F(sequence_file_chunks, not_split)
+{
+    std::string const fasta = write("small.fasta", ">seq\nACGT\n");
+    std::string const compressed = write("file.fa.gz", std::string{"\x1f\x8b\x08\x00", 4} + std::string(100u, 'A'));
+    std::string const multi_line_fastq = write("multi_line.fastq", "@seq\nAC\nGT\n+\nII\nII\n@seq\nACGT\n+\nIIII\n");
+
+    for (auto const & file_name : {fasta, compressed, multi_line_fastq})
+    {
+        auto const chunks = raptor::split_sequence_file(file_name, file_name == fasta ? 1000u : 4u);
+        ASSERT_EQ(chunks.size(), 1u) << file_name;
+        EXPECT_EQ(chunks[0].format, raptor::chunk_format::whole_file);
+        EXPECT_EQ(chunks[0].size(), std::filesystem::file_size(file_name));
+    }
+
+    // A missing file results in a single empty chunk; opening it later reports the error.
+    auto const chunks = raptor::split_sequence_file((directory / "missing.fasta").string(), 4u);
+    ASSERT_EQ(chunks.size(), 1u);
+    EXPECT_EQ(chunks[0].size(), 0u);
+}
@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include <raptor/build/task_scheduler.hpp>
+
+// Builds a tree of the given depth and fan-out, each node waiting for its children, and returns the number of nodes.
+static size_t tree(raptor::task_scheduler & scheduler, size_t const depth, size_t const fan_out)
+{
+    if (depth == 0u)
+        return 1u;
+
+    std::atomic<size_t> nodes{1u};
+    raptor::task_scheduler::task_group group{};
+    for (size_t i = 0; i < fan_out; ++i)
+        scheduler.run(group, [&] () { nodes += tree(scheduler, depth - 1u, fan_out); });
+    scheduler.wait(group);
+
+    return nodes;
+}
+
+TEST(task_scheduler, nested)
+{
+    for (size_t const threads : {1u, 2u, 8u})
+    {
+        raptor::task_scheduler scheduler{threads};
+        // 1 + 4 + 16 + 64 + 256 nodes
+        EXPECT_EQ(tree(scheduler, 4u, 4u), 341u) << "threads: " << threads;
+        // The scheduler can be reused.
+        EXPECT_EQ(tree(scheduler, 2u, 3u), 13u) << "threads: " << threads;
+    }
+}
+
+TEST(task_scheduler, exception)
+{
+    raptor::task_scheduler scheduler{4u};
+    std::atomic<size_t> finished{};
+
+    raptor::task_scheduler::task_group group{};
+    for (size_t i = 0; i < 100u; ++i)
+    {
+        scheduler.run(group, [&finished, i] ()
+        {
+            if (i == 42u)
+                throw std::runtime_error{"42"};
+            ++finished;
+        });
+    }
+
+    EXPECT_THROW(scheduler.wait(group), std::runtime_error);
+    // All other tasks are still executed.
+    EXPECT_EQ(finished, 99u);
+    // The exception is only thrown once.
+    EXPECT_NO_THROW(scheduler.wait(group));
+}
+
+TEST(task_scheduler, empty_group)
+{
+    raptor::task_scheduler scheduler{2u};
+    raptor::task_scheduler::task_group group{};
+    EXPECT_NO_THROW(scheduler.wait(group));
+}
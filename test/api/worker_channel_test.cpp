@@ -0,0 +1,58 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <numeric>
+
+#include <raptor/search/worker_channel.hpp>
+
+TEST(worker_channel, round_trip)
+{
+    auto [coordinator, worker] = raptor::worker_channel::make_pair();
+    std::vector<uint64_t> message{};
+
+    EXPECT_TRUE(coordinator.send({1u, 2u, 3u}));
+    EXPECT_TRUE(coordinator.send({}));
+    EXPECT_TRUE(worker.send({42u}));
+
+    EXPECT_TRUE(worker.receive(message));
+    EXPECT_EQ(message, (std::vector<uint64_t>{1u, 2u, 3u}));
+    EXPECT_TRUE(worker.receive(message));
+    EXPECT_EQ(message, (std::vector<uint64_t>{}));
+    EXPECT_TRUE(coordinator.receive(message));
+    EXPECT_EQ(message, (std::vector<uint64_t>{42u}));
+}
+
+// A message may be larger than the buffer of the socket.
+TEST(worker_channel, large_message)
+{
+    auto [coordinator, worker] = raptor::worker_channel::make_pair();
+    std::vector<uint64_t> expected(1u << 22);
+    std::iota(expected.begin(), expected.end(), 0u);
+
+    auto sender = std::async(std::launch::async, [&coordinator = coordinator, &expected] ()
+    {
+        return coordinator.send(expected);
+    });
+
+    std::vector<uint64_t> message{};
+    EXPECT_TRUE(worker.receive(message));
+    EXPECT_TRUE(sender.get());
+    EXPECT_EQ(message, expected);
+}
+
+TEST(worker_channel, closed)
+{
+    auto [coordinator, worker] = raptor::worker_channel::make_pair();
+    std::vector<uint64_t> message{};
+
+    worker.close();
+    EXPECT_FALSE(coordinator.receive(message));
+    EXPECT_FALSE(coordinator.send({1u, 2u, 3u}));
+}
@@ -0,0 +1,191 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <benchmark/benchmark.h>
+
+#include <sys/resource.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include <seqan3/alphabet/nucleotide/dna4.hpp>
+#include <seqan3/io/sequence_file/output.hpp>
+#include <seqan3/test/performance/sequence_generator.hpp>
+
+#include <raptor/build/build_from_minimiser.hpp>
+#include <raptor/build/compute_minimiser.hpp>
+#include <raptor/build/hibf/chopper_build.hpp>
+#include <raptor/build/index_factory.hpp>
+#include <raptor/metrics.hpp>
+
+// Benchmarks the construction paths of `raptor build` on generated bins:
+// * index_factory: Building an IBF from sequence files.
+// * compute_minimiser: Writing .minimiser files (`--compute-minimiser`).
+// * build_from_minimiser: Building an IBF from .minimiser files.
+// * chopper_build: Building an HIBF from a layout with `merged_bins` merged bins containing all user bins.
+// Each benchmark is run for several thread counts and reports the inserted minimisers per second, the peak RSS of the
+// process so far (run benchmarks separately via --benchmark_filter for exact values), and the utilisation,
+// i.e. the CPU time divided by (wall time * threads).
+
+#if 1
+static constexpr size_t const bin_count{256};
+static constexpr size_t const bin_size{1ULL<<16};
+#else
+static constexpr size_t const bin_count{1024};
+static constexpr size_t const bin_size{1ULL<<22};
+#endif
+
+static constexpr size_t const merged_bins{16};
+static constexpr uint8_t const kmer_size{20};
+static constexpr uint32_t const window_size{24};
+static std::filesystem::path const base_path{std::filesystem::temp_directory_path() / "raptor_build_benchmark"};
+
+// Writes the bins and the HIBF layout once.
+static void prepare_data()
+{
+    static bool const prepared = [] ()
+    {
+        std::filesystem::create_directories(base_path / "bins");
+        std::filesystem::create_directories(base_path / "minimiser");
+        std::filesystem::create_directories(base_path / "out");
+
+        for (size_t bin = 0; bin < bin_count; ++bin)
+        {
+            std::filesystem::path const bin_file = base_path / "bins" / ("bin_" + std::to_string(bin) + ".fasta");
+            if (std::filesystem::exists(bin_file))
+                continue;
+            seqan3::sequence_file_output fout{bin_file, seqan3::fields<seqan3::field::seq, seqan3::field::id>{}};
+            fout.emplace_back(seqan3::test::generate_sequence<seqan3::dna4>(bin_size, 0, bin), std::to_string(bin));
+        }
+
+        // All user bins have the same size, hence the first bin is the largest one.
+        std::ofstream layout{base_path / "layout.pack"};
+        layout << "#HIGH_LEVEL_IBF max_bin_id:0\n";
+        for (size_t merged_bin = 0; merged_bin < merged_bins; ++merged_bin)
+            layout << "#MERGED_BIN_" << merged_bin << " max_bin_id:0\n";
+        layout << "#FILES\tBIN_INDICES\tNUMBER_OF_BINS\n";
+        for (size_t bin = 0; bin < bin_count; ++bin)
+            layout << (base_path / "bins" / ("bin_" + std::to_string(bin) + ".fasta")).string() << '\t'
+                   << bin % merged_bins << ';' << bin / merged_bins << "\t1;1\n";
+
+        return true;
+    }();
+    benchmark::DoNotOptimize(prepared);
+}
+
+static void set_arguments(raptor::build_arguments & arguments, size_t const threads, std::string const & directory)
+{
+    arguments.kmer_size = kmer_size;
+    arguments.window_size = window_size;
+    arguments.shape = seqan3::shape{seqan3::ungapped{kmer_size}};
+    arguments.threads = threads;
+    arguments.bins = bin_count;
+    arguments.bits = 8ULL * 1024ULL * 1024ULL; // 1 MiB per bin
+    arguments.hash = 2u;
+    arguments.fpr = 0.05;
+    arguments.out_path = base_path / "out" / "index";
+    arguments.bin_file = base_path / "layout.pack";
+
+    for (size_t bin = 0; bin < bin_count; ++bin)
+    {
+        std::string const extension = directory == "bins" ? ".fasta" : ".minimiser";
+        arguments.bin_path.push_back({(base_path / directory / ("bin_" + std::to_string(bin) + extension)).string()});
+    }
+}
+
+// Returns the user and system CPU time of the process in seconds.
+static double cpu_time()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+template <typename algorithm_t>
+static void run(benchmark::State & state, std::string const & directory, algorithm_t && algorithm)
+{
+    prepare_data();
+    size_t const threads = static_cast<size_t>(state.range(0));
+    uint64_t minimisers{};
+    double wall_time{};
+    double cpu{};
+
+    for (auto _ : state)
+    {
+        raptor::build_arguments arguments{};
+        set_arguments(arguments, threads, directory);
+
+        double const cpu_start = cpu_time();
+        auto const start = std::chrono::steady_clock::now();
+        algorithm(arguments);
+        auto const end = std::chrono::steady_clock::now();
+        cpu += cpu_time() - cpu_start;
+        wall_time += std::chrono::duration<double>(end - start).count();
+        minimisers += arguments.metrics.minimisers;
+    }
+
+    state.counters["minimisers/s"] = benchmark::Counter(minimisers, benchmark::Counter::kIsRate);
+    state.counters["peak_rss"] = benchmark::Counter(raptor::peak_rss(), benchmark::Counter::kDefaults,
+                                                    benchmark::Counter::kIs1024);
+    state.counters["utilisation"] = wall_time > 0.0 ? cpu / (wall_time * threads) : 0.0;
+}
+
+static void index_factory(benchmark::State & state)
+{
+    run(state, "bins", [] (raptor::build_arguments const & arguments)
+    {
+        raptor::index_factory<false> factory{arguments};
+        benchmark::DoNotOptimize(factory());
+    });
+}
+
+static void compute_minimiser(benchmark::State & state)
+{
+    run(state, "bins", [] (raptor::build_arguments & arguments)
+    {
+        arguments.out_path = base_path / "minimiser";
+        raptor::compute_minimiser(arguments);
+    });
+}
+
+static void build_from_minimiser(benchmark::State & state)
+{
+    // The .minimiser files are written by compute_minimiser.
+    if (!std::filesystem::exists(base_path / "minimiser" / ("bin_" + std::to_string(bin_count - 1u) + ".minimiser")))
+    {
+        prepare_data();
+        raptor::build_arguments arguments{};
+        set_arguments(arguments, 1u, "bins");
+        arguments.out_path = base_path / "minimiser";
+        raptor::compute_minimiser(arguments);
+    }
+
+    run(state, "minimiser", [] (raptor::build_arguments const & arguments)
+    {
+        raptor::build_from_minimiser(arguments);
+    });
+}
+
+static void chopper_build(benchmark::State & state)
+{
+    run(state, "bins", [] (raptor::build_arguments const & arguments)
+    {
+        raptor::hibf::chopper_build<seqan3::data_layout::uncompressed>(arguments);
+    });
+}
+
+static void thread_counts(benchmark::internal::Benchmark * benchmark)
+{
+    benchmark->ArgName("threads")->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(index_factory)->Apply(thread_counts);
+BENCHMARK(compute_minimiser)->Apply(thread_counts);
+BENCHMARK(build_from_minimiser)->Apply(thread_counts);
+BENCHMARK(chopper_build)->Apply(thread_counts);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,271 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <random>
+
+#include <seqan3/alphabet/nucleotide/dna4.hpp>
+#include <seqan3/search/views/minimiser_hash.hpp>
+#include <seqan3/test/performance/sequence_generator.hpp>
+#include <seqan3/utility/views/slice.hpp>
+
+#include <raptor/adjust_seed.hpp>
+#include <raptor/hierarchical_interleaved_bloom_filter.hpp>
+
+// Synthetic HIBF layouts:
+// * Each IBF has `fan_out` technical bins.
+// * Each IBF above the lowest level has `merged` merged bins, each pointing to a lower level IBF.
+// * All other technical bins store user bins. Each user bin is split into `split` technical bins.
+// * `depth` is the number of levels.
+// Reads are sampled from a user bin with probability `hit_rate` and are random sequences otherwise.
+
+#if 1
+static constexpr size_t const user_bin_size{4096};
+static constexpr size_t const read_size{250};
+static constexpr size_t const read_count{1000};
+#else
+static constexpr size_t const user_bin_size{1ULL<<20};
+static constexpr size_t const read_size{250};
+static constexpr size_t const read_count{1ULL<<16};
+#endif
+
+static constexpr size_t const hash_num{2u};
+static constexpr double const fpr{0.05};
+static constexpr size_t const window_size{24};
+static constexpr size_t const kmer_size{20};
+static constexpr double const threshold_fraction{0.5}; // A read is reported if half of its minimisers are found.
+
+static auto const hash_adaptor = seqan3::views::minimiser_hash(seqan3::ungapped{kmer_size},
+                                                               seqan3::window_size{window_size},
+                                                               seqan3::seed{raptor::adjust_seed(kmer_size)});
+
+using sequence_t = std::vector<seqan3::dna4>;
+using hibf_t = raptor::hierarchical_interleaved_bloom_filter<seqan3::data_layout::uncompressed>;
+using compressed_hibf_t = raptor::hierarchical_interleaved_bloom_filter<seqan3::data_layout::compressed>;
+
+struct layout_parameters
+{
+    size_t depth{};
+    size_t fan_out{};
+    size_t split{};
+    size_t merged{};
+
+    auto operator<=>(layout_parameters const &) const = default;
+};
+
+static size_t compute_bin_size(size_t const max_bin_size)
+{
+    double const numerator{- static_cast<double>(max_bin_size * hash_num)};
+    double const denominator{std::log(1 - std::exp(std::log(fpr) / hash_num))};
+    return std::max<size_t>(1u, std::ceil(numerator / denominator));
+}
+
+// Builds the HIBF and the sequences of its user bins.
+class synthetic_hibf_builder
+{
+public:
+    explicit synthetic_hibf_builder(layout_parameters const & parameters) : parameters{parameters}
+    {
+        if (parameters.depth == 0u || parameters.split == 0u || parameters.split > parameters.fan_out ||
+            parameters.merged >= parameters.fan_out)
+            throw std::invalid_argument{"Invalid layout."};
+
+        build(0u);
+        hibf.user_bins.set_ibf_count(hibf.ibf_vector.size());
+        hibf.user_bins.set_user_bin_count(user_bins.size());
+        for (size_t ibf_idx = 0; ibf_idx < hibf.ibf_vector.size(); ++ibf_idx)
+            hibf.user_bins.bin_indices_of_ibf(ibf_idx) = std::move(bin_indices[ibf_idx]);
+        for (size_t user_bin = 0; user_bin < user_bins.size(); ++user_bin)
+            hibf.user_bins.filename_of_user_bin(user_bin) = std::to_string(user_bin);
+    }
+
+    layout_parameters const parameters;
+    hibf_t hibf{};
+    std::vector<sequence_t> user_bins{};
+
+private:
+    std::vector<std::vector<int64_t>> bin_indices{};
+
+    // Builds the IBF on `level` and returns its ID and all hashes stored in it.
+    std::pair<size_t, std::vector<uint64_t>> build(size_t const level)
+    {
+        size_t const ibf_idx = hibf.ibf_vector.size();
+        hibf.ibf_vector.emplace_back();
+        hibf.next_ibf_id.emplace_back(parameters.fan_out, static_cast<int64_t>(ibf_idx));
+        bin_indices.emplace_back(parameters.fan_out, -1);
+
+        std::vector<std::vector<uint64_t>> technical_bins(parameters.fan_out);
+        size_t const merged = level + 1u < parameters.depth ? parameters.merged : 0u;
+
+        for (size_t bin = 0; bin < merged; ++bin)
+        {
+            auto [child_idx, hashes] = build(level + 1u);
+            hibf.next_ibf_id[ibf_idx][bin] = child_idx;
+            technical_bins[bin] = std::move(hashes);
+        }
+
+        // Remaining technical bins that cannot hold another split user bin stay empty.
+        for (size_t bin = merged; bin + parameters.split <= parameters.fan_out; bin += parameters.split)
+        {
+            size_t const user_bin = user_bins.size();
+            user_bins.push_back(seqan3::test::generate_sequence<seqan3::dna4>(user_bin_size, 0, user_bin));
+
+            std::vector<uint64_t> hashes{};
+            for (auto && hash : user_bins.back() | hash_adaptor)
+                hashes.push_back(hash);
+
+            // Distribute the hashes evenly across the split bins.
+            for (size_t i = 0; i < hashes.size(); ++i)
+                technical_bins[bin + i % parameters.split].push_back(hashes[i]);
+            for (size_t i = 0; i < parameters.split; ++i)
+                bin_indices[ibf_idx][bin + i] = user_bin;
+        }
+
+        size_t const max_size = std::ranges::max(technical_bins | std::views::transform(std::ranges::size));
+        hibf_t::ibf_t ibf{seqan3::bin_count{parameters.fan_out},
+                          seqan3::bin_size{compute_bin_size(max_size)},
+                          seqan3::hash_function_count{hash_num}};
+
+        std::vector<uint64_t> all_hashes{};
+        for (size_t bin = 0; bin < parameters.fan_out; ++bin)
+        {
+            for (uint64_t const hash : technical_bins[bin])
+                ibf.emplace(hash, seqan3::bin_index{bin});
+            all_hashes.insert(all_hashes.end(), technical_bins[bin].begin(), technical_bins[bin].end());
+        }
+
+        hibf.ibf_vector[ibf_idx] = std::move(ibf);
+        return {ibf_idx, std::move(all_hashes)};
+    }
+};
+
+static synthetic_hibf_builder const & get_hibf(layout_parameters const & parameters)
+{
+    static std::map<layout_parameters, synthetic_hibf_builder> cache{};
+    auto it = cache.find(parameters);
+    if (it == cache.end())
+        it = cache.try_emplace(parameters, parameters).first;
+    return it->second;
+}
+
+static std::vector<sequence_t> generate_reads(std::vector<sequence_t> const & user_bins, double const hit_rate)
+{
+    std::mt19937_64 engine{42u};
+    std::bernoulli_distribution is_hit{hit_rate};
+    std::uniform_int_distribution<size_t> user_bin_distribution{0u, user_bins.size() - 1u};
+    std::uniform_int_distribution<size_t> position_distribution{0u, user_bin_size - read_size};
+
+    std::vector<sequence_t> reads(read_count);
+    for (size_t i = 0; i < read_count; ++i)
+    {
+        if (is_hit(engine))
+        {
+            auto const & user_bin = user_bins[user_bin_distribution(engine)];
+            size_t const start = position_distribution(engine);
+            auto v = user_bin | seqan3::views::slice(start, start + read_size);
+            reads[i].assign(v.begin(), v.end());
+        }
+        else
+        {
+            reads[i] = seqan3::test::generate_sequence<seqan3::dna4>(read_size, 0, engine());
+        }
+    }
+    return reads;
+}
+
+template <seqan3::data_layout data_layout_mode>
+static void bulk_contains(benchmark::State & state)
+{
+    layout_parameters const parameters{.depth = static_cast<size_t>(state.range(0)),
+                                       .fan_out = static_cast<size_t>(state.range(1)),
+                                       .split = static_cast<size_t>(state.range(2)),
+                                       .merged = static_cast<size_t>(state.range(3))};
+    double const hit_rate = state.range(4) / 100.0;
+
+    synthetic_hibf_builder const & builder = get_hibf(parameters);
+    std::vector<sequence_t> const reads = generate_reads(builder.user_bins, hit_rate);
+
+    raptor::hierarchical_interleaved_bloom_filter<data_layout_mode> hibf{};
+    if constexpr (data_layout_mode == seqan3::data_layout::uncompressed)
+    {
+        hibf = builder.hibf;
+    }
+    else
+    {
+        for (auto const & ibf : builder.hibf.ibf_vector)
+            hibf.ibf_vector.emplace_back(ibf);
+        hibf.next_ibf_id = builder.hibf.next_ibf_id;
+        hibf.user_bins.set_ibf_count(builder.hibf.ibf_vector.size());
+        hibf.user_bins.set_user_bin_count(builder.user_bins.size());
+        for (size_t ibf_idx = 0; ibf_idx < builder.hibf.ibf_vector.size(); ++ibf_idx)
+        {
+            auto & indices = hibf.user_bins.bin_indices_of_ibf(ibf_idx);
+            for (size_t bin = 0; bin < parameters.fan_out; ++bin)
+                indices.push_back(builder.hibf.user_bins.filename_index(ibf_idx, bin));
+        }
+    }
+
+    std::vector<std::vector<uint64_t>> minimisers(reads.size());
+    for (size_t i = 0; i < reads.size(); ++i)
+        for (auto && hash : reads[i] | hash_adaptor)
+            minimisers[i].push_back(hash);
+
+    auto agent = hibf.membership_agent();
+    size_t hits{};
+    for (auto _ : state)
+    {
+        for (auto const & query : minimisers)
+        {
+            size_t const threshold = std::max<size_t>(1u, std::ceil(query.size() * threshold_fraction));
+            auto & result = agent.bulk_contains(query, threshold);
+            hits += result.size();
+            benchmark::DoNotOptimize(result.data());
+        }
+    }
+
+    double const queries = static_cast<double>(read_count) * state.iterations();
+    state.counters["ibfs"] = hibf.ibf_vector.size();
+    state.counters["user_bins"] = builder.user_bins.size();
+    state.counters["reads/s"] = benchmark::Counter(read_count,
+                                                   benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["s/read"] = benchmark::Counter(read_count,
+                                                  benchmark::Counter::kIsIterationInvariantRate |
+                                                  benchmark::Counter::kInvert);
+    state.counters["ibfs_visited/read"] = agent.ibfs_visited / queries;
+    state.counters["lookups/read"] = agent.lookups / queries;
+    state.counters["hits/read"] = hits / queries;
+}
+
+// {depth, fan_out, split, merged, hit_rate in percent}
+static void layouts(benchmark::internal::Benchmark * benchmark)
+{
+    benchmark->ArgNames({"depth", "fan_out", "split", "merged", "hit_rate"});
+
+    // Influence of depth and fan-out.
+    for (int64_t const depth : {1, 2, 3})
+        for (int64_t const fan_out : {64, 256})
+            benchmark->Args({depth, fan_out, 1, 4, 50});
+
+    // Influence of split bins.
+    for (int64_t const split : {2, 8})
+        benchmark->Args({2, 64, split, 4, 50});
+
+    // Influence of merged bins.
+    for (int64_t const merged : {1, 16})
+        benchmark->Args({2, 64, 1, merged, 50});
+
+    // Influence of the hit rate.
+    for (int64_t const hit_rate : {0, 10, 100})
+        benchmark->Args({2, 64, 1, 4, hit_rate});
+}
+
+BENCHMARK_TEMPLATE(bulk_contains, seqan3::data_layout::uncompressed)->Apply(layouts);
+BENCHMARK_TEMPLATE(bulk_contains, seqan3::data_layout::compressed)->Apply(layouts);
+
+BENCHMARK_MAIN();
@@ -67,7 +67,7 @@ TEST_F(argparse_main, no_subparser)
     std::string const expected
     {
         "[Error] You either forgot or misspelled the subcommand! Please specify which sub-program you want to use: one "
-        "of [build,search,socks,upgrade]. Use -h/--help for more information.\n"
+        "of [build,merge,remove,search,socks,update,upgrade]. Use -h/--help for more information.\n"
     };
     EXPECT_EQ(result.out, std::string{});
     EXPECT_EQ(result.err, expected);
@@ -80,7 +80,7 @@ TEST_F(argparse_main, unknown_option)
     std::string const expected
     {
         "[Error] You either forgot or misspelled the subcommand! Please specify which sub-program you want to use: one "
-        "of [build,search,socks,upgrade]. Use -h/--help for more information.\n"
+        "of [build,merge,remove,search,socks,update,upgrade]. Use -h/--help for more information.\n"
     };
     EXPECT_EQ(result.out, std::string{});
     EXPECT_EQ(result.err, expected);
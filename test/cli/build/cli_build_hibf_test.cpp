@@ -85,3 +85,34 @@ TEST_F(build_hibf, three_levels)
 
     compare_index<raptor::index_structure::hibf>(data("three_levels.hibf"), "raptor.index");
 }
+
+// With a small memory limit, the k-mers of merged bins are written to temporary files. The index must not change.
+TEST_F(build_hibf, three_levels_memory_limit)
+{
+    cli_test_result const result = execute_app("raptor", "build",
+                                                         "--hibf",
+                                                         "--kmer 19",
+                                                         "--window 19",
+                                                         "--fpr 0.05",
+                                                         "--threads 2",
+                                                         "--memory-limit 1k",
+                                                         "--metrics build.json",
+                                                         "--output raptor.index",
+                                                         data("three_levels.pack"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_index<raptor::index_structure::hibf>(data("three_levels.hibf"), "raptor.index");
+
+    std::ifstream metrics_file{"build.json"};
+    std::string const metrics{std::istreambuf_iterator<char>{metrics_file}, std::istreambuf_iterator<char>{}};
+    std::string const key{"\"spilled_files\": "};
+    size_t const position = metrics.find(key);
+    ASSERT_NE(position, std::string::npos);
+    EXPECT_GT(std::stoull(metrics.substr(position + key.size())), 0u);
+
+    // The temporary files are written next to the index and removed afterwards.
+    for (auto const & entry : std::filesystem::directory_iterator{std::filesystem::current_path()})
+        EXPECT_FALSE(entry.path().filename().string().starts_with("raptor_kmers_")) << entry.path();
+}
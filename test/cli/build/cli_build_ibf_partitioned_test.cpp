@@ -104,6 +104,36 @@ TEST_F(build_ibf_partitioned, pipeline_misc)
     compare_search(16, 1, "search2.out", is_empty::yes);
 }
 
+// If the parts do not fit into the available memory, they are built one at a time. The parts are the same.
+TEST_F(build_ibf_partitioned, one_part_at_a_time)
+{
+    {
+        std::ofstream file{"raptor_cli_test.txt"};
+        for (auto && file_path : get_repeated_bins(16))
+            file << file_path << '\n';
+        file << '\n';
+    }
+
+    for (std::string const available_memory : {"1t", "1k"})
+    {
+        cli_test_result const result = execute_app("raptor", "build",
+                                                             "--kmer 19",
+                                                             "--window 23",
+                                                             "--size 64k",
+                                                             "--threads 2",
+                                                             "--output ", available_memory + ".index",
+                                                             "--parts 4",
+                                                             "--available-memory ", available_memory,
+                                                             "raptor_cli_test.txt");
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    for (size_t part = 0; part < 4u; ++part)
+        compare_index("1t.index_" + std::to_string(part), "1k.index_" + std::to_string(part));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     build_ibf_partitioned_suite,
     build_ibf_partitioned,
@@ -0,0 +1,247 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include "../cli_test.hpp"
+
+struct build_ibf_sharded : public raptor_base,
+                           public testing::WithParamInterface<std::tuple<size_t, size_t, size_t, size_t, bool>>
+{
+    // Writes the bins of get_repeated_bins(number_of_repeated_bins) in [first, last) to `file_name`.
+    static void write_bins(std::string const & file_name,
+                           size_t const number_of_repeated_bins,
+                           size_t const first = 0u,
+                           size_t const last = std::numeric_limits<size_t>::max())
+    {
+        std::ofstream file{file_name};
+        size_t i{};
+        for (auto && file_path : get_repeated_bins(number_of_repeated_bins))
+        {
+            if (i >= first && i < last)
+                file << file_path << '\n';
+            ++i;
+        }
+        file << '\n';
+    }
+};
+
+// The bins have the same size for all numbers of user bins.
+TEST_P(build_ibf_sharded, pipeline)
+{
+    auto const [number_of_repeated_bins, window_size, number_of_errors, shards, compressed] = GetParam();
+
+    write_bins("raptor_cli_test.txt", number_of_repeated_bins);
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--kmer 19",
+                                                          "--window ", std::to_string(window_size),
+                                                          "--size ", std::to_string(2u * number_of_repeated_bins) + "k",
+                                                          "--output raptor.index",
+                                                          compressed ? "--compressed" : "--threads 1",
+                                                          "--shards ", std::to_string(shards),
+                                                          "raptor_cli_test.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "search",
+                                                          "--fpr 0.05",
+                                                          "--output search.out",
+                                                          "--error ", std::to_string(number_of_errors),
+                                                          "--p_max 0.4",
+                                                          "--threads 2",
+                                                          "--index ", "raptor.index",
+                                                          "--query ", data("query.fq"));
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    compare_search(number_of_repeated_bins, number_of_errors, "search.out");
+
+    // The worker processes report the same hits.
+    cli_test_result const result3 = execute_app("raptor", "search",
+                                                          "--fpr 0.05",
+                                                          "--output processes.out",
+                                                          "--error ", std::to_string(number_of_errors),
+                                                          "--p_max 0.4",
+                                                          "--threads 2",
+                                                          "--worker-processes",
+                                                          "--index ", "raptor.index",
+                                                          "--query ", data("query.fq"));
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    compare_search(number_of_repeated_bins, number_of_errors, "processes.out");
+}
+
+// Each shard is the same as an index built from its user bins only. Shards of earlier builds are removed.
+TEST_F(build_ibf_sharded, shards)
+{
+    write_bins("all.txt", 48u);
+    write_bins("first.txt", 48u, 0u, 64u);
+    write_bins("second.txt", 48u, 64u, 128u);
+    write_bins("third.txt", 48u, 128u);
+    std::ofstream{"raptor.index_shard_3"} << "stale";
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--kmer 19",
+                                                          "--window 19",
+                                                          "--size 96k",
+                                                          "--output raptor.index",
+                                                          "--shards 3",
+                                                          "all.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+    EXPECT_FALSE(std::filesystem::exists("raptor.index_shard_3"));
+
+    for (std::string const name : {"first", "second", "third"})
+    {
+        cli_test_result const result = execute_app("raptor", "build",
+                                                             "--kmer 19",
+                                                             "--window 19",
+                                                             "--size 32k",
+                                                             "--output ", name + ".index",
+                                                             name + ".txt");
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    compare_index("first.index", "raptor.index_shard_0");
+    compare_index("second.index", "raptor.index_shard_1");
+    compare_index("third.index", "raptor.index_shard_2");
+}
+
+// An unsharded build removes the shards of an earlier build, which raptor search would prefer.
+TEST_F(build_ibf_sharded, unsharded_rebuild)
+{
+    write_bins("raptor_cli_test.txt", 32u);
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--kmer 19",
+                                                          "--size 64k",
+                                                          "--output raptor.index",
+                                                          "--shards 2",
+                                                          "raptor_cli_test.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+    EXPECT_TRUE(std::filesystem::exists("raptor.index_shard_1"));
+
+    cli_test_result const result2 = execute_app("raptor", "build",
+                                                          "--kmer 19",
+                                                          "--size 64k",
+                                                          "--output raptor.index",
+                                                          "raptor_cli_test.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+    EXPECT_FALSE(std::filesystem::exists("raptor.index_shard_0"));
+    EXPECT_FALSE(std::filesystem::exists("raptor.index_shard_1"));
+
+    cli_test_result const result3 = execute_app("raptor", "search",
+                                                          "--fpr 0.05",
+                                                          "--output search.out",
+                                                          "--error 0",
+                                                          "--p_max 0.4",
+                                                          "--index ", "raptor.index",
+                                                          "--query ", data("query.fq"));
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    compare_search(32u, 0u, "search.out");
+}
+
+// A sharded build removes an earlier unsharded index. If both exist, raptor search fails.
+TEST_F(build_ibf_sharded, sharded_and_unsharded)
+{
+    write_bins("raptor_cli_test.txt", 32u);
+    std::ofstream{"raptor.index"} << "stale";
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--kmer 19",
+                                                          "--size 64k",
+                                                          "--output raptor.index",
+                                                          "--shards 2",
+                                                          "raptor_cli_test.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+    EXPECT_FALSE(std::filesystem::exists("raptor.index"));
+
+    std::ofstream{"raptor.index"} << "stale";
+
+    cli_test_result const result2 = execute_app("raptor", "search",
+                                                          "--fpr 0.05",
+                                                          "--output search.out",
+                                                          "--index ", "raptor.index",
+                                                          "--query ", data("query.fq"));
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{"[Error] Both a sharded and an unsharded index exist for raptor.index. "
+                                       "Remove the stale one.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result2);
+}
+
+TEST_F(build_ibf_sharded, with_parts)
+{
+    write_bins("raptor_cli_test.txt", 32u);
+
+    cli_test_result const result = execute_app("raptor", "build",
+                                                         "--kmer 19",
+                                                         "--size 64k",
+                                                         "--output raptor.index",
+                                                         "--parts 2",
+                                                         "--shards 2",
+                                                         "raptor_cli_test.txt");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{"[Error] You cannot set both --shards and --parts.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result);
+}
+
+TEST_F(build_ibf_sharded, worker_processes_without_shards)
+{
+    write_bins("raptor_cli_test.txt", 32u);
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--kmer 19",
+                                                          "--size 64k",
+                                                          "--output raptor.index",
+                                                          "raptor_cli_test.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "search",
+                                                          "--fpr 0.05",
+                                                          "--output search.out",
+                                                          "--worker-processes",
+                                                          "--index ", "raptor.index",
+                                                          "--query ", data("query.fq"));
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{"[Error] --worker-processes can only be used with sharded indices.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result2);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    build_ibf_sharded_suite,
+    build_ibf_sharded,
+    testing::Combine(testing::Values(32, 48),
+                     testing::Values(19, 23),
+                     testing::Values(0, 1),
+                     testing::Values(2, 3),
+                     testing::Values(true, false)),
+    [] (testing::TestParamInfo<build_ibf_sharded::ParamType> const & info)
+    {
+        std::string name = std::to_string(std::max<int>(1, std::get<0>(info.param) * 4)) + "_bins_" +
+                        std::to_string(std::get<1>(info.param)) + "_window_" +
+                        std::to_string(std::get<2>(info.param)) + "_error" +
+                        std::to_string(std::get<3>(info.param)) + "_shards" +
+                        (std::get<4>(info.param) ? "compressed" : "uncompressed");
+        return name;
+    });
@@ -94,6 +94,83 @@ TEST_P(build_ibf, with_socks_file)
     compare_index(ibf_path(number_of_repeated_bins, window_size), "raptor.index");
 }
 
+TEST_P(build_ibf, huge_pages)
+{
+    auto const [number_of_repeated_bins, window_size, run_parallel_tmp] = GetParam();
+    bool const run_parallel = run_parallel_tmp && number_of_repeated_bins >= 32;
+
+    { // generate input file
+        std::ofstream file{"raptor_cli_test.txt"};
+        for (auto && file_path : get_repeated_bins(number_of_repeated_bins))
+            file << file_path << '\n';
+        file << '\n';
+    }
+
+    cli_test_result const result = execute_app("raptor", "build",
+                                                         "--kmer 19",
+                                                         "--window ", std::to_string(window_size),
+                                                         "--size 64k",
+                                                         "--threads ", run_parallel ? "2" : "1",
+                                                         "--huge-pages",
+                                                         "--output raptor.index",
+                                                         "raptor_cli_test.txt");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_index(ibf_path(number_of_repeated_bins, window_size), "raptor.index");
+}
+
+// Inserting large files in chunks gives the same index as inserting them as a whole.
+TEST_F(build_ibf, chunked)
+{
+    // About 38 KiB of FASTA and 4 KiB of FASTQ.
+    {
+        std::ofstream fasta{"large.fa"};
+        std::ofstream fastq{"large.fq"};
+        for (size_t i = 0; i < 20u; ++i)
+        {
+            for (std::string const bin : {"bin1.fa", "bin2.fa", "bin3.fa", "bin4.fa"})
+                fasta << std::ifstream{data(bin)}.rdbuf();
+            fastq << std::ifstream{data("query.fq")}.rdbuf();
+        }
+    }
+    {
+        std::ofstream file{"raptor_cli_test.txt"};
+        file << "large.fa\nlarge.fq\n" << data("bin1.fa").string() << '\n';
+    }
+
+    auto build = [this] (std::string const & output, std::string const & threads, std::string const & chunk_size)
+    {
+        cli_test_result const result = execute_app("raptor", "build",
+                                                             "--kmer 19",
+                                                             "--window 23",
+                                                             "--size 64k",
+                                                             "--threads ", threads,
+                                                             "--chunk-size ", chunk_size,
+                                                             "--output ", output,
+                                                             "raptor_cli_test.txt");
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    };
+
+    build("whole.index", "1", "1k");
+    build("chunked.index", "2", "1k");
+    build("unchunked.index", "2", "64m");
+
+    auto read = [] (std::string const & file_name)
+    {
+        std::ifstream file{file_name, std::ios::binary};
+        return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    };
+
+    std::string const expected = read("whole.index");
+    EXPECT_FALSE(expected.empty());
+    EXPECT_TRUE(read("chunked.index") == expected);
+    EXPECT_TRUE(read("unchunked.index") == expected);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     build_ibf_suite,
     build_ibf,
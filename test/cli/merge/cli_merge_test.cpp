@@ -0,0 +1,185 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include "../cli_test.hpp"
+
+struct merge_indices : public raptor_base
+{
+    // Writes the bins of get_repeated_bins(16) in [first, last) to `file_name`.
+    static void write_bins(std::string const & file_name, size_t const first, size_t const last)
+    {
+        std::ofstream file{file_name};
+        size_t i{};
+        for (auto && file_path : get_repeated_bins(16))
+        {
+            if (i >= first && i < last)
+                file << file_path << '\n';
+            ++i;
+        }
+        file << '\n';
+    }
+
+    cli_test_result build(std::string const & bin_file,
+                          std::string_view const size = "64k",
+                          std::string_view const window = "19",
+                          std::string_view const parts = "1")
+    {
+        return execute_app("raptor", "build",
+                                     "--kmer 19",
+                                     "--window ", window,
+                                     "--size ", size,
+                                     "--parts ", parts,
+                                     "--output ", bin_file + ".index",
+                                     bin_file);
+    }
+};
+
+// The merged index is the same as the index built from all user bins.
+TEST_F(merge_indices, ibf)
+{
+    write_bins("all.txt", 0u, 64u);
+    write_bins("first.txt", 0u, 20u);
+    write_bins("second.txt", 20u, 21u);
+    write_bins("third.txt", 21u, 64u);
+
+    for (std::string const bin_file : {"all.txt", "first.txt", "second.txt", "third.txt"})
+    {
+        cli_test_result const result = build(bin_file);
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    cli_test_result const result = execute_app("raptor", "merge",
+                                                         "--threads 2",
+                                                         "--output raptor.index",
+                                                         "first.txt.index",
+                                                         "second.txt.index",
+                                                         "third.txt.index");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_index("all.txt.index", "raptor.index");
+}
+
+TEST_F(merge_indices, ibf_partitioned)
+{
+    write_bins("all.txt", 0u, 64u);
+    write_bins("first.txt", 0u, 32u);
+    write_bins("second.txt", 32u, 64u);
+
+    for (std::string const bin_file : {"all.txt", "first.txt", "second.txt"})
+    {
+        cli_test_result const result = build(bin_file, "64k", "19", "4");
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    cli_test_result const result = execute_app("raptor", "merge",
+                                                         "--output raptor.index",
+                                                         "first.txt.index",
+                                                         "second.txt.index");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    for (size_t part = 0; part < 4u; ++part)
+        compare_index("all.txt.index_" + std::to_string(part), "raptor.index_" + std::to_string(part));
+}
+
+TEST_F(merge_indices, different_size)
+{
+    write_bins("first.txt", 0u, 32u);
+    write_bins("second.txt", 32u, 64u);
+
+    cli_test_result const result1 = build("first.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = build("second.txt", "32k");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    cli_test_result const result3 = execute_app("raptor", "merge",
+                                                          "--output raptor.index",
+                                                          "first.txt.index",
+                                                          "second.txt.index");
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{"[Error] The index second.txt.index has a different size or number of hash "
+                                       "functions than first.txt.index.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result3);
+}
+
+TEST_F(merge_indices, different_window)
+{
+    write_bins("first.txt", 0u, 32u);
+    write_bins("second.txt", 32u, 64u);
+
+    cli_test_result const result1 = build("first.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = build("second.txt", "64k", "23");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    cli_test_result const result3 = execute_app("raptor", "merge",
+                                                          "--output raptor.index",
+                                                          "first.txt.index",
+                                                          "second.txt.index");
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{"[Error] The index second.txt.index was built with a different window size, "
+                                       "shape, or number of parts than first.txt.index.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result3);
+}
+
+TEST_F(merge_indices, hibf)
+{
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--hibf",
+                                                          "--kmer 19",
+                                                          "--window 19",
+                                                          "--fpr 0.05",
+                                                          "--output raptor.index",
+                                                          pack_path(16));
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "merge",
+                                                          "--output merged.index",
+                                                          "raptor.index",
+                                                          "raptor.index");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{"[Error] The index raptor.index is not an IBF. HIBF indices cannot be "
+                                       "merged.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result2);
+    EXPECT_FALSE(std::filesystem::exists("merged.index"));
+}
+
+TEST_F(merge_indices, single_index)
+{
+    write_bins("first.txt", 0u, 32u);
+
+    cli_test_result const result1 = build("first.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "merge",
+                                                          "--output raptor.index",
+                                                          "first.txt.index");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{"[Error] At least two indices must be given.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result2);
+}
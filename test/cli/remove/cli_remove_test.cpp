@@ -0,0 +1,298 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include "../cli_test.hpp"
+
+struct remove_user_bins : public raptor_base
+{
+    // Writes the bins of get_repeated_bins(16) whose file name does not end with `skipped` to `file_name`.
+    static void write_bins(std::string const & file_name, std::string_view const skipped = "none")
+    {
+        std::ofstream file{file_name};
+        for (auto && file_path : get_repeated_bins(16))
+            if (!std::string_view{file_path}.ends_with(skipped))
+                file << file_path << '\n';
+        file << '\n';
+    }
+
+    static void write_removed(std::string const & file_name)
+    {
+        std::ofstream file{file_name};
+        file << data("bin2.fa").string() << '\n';
+    }
+
+    cli_test_result build(std::string const & bin_file)
+    {
+        return execute_app("raptor", "build",
+                                     "--kmer 19",
+                                     "--window 19",
+                                     "--size 64k",
+                                     "--output ", bin_file + ".index",
+                                     bin_file);
+    }
+
+    cli_test_result search(bool const is_hibf)
+    {
+        return execute_app("raptor", "search",
+                                     is_hibf ? "--hibf" : "",
+                                     "--fpr 0.05",
+                                     "--error 0",
+                                     "--p_max 0.4",
+                                     "--index raptor.index",
+                                     "--query ", data("query.fq"),
+                                     "--output search.out");
+    }
+
+    // Like compare_search, but removed user bins have no file name and are not reported.
+    static void check_search(std::string_view const filename, size_t const number_of_bins)
+    {
+        std::ifstream search_result{filename.data()};
+        std::string line;
+        std::string expected_hits;
+
+        for (size_t i = 0; i < number_of_bins; ++i)
+        {
+            ASSERT_TRUE(std::getline(search_result, line));
+            std::string_view line_view{line};
+            size_t const tab = line_view.find('\t');
+            if (tab != std::string_view::npos && !line_view.ends_with("bin4.fa"))
+                expected_hits += line_view.substr(1, tab);
+        }
+
+        if (!expected_hits.empty())
+            expected_hits.pop_back(); // remove trailing '\t'
+        std::ranges::replace(expected_hits, '\t', ',');
+
+        ASSERT_TRUE(std::getline(search_result, line));
+        ASSERT_EQ(line, "#QUERY_NAME\tUSER_BINS");
+
+        for (char i : {'1', '2', '3'})
+        {
+            EXPECT_TRUE(std::getline(search_result, line));
+            EXPECT_EQ(line, std::string{"query"} + i + '\t' + expected_hits);
+        }
+
+        EXPECT_FALSE(std::getline(search_result, line));
+    }
+};
+
+// All 16 user bins consisting of bin2.fa are cleared. The other user bins keep their numbers.
+TEST_F(remove_user_bins, ibf)
+{
+    write_bins("all.txt");
+    write_removed("removed.txt");
+
+    cli_test_result const result1 = build("all.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "remove",
+                                                          "--input all.txt.index",
+                                                          "--output raptor.index",
+                                                          "removed.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    cli_test_result const result3 = search(false);
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    std::ifstream search_result{"search.out"};
+    std::string line{};
+    ASSERT_TRUE(std::getline(search_result, line));
+    EXPECT_EQ(line, "#0\t" + data("bin1.fa").string());
+    ASSERT_TRUE(std::getline(search_result, line));
+    EXPECT_EQ(line, "#1");
+
+    check_search("search.out", 64u);
+}
+
+// With a threshold of 0, all remaining user bins are reported, also the ones not containing the query.
+TEST_F(remove_user_bins, ibf_threshold_zero)
+{
+    write_bins("all.txt");
+    write_removed("removed.txt");
+
+    cli_test_result const result1 = build("all.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "remove",
+                                                          "--input all.txt.index",
+                                                          "--output raptor.index",
+                                                          "removed.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    cli_test_result const result3 = execute_app("raptor", "search",
+                                                          "--threshold 0",
+                                                          "--index raptor.index",
+                                                          "--query ", data("query.fq"),
+                                                          "--output search.out");
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    std::string expected_hits{};
+    size_t user_bin{};
+    for (auto && file_path : get_repeated_bins(16))
+    {
+        if (!std::string_view{file_path}.ends_with("bin2.fa"))
+            expected_hits += std::to_string(user_bin) + ',';
+        ++user_bin;
+    }
+    expected_hits.pop_back();
+
+    std::ifstream search_result{"search.out"};
+    std::string line{};
+    for (size_t i = 0; i < 64u; ++i)
+        ASSERT_TRUE(std::getline(search_result, line));
+
+    ASSERT_TRUE(std::getline(search_result, line));
+    ASSERT_EQ(line, "#QUERY_NAME\tUSER_BINS");
+
+    for (char i : {'1', '2', '3'})
+    {
+        EXPECT_TRUE(std::getline(search_result, line));
+        EXPECT_EQ(line, std::string{"query"} + i + '\t' + expected_hits);
+    }
+}
+
+// Compacting drops the cleared bins. The result is the same as building the index without them.
+TEST_F(remove_user_bins, ibf_compact)
+{
+    write_bins("all.txt");
+    write_bins("kept.txt", "bin2.fa");
+    write_removed("removed.txt");
+
+    cli_test_result const result1 = build("all.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = build("kept.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    cli_test_result const result3 = execute_app("raptor", "remove",
+                                                          "--input all.txt.index",
+                                                          "--output all.txt.index",
+                                                          "removed.txt");
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    // A later call only compacts.
+    std::ofstream{"empty.txt"};
+    cli_test_result const result4 = execute_app("raptor", "remove",
+                                                          "--compact",
+                                                          "--input all.txt.index",
+                                                          "--output raptor.index",
+                                                          "empty.txt");
+    EXPECT_EQ(result4.out, std::string{});
+    EXPECT_EQ(result4.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result4);
+
+    compare_index("kept.txt.index", "raptor.index");
+}
+
+TEST_F(remove_user_bins, hibf)
+{
+    write_removed("removed.txt");
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--hibf",
+                                                          "--kmer 19",
+                                                          "--window 19",
+                                                          "--fpr 0.05",
+                                                          "--output raptor.index",
+                                                          pack_path(16));
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "remove",
+                                                          "--hibf",
+                                                          "--input raptor.index",
+                                                          "--output raptor.index",
+                                                          "removed.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    cli_test_result const result3 = search(true);
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    check_search("search.out", 64u);
+
+    std::ofstream{"empty.txt"};
+    cli_test_result const result4 = execute_app("raptor", "remove",
+                                                          "--hibf",
+                                                          "--compact",
+                                                          "--input raptor.index",
+                                                          "--output raptor.index",
+                                                          "empty.txt");
+    EXPECT_EQ(result4.out, std::string{});
+    EXPECT_EQ(result4.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result4);
+
+    cli_test_result const result5 = search(true);
+    EXPECT_EQ(result5.out, std::string{});
+    EXPECT_EQ(result5.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result5);
+
+    check_search("search.out", 48u);
+}
+
+TEST_F(remove_user_bins, unknown_file)
+{
+    write_bins("all.txt", "bin2.fa");
+    write_removed("removed.txt");
+
+    cli_test_result const result1 = build("all.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "remove",
+                                                          "--input all.txt.index",
+                                                          "--output raptor.index",
+                                                          "removed.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, "[Error] The file " + data("bin2.fa").string() + " is not part of the index.\n");
+    RAPTOR_ASSERT_FAIL_EXIT(result2);
+}
+
+TEST_F(remove_user_bins, all_user_bins)
+{
+    {
+        std::ofstream file{"all.txt"};
+        file << data("bin2.fa").string() << '\n';
+    }
+    write_removed("removed.txt");
+
+    cli_test_result const result1 = build("all.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "remove",
+                                                          "--input all.txt.index",
+                                                          "--output raptor.index",
+                                                          "removed.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{"[Error] At least one user bin must remain in the index.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result2);
+}
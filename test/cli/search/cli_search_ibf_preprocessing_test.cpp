@@ -169,6 +169,49 @@ TEST_F(search_ibf_preprocessing, pipeline_compressed_index)
                                                            compare_extension::no);
 }
 
+TEST_F(search_ibf_preprocessing, pipeline_memory_limit)
+{
+    { // generate input files
+        std::ofstream file{"raptor_cli_test.txt"};
+        std::ofstream file2{"raptor_cli_test.minimiser"};
+        for (auto && file_path : get_repeated_bins(16))
+        {
+            file << file_path << '\n';
+            file2 << seqan3::detail::to_string("precomputed_minimisers/",
+                                               std::filesystem::path{file_path}.stem().c_str(),
+                                               ".minimiser\n");
+        }
+        file << '\n';
+    }
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--kmer 19",
+                                                          "--window 23",
+                                                          "--compute-minimiser",
+                                                          "--disable-cutoffs",
+                                                          "--memory-limit 1k",
+                                                          "--threads 2",
+                                                          "--output precomputed_minimisers",
+                                                          "raptor_cli_test.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    // No temporary files are left behind.
+    for (auto const & entry : std::filesystem::directory_iterator{"precomputed_minimisers"})
+        EXPECT_NE(entry.path().extension(), ".run") << entry.path();
+
+    cli_test_result const result2 = execute_app("raptor", "build",
+                                                          "--size 64k",
+                                                          "--output raptor.index",
+                                                          "raptor_cli_test.minimiser");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    compare_index(ibf_path(16, 23), "raptor.index", compare_extension::no);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     search_ibf_preprocessing_suite,
     search_ibf_preprocessing,
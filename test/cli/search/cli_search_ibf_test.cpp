@@ -120,6 +120,116 @@ TEST_F(search_ibf, cache_thresholds)
     compare_search(number_of_repeated_bins, number_of_errors, "search.out");
 }
 
+TEST_F(search_ibf, numa)
+{
+    size_t const number_of_repeated_bins{16};
+    uint32_t const window_size{23};
+    uint8_t const number_of_errors{1};
+
+    for (std::string const policy : {"interleave", "replicate"})
+    {
+        cli_test_result const result = execute_app("raptor", "search",
+                                                             "--fpr 0.05",
+                                                             "--numa", policy,
+                                                             "--threads 2",
+                                                             "--output search.out",
+                                                             "--error ", std::to_string(number_of_errors),
+                                                             "--p_max 0.4",
+                                                             "--index ", ibf_path(number_of_repeated_bins, window_size),
+                                                             "--query ", data("query.fq"));
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+
+        compare_search(number_of_repeated_bins, number_of_errors, "search.out");
+    }
+}
+
+TEST_F(search_ibf, huge_pages)
+{
+    size_t const number_of_repeated_bins{16};
+    uint32_t const window_size{23};
+    uint8_t const number_of_errors{1};
+
+    cli_test_result const result = execute_app("raptor", "search",
+                                                         "--fpr 0.05",
+                                                         "--huge-pages",
+                                                         "--output search.out",
+                                                         "--error ", std::to_string(number_of_errors),
+                                                         "--p_max 0.4",
+                                                         "--index ", ibf_path(number_of_repeated_bins, window_size),
+                                                         "--query ", data("query.fq"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_search(number_of_repeated_bins, number_of_errors, "search.out");
+}
+
+TEST_F(search_ibf, metrics)
+{
+    size_t const number_of_repeated_bins{16};
+    uint32_t const window_size{23};
+    uint8_t const number_of_errors{1};
+
+    cli_test_result const result = execute_app("raptor", "search",
+                                                         "--fpr 0.05",
+                                                         "--threads 2",
+                                                         "--metrics search.json",
+                                                         "--output search.out",
+                                                         "--error ", std::to_string(number_of_errors),
+                                                         "--p_max 0.4",
+                                                         "--index ", ibf_path(number_of_repeated_bins, window_size),
+                                                         "--query ", data("query.fq"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_search(number_of_repeated_bins, number_of_errors, "search.out");
+
+    std::ifstream metrics_file{"search.json"};
+    std::string const metrics{std::istreambuf_iterator<char>{metrics_file}, std::istreambuf_iterator<char>{}};
+    EXPECT_NE(metrics.find("\"command\": \"search\""), std::string::npos);
+    for (std::string const stage : {"index_io", "reads_io", "threshold", "compute"})
+        EXPECT_NE(metrics.find("\"name\": \"" + stage + "\""), std::string::npos) << stage;
+    EXPECT_NE(metrics.find("\"reads\": 3,"), std::string::npos);
+}
+
+TEST_F(search_ibf, perf_counters)
+{
+    size_t const number_of_repeated_bins{16};
+    uint32_t const window_size{23};
+    uint8_t const number_of_errors{1};
+
+    cli_test_result const result = execute_app("raptor", "search",
+                                                         "--fpr 0.05",
+                                                         "--threads 2",
+                                                         "--metrics search.json",
+                                                         "--perf-counters",
+                                                         "--output search.out",
+                                                         "--error ", std::to_string(number_of_errors),
+                                                         "--p_max 0.4",
+                                                         "--index ", ibf_path(number_of_repeated_bins, window_size),
+                                                         "--query ", data("query.fq"));
+    EXPECT_EQ(result.out, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_search(number_of_repeated_bins, number_of_errors, "search.out");
+
+    // Hardware counters may not be available, e.g. in containers. In this case, only a warning is emitted.
+    std::ifstream metrics_file{"search.json"};
+    std::string const metrics{std::istreambuf_iterator<char>{metrics_file}, std::istreambuf_iterator<char>{}};
+    if (result.err.empty())
+    {
+        for (std::string const scope : {"hashing", "counting", "threshold", "output"})
+            EXPECT_NE(metrics.find("\"" + scope + "\": {"), std::string::npos) << scope;
+    }
+    else
+    {
+        EXPECT_EQ(metrics.find("\"hardware_counters\""), std::string::npos);
+    }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     search_ibf_suite,
     search_ibf,
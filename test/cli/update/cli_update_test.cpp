@@ -0,0 +1,392 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <random>
+
+#include "../cli_test.hpp"
+
+struct update_ibf : public raptor_base
+{
+    // Writes the bins with index in [first, last) of get_repeated_bins(16) to `file_name`.
+    static void write_bins(std::string const & file_name, size_t const first, size_t const last)
+    {
+        std::ofstream file{file_name};
+        size_t bin{};
+        for (auto && file_path : get_repeated_bins(16))
+        {
+            if (bin >= first && bin < last)
+                file << file_path << '\n';
+            ++bin;
+        }
+        file << '\n';
+    }
+
+    cli_test_result build(std::string const & bin_file, std::string const & size, std::string const & parts = "1")
+    {
+        return execute_app("raptor", "build",
+                                     "--kmer 19",
+                                     "--window 19",
+                                     "--size ", size,
+                                     "--parts ", parts,
+                                     "--output ", bin_file + ".index",
+                                     bin_file);
+    }
+};
+
+// 60 bins use 64 technical bins. The new bins are inserted into the spare technical bins.
+TEST_F(update_ibf, spare_technical_bins)
+{
+    write_bins("old.txt", 0u, 60u);
+    write_bins("new.txt", 60u, 64u);
+
+    cli_test_result const result1 = build("old.txt", "64k");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "update",
+                                                          "--input old.txt.index",
+                                                          "--output raptor.index",
+                                                          "--threads 2",
+                                                          "new.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    compare_index(ibf_path(16, 19), "raptor.index");
+}
+
+// 64 bins use all 64 technical bins. The IBF is resized to 128 technical bins with the same bin size.
+TEST_F(update_ibf, resize)
+{
+    write_bins("old.txt", 0u, 64u);
+    write_bins("new.txt", 0u, 4u);
+
+    { // The expected index contains 68 bins.
+        std::ofstream file{"all.txt"};
+        for (auto && file_path : get_repeated_bins(17))
+            file << file_path << '\n';
+        file << '\n';
+    }
+
+    cli_test_result const result1 = build("old.txt", "64k");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = build("all.txt", "128k");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    // The output may be the input.
+    cli_test_result const result3 = execute_app("raptor", "update",
+                                                          "--input old.txt.index",
+                                                          "--output old.txt.index",
+                                                          "new.txt");
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    compare_index("all.txt.index", "old.txt.index");
+}
+
+TEST_F(update_ibf, partitioned)
+{
+    write_bins("old.txt", 0u, 60u);
+    write_bins("new.txt", 60u, 64u);
+    write_bins("all.txt", 0u, 64u);
+
+    cli_test_result const result1 = build("old.txt", "64k", "4");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = build("all.txt", "64k", "4");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    cli_test_result const result3 = execute_app("raptor", "update",
+                                                          "--input old.txt.index",
+                                                          "--output raptor.index",
+                                                          "new.txt");
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    for (size_t part = 0; part < 4u; ++part)
+        compare_index("all.txt.index_" + std::to_string(part), "raptor.index_" + std::to_string(part));
+}
+
+TEST_F(update_ibf, compressed)
+{
+    write_bins("old.txt", 0u, 4u);
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--kmer 19",
+                                                          "--window 19",
+                                                          "--size 64k",
+                                                          "--compressed",
+                                                          "--output raptor.index",
+                                                          "old.txt");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "update",
+                                                          "--input raptor.index",
+                                                          "--output raptor.index",
+                                                          "old.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{"[Error] Compressed indices cannot be updated.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result2);
+}
+
+// The new bins are placed into the existing HIBF. All 68 bins must be found.
+TEST_F(update_ibf, hibf)
+{
+    write_bins("new.txt", 0u, 4u);
+
+    cli_test_result const result1 = execute_app("raptor", "build",
+                                                          "--hibf",
+                                                          "--kmer 19",
+                                                          "--window 19",
+                                                          "--fpr 0.05",
+                                                          "--output raptor.index",
+                                                          pack_path(16));
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    cli_test_result const result2 = execute_app("raptor", "update",
+                                                          "--hibf",
+                                                          "--fpr 0.05",
+                                                          "--threads 2",
+                                                          "--input raptor.index",
+                                                          "--output raptor.index",
+                                                          "new.txt");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    cli_test_result const result3 = execute_app("raptor", "search",
+                                                          "--hibf",
+                                                          "--fpr 0.05",
+                                                          "--error 0",
+                                                          "--p_max 0.4",
+                                                          "--index raptor.index",
+                                                          "--query ", data("query.fq"),
+                                                          "--output search.out");
+    EXPECT_EQ(result3.out, std::string{});
+    EXPECT_EQ(result3.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+    compare_search(17, 0, "search.out");
+}
+
+// An HIBF whose root IBF has no spare technical bins:
+// * Root IBF: 62 user bins `large.fa` (2000 k-mers), merged bin 62, merged bin 63.
+// * Merged bin 62: Lower-level IBF with 64 user bins `small.fa` (500 k-mers). Its merged bin has room left.
+// * Merged bin 63: Lower-level IBF with 64 user bins `large.fa`. Its merged bin is full.
+// The size of the new user bin decides where it is placed, see raptor::hibf::update_hibf.
+struct update_hibf_layout : public raptor_base
+{
+    static constexpr size_t new_user_bin{190u};
+
+    // Writes a random sequence with `number_of_kmers` 19-mers to `file_name` and returns it.
+    static std::string write_sequence(std::string const & file_name, size_t const number_of_kmers, uint64_t const seed)
+    {
+        std::mt19937_64 engine{seed};
+        std::string sequence(number_of_kmers + 18u, 'A');
+        for (char & c : sequence)
+            c = "ACGT"[engine() % 4u];
+
+        std::ofstream file{file_name};
+        file << '>' << file_name << '\n';
+        for (size_t i = 0; i < sequence.size(); i += 80u)
+            file << sequence.substr(i, 80u) << '\n';
+
+        return sequence;
+    }
+
+    static void write_layout(std::string const & file_name, bool const with_new_bin, bool const new_bin_is_largest)
+    {
+        std::ofstream file{file_name};
+        file << "#HIGH_LEVEL_IBF max_bin_id:" << (new_bin_is_largest ? 64 : 0) << '\n'
+             << "#MERGED_BIN_62 max_bin_id:0\n"
+             << "#MERGED_BIN_63 max_bin_id:0\n"
+             << "#FILES\tBIN_INDICES\tNUMBER_OF_BINS\n";
+
+        for (size_t bin = 0; bin < 62u; ++bin)
+            file << "large.fa\t" << bin << "\t1\n";
+        for (size_t bin = 0; bin < 64u; ++bin)
+            file << "small.fa\t62;" << bin << "\t1\n";
+        for (size_t bin = 0; bin < 64u; ++bin)
+            file << "large.fa\t63;" << bin << "\t1\n";
+        if (with_new_bin)
+            file << "new.fa\t64\t1\n";
+    }
+
+    static raptor::index_structure::hibf load(std::string const & file_name)
+    {
+        raptor::raptor_index<raptor::index_structure::hibf> index{};
+        std::ifstream is{file_name, std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        iarchive(index);
+        return std::move(index.ibf());
+    }
+
+    static std::string read(std::string const & file_name)
+    {
+        std::ifstream file{file_name};
+        return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+
+    cli_test_result build(std::string const & layout_file, std::string const & output)
+    {
+        return execute_app("raptor", "build",
+                                     "--hibf",
+                                     "--kmer 19",
+                                     "--window 19",
+                                     "--fpr 0.05",
+                                     "--output ", output,
+                                     layout_file);
+    }
+
+    cli_test_result search(std::string const & index, std::string const & output)
+    {
+        return execute_app("raptor", "search",
+                                     "--hibf",
+                                     "--fpr 0.05",
+                                     "--error 0",
+                                     "--p_max 0.4",
+                                     "--index ", index,
+                                     "--query query.fq",
+                                     "--output ", output);
+    }
+
+    /* Builds the HIBF, adds a user bin with `new_kmers` k-mers via raptor update, and checks that searching the
+     * updated index gives the same result as searching a fresh build of the combined layout.
+     */
+    void update_and_compare(size_t const new_kmers)
+    {
+        std::string const large = write_sequence("large.fa", 2000u, 1u);
+        std::string const small = write_sequence("small.fa", 500u, 2u);
+        std::string const added = write_sequence("new.fa", new_kmers, 3u);
+        {
+            std::ofstream file{"query.fq"};
+            size_t i{};
+            for (std::string const & sequence : {large, small, added})
+                file << "@query" << ++i << '\n' << sequence.substr(0, 100u) << "\n+\n"
+                     << std::string(100u, 'I') << '\n';
+        }
+        {
+            std::ofstream file{"new.txt"};
+            file << "new.fa\n";
+        }
+        write_layout("old.pack", false, false);
+        write_layout("combined.pack", true, new_kmers > 2000u);
+
+        cli_test_result const result1 = build("old.pack", "raptor.index");
+        EXPECT_EQ(result1.out, std::string{});
+        EXPECT_EQ(result1.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+        cli_test_result const result2 = execute_app("raptor", "update",
+                                                              "--hibf",
+                                                              "--fpr 0.05",
+                                                              "--threads 2",
+                                                              "--input raptor.index",
+                                                              "--output updated.index",
+                                                              "new.txt");
+        EXPECT_EQ(result2.out, std::string{});
+        EXPECT_EQ(result2.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+        cli_test_result const result3 = build("combined.pack", "combined.index");
+        EXPECT_EQ(result3.out, std::string{});
+        EXPECT_EQ(result3.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result3);
+
+        for (std::string const name : {"updated", "combined"})
+        {
+            cli_test_result const result = search(name + ".index", name + ".out");
+            EXPECT_EQ(result.out, std::string{});
+            EXPECT_EQ(result.err, std::string{});
+            RAPTOR_ASSERT_ZERO_EXIT(result);
+        }
+
+        std::string const expected = read("combined.out");
+        EXPECT_NE(expected.find("\nquery3\t" + std::to_string(new_user_bin) + '\n'), std::string::npos);
+        EXPECT_EQ(read("updated.out"), expected);
+    }
+};
+
+// The new user bin fits into the bins of the lower-level IBF of merged bin 62, which has no spare technical bins.
+// The IBF grows to 128 technical bins.
+TEST_F(update_hibf_layout, grow_lower_level_ibf)
+{
+    update_and_compare(400u);
+
+    auto const old_hibf = load("raptor.index");
+    auto const hibf = load("updated.index");
+    size_t const ibf_idx = hibf.next_ibf_id[0][62];
+
+    ASSERT_EQ(hibf.ibf_vector.size(), 3u);
+    EXPECT_EQ(hibf.ibf_vector[0].bin_count(), 64u);
+    EXPECT_EQ(hibf.ibf_vector[ibf_idx].bin_count(), 65u);
+    EXPECT_EQ(hibf.ibf_vector[ibf_idx].bin_size(), old_hibf.ibf_vector[ibf_idx].bin_size());
+    EXPECT_EQ(hibf.user_bins.filename_index(ibf_idx, 64u), static_cast<int64_t>(new_user_bin));
+}
+
+// The new user bin does not fit into the bins of the lower-level IBF of merged bin 62. The IBF is rebuilt with larger
+// bins from its user bins. The other IBFs are unchanged.
+TEST_F(update_hibf_layout, rebuild_subtree)
+{
+    update_and_compare(1000u);
+
+    auto const old_hibf = load("raptor.index");
+    auto const hibf = load("updated.index");
+    size_t const ibf_idx = hibf.next_ibf_id[0][62];
+    size_t const other_idx = hibf.next_ibf_id[0][63];
+
+    ASSERT_EQ(hibf.ibf_vector.size(), 3u);
+    EXPECT_EQ(hibf.ibf_vector[0].bin_count(), 64u);
+    EXPECT_EQ(hibf.ibf_vector[ibf_idx].bin_count(), 65u);
+    EXPECT_GT(hibf.ibf_vector[ibf_idx].bin_size(), old_hibf.ibf_vector[ibf_idx].bin_size());
+    EXPECT_EQ(hibf.user_bins.filename_index(ibf_idx, 64u), static_cast<int64_t>(new_user_bin));
+    EXPECT_TRUE(hibf.ibf_vector[other_idx].raw_data() == old_hibf.ibf_vector[other_idx].raw_data());
+}
+
+// Neither merged bin has room for the new user bin, but a bin of the root IBF does. It is stored in a new lower-level
+// IBF below a new merged bin.
+TEST_F(update_hibf_layout, new_lower_level_ibf)
+{
+    update_and_compare(1800u);
+
+    auto const hibf = load("updated.index");
+
+    ASSERT_EQ(hibf.ibf_vector.size(), 4u);
+    EXPECT_EQ(hibf.ibf_vector[0].bin_count(), 65u);
+    EXPECT_EQ(hibf.next_ibf_id[0][64], 3);
+    EXPECT_EQ(hibf.user_bins.filename_index(0u, 64u), -1);
+    EXPECT_EQ(hibf.user_bins.filename_index(3u, 0u), static_cast<int64_t>(new_user_bin));
+}
+
+// The new user bin is larger than the bins of the root IBF. It is split into several new technical bins of the root.
+TEST_F(update_hibf_layout, split_in_root)
+{
+    update_and_compare(4000u);
+
+    auto const hibf = load("updated.index");
+
+    ASSERT_EQ(hibf.ibf_vector.size(), 3u);
+    EXPECT_GT(hibf.ibf_vector[0].bin_count(), 65u);
+    for (size_t bin = 64u; bin < hibf.ibf_vector[0].bin_count(); ++bin)
+        EXPECT_EQ(hibf.user_bins.filename_index(0u, bin), static_cast<int64_t>(new_user_bin));
+}
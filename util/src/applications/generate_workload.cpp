@@ -0,0 +1,187 @@
+// -----------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+// -----------------------------------------------------------------------------------------------------
+
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <random>
+
+#include <seqan3/argument_parser/all.hpp>
+#include <seqan3/io/sequence_file/output.hpp>
+#include <seqan3/utility/views/slice.hpp>
+
+// Generates a synthetic workload for raptor:
+// * `bins` random reference bins whose sizes follow a Zipf distribution with exponent `skew` (0 = equal sizes).
+// * `reads` reads with a uniformly distributed length in [min_length, max_length]. The bin of each read is chosen
+//   proportional to the bin size. Each base is substituted with probability `error_rate`.
+// The read IDs have the format `<read number>_<bin number>`, e.g., `42_7`, such that the origin is known.
+struct cmd_arguments
+{
+    std::filesystem::path out_path{};
+    uint64_t total_length{1ULL<<26};
+    uint32_t number_of_bins{64u};
+    double skew{0.0};
+    uint64_t number_of_reads{1ULL<<16};
+    uint32_t min_length{100u};
+    uint32_t max_length{100u};
+    double error_rate{0.02};
+    uint64_t seed{42u};
+};
+
+void run_program(cmd_arguments const & arguments)
+{
+    std::mt19937_64 rng(arguments.seed);
+    std::uniform_int_distribution<uint8_t> dna4_rank_dis(0, 3);
+
+    // Bin sizes.
+    std::vector<double> weights(arguments.number_of_bins);
+    for (size_t i = 0; i < weights.size(); ++i)
+        weights[i] = 1.0 / std::pow(static_cast<double>(i + 1u), arguments.skew);
+    double const weight_sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    std::vector<uint64_t> bin_lengths(arguments.number_of_bins);
+    for (size_t i = 0; i < bin_lengths.size(); ++i)
+        bin_lengths[i] = std::max<uint64_t>(arguments.max_length,
+                                            std::llround(arguments.total_length * weights[i] / weight_sum));
+
+    // Bins.
+    std::filesystem::path const bin_dir = arguments.out_path / "bins";
+    std::filesystem::create_directories(bin_dir);
+    std::ofstream bin_list{arguments.out_path / "bins.list"};
+    size_t const digits = std::to_string(arguments.number_of_bins - 1u).size();
+
+    std::vector<std::vector<seqan3::dna4>> bins(arguments.number_of_bins);
+    for (size_t bin_number = 0; bin_number < bins.size(); ++bin_number)
+    {
+        std::string bin_name = std::to_string(bin_number);
+        bin_name.insert(0, digits - bin_name.size(), '0');
+        std::filesystem::path const bin_file = bin_dir / ("bin_" + bin_name + ".fasta");
+
+        auto & bin = bins[bin_number];
+        bin.resize(bin_lengths[bin_number]);
+        for (auto & base : bin)
+            seqan3::assign_rank_to(dna4_rank_dis(rng), base);
+
+        seqan3::sequence_file_output fout{bin_file, seqan3::fields<seqan3::field::seq, seqan3::field::id>{}};
+        fout.emplace_back(bin, bin_name);
+        bin_list << std::filesystem::absolute(bin_file).string() << '\n';
+    }
+
+    // Reads.
+    std::discrete_distribution<size_t> bin_dis(bin_lengths.begin(), bin_lengths.end());
+    std::uniform_int_distribution<uint32_t> read_length_dis(arguments.min_length, arguments.max_length);
+    std::bernoulli_distribution is_error_dis(arguments.error_rate);
+
+    seqan3::sequence_file_output fout{arguments.out_path / "reads.fastq"};
+    std::vector<seqan3::dna4> read;
+    std::vector<seqan3::phred42> quality;
+
+    for (uint64_t read_number = 0; read_number < arguments.number_of_reads; ++read_number)
+    {
+        size_t const bin_number = bin_dis(rng);
+        uint32_t const read_length = read_length_dis(rng);
+        auto const & bin = bins[bin_number];
+
+        std::uniform_int_distribution<uint64_t> read_start_dis(0, bin.size() - read_length);
+        uint64_t const read_start_pos = read_start_dis(rng);
+        auto read_slice = bin | seqan3::views::slice(read_start_pos, read_start_pos + read_length);
+        read.assign(read_slice.begin(), read_slice.end());
+
+        for (auto & base : read)
+        {
+            if (is_error_dis(rng))
+            {
+                seqan3::dna4 new_base = base;
+                while (new_base == base)
+                    seqan3::assign_rank_to(dna4_rank_dis(rng), new_base);
+                base = new_base;
+            }
+        }
+
+        quality.assign(read_length, seqan3::assign_rank_to(40u, seqan3::phred42{}));
+        fout.emplace_back(read, std::to_string(read_number) + '_' + std::to_string(bin_number), quality);
+    }
+}
+
+void initialise_argument_parser(seqan3::argument_parser & parser, cmd_arguments & arguments)
+{
+    parser.info.author = "Enrico Seiler";
+    parser.info.author = "enrico.seiler@fu-berlin.de";
+    parser.info.short_description = "Generate reference bins and reads for benchmarking raptor.";
+    parser.info.version = "0.0.1";
+    parser.info.examples = {"./generate_workload --output ./workload --bins 1024 --skew 1.0 --error_rate 0.01"};
+    parser.add_option(arguments.out_path,
+                      '\0',
+                      "output",
+                      "Provide the base dir where bins/, bins.list, and reads.fastq should be written to.",
+                      seqan3::option_spec::required,
+                      seqan3::output_directory_validator{});
+    parser.add_option(arguments.total_length,
+                      '\0',
+                      "length",
+                      "The total length of all bins.");
+    parser.add_option(arguments.number_of_bins,
+                      '\0',
+                      "bins",
+                      "The number of bins.",
+                      seqan3::option_spec::standard,
+                      seqan3::arithmetic_range_validator{1, 1'000'000});
+    parser.add_option(arguments.skew,
+                      '\0',
+                      "skew",
+                      "The exponent of the Zipf distribution of bin sizes. 0 results in equally sized bins.",
+                      seqan3::option_spec::standard,
+                      seqan3::arithmetic_range_validator{0, 10});
+    parser.add_option(arguments.number_of_reads,
+                      '\0',
+                      "reads",
+                      "The number of reads.");
+    parser.add_option(arguments.min_length,
+                      '\0',
+                      "min_length",
+                      "The minimum read length.");
+    parser.add_option(arguments.max_length,
+                      '\0',
+                      "max_length",
+                      "The maximum read length.");
+    parser.add_option(arguments.error_rate,
+                      '\0',
+                      "error_rate",
+                      "The probability of a substitution for each base of a read.",
+                      seqan3::option_spec::standard,
+                      seqan3::arithmetic_range_validator{0, 1});
+    parser.add_option(arguments.seed,
+                      '\0',
+                      "seed",
+                      "The seed of the random number generator.");
+}
+
+int main(int argc, char ** argv)
+{
+    seqan3::argument_parser myparser{"generate_workload", argc, argv, seqan3::update_notifications::off};
+    cmd_arguments arguments{};
+    initialise_argument_parser(myparser, arguments);
+    try
+    {
+         myparser.parse();
+    }
+    catch (seqan3::argument_parser_error const & ext)
+    {
+        std::cout << "[Error] " << ext.what() << "\n";
+        return -1;
+    }
+
+    if (arguments.min_length == 0u || arguments.min_length > arguments.max_length)
+        throw seqan3::argument_parser_error{"The minimum read length must be in [1, max_length]."};
+
+    if (arguments.total_length / arguments.number_of_bins < arguments.max_length)
+        throw seqan3::argument_parser_error{"The bins must be at least as long as the longest read."};
+
+    run_program(arguments);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#!/usr/bin/env bash
+
+# -----------------------------------------------------------------------------------------------------
+# Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+# Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+# This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+# shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+# -----------------------------------------------------------------------------------------------------
+
+# Strong and weak scaling of `raptor search` for the IBF, compressed IBF, partitioned IBF, and HIBF on a synthetic
+# workload. Results are written to $BENCHMARK_DIR/search_scaling.csv, see eval_search_scaling.py.
+
+set -Eeuo pipefail
+
+# Workload
+LENGTH=268435456 # 2^28
+BIN_NUMBER=1024
+SKEW=1.0 # Zipf exponent of the bin sizes, 0 for equal sizes
+READ_COUNT=1048576
+MIN_LENGTH=100
+MAX_LENGTH=250
+ERROR_RATE=0.01
+SEED=42
+# Index
+W=23
+K=19
+HASH=2
+ERRORS=2
+FPR=0.05
+SIZE=1g
+PARTS=4
+MODES="ibf compressed partitioned hibf"
+# Scaling
+THREAD_COUNTS="1 2 4 8 16 32"
+BUILD_THREADS=32
+UTILITY_BINARY_DIR="<path to built utility binaries>" # containing the generate_workload binary
+CHOPPER_BINARY_DIR="<path to built chopper binaries>" # containing the chopper binary; only needed for the HIBF
+RAPTOR_BINARY_DIR="<path to built raptor binaries>" # containing the raptor binary
+BENCHMARK_DIR="<path>" # directory where results should be stored. E.g., /dev/shm/username
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+
+working_directory=$BENCHMARK_DIR/search_scaling
+workload_directory=$working_directory/workload
+mkdir -p $working_directory/results
+
+if [ ! -f $workload_directory/reads.fastq ] ; then
+    echo "Generating workload"
+    mkdir -p $workload_directory
+    $UTILITY_BINARY_DIR/generate_workload \
+        --output $workload_directory \
+        --length $LENGTH \
+        --bins $BIN_NUMBER \
+        --skew $SKEW \
+        --reads $READ_COUNT \
+        --min_length $MIN_LENGTH \
+        --max_length $MAX_LENGTH \
+        --error_rate $ERROR_RATE \
+        --seed $SEED
+fi
+
+# Weak scaling: The number of reads grows with the number of threads.
+for threads in $THREAD_COUNTS; do
+    weak_reads=$workload_directory/reads_$threads.fastq
+    if [ ! -f $weak_reads ] ; then
+        for i in $(seq 1 $threads); do cat $workload_directory/reads.fastq; done > $weak_reads
+    fi
+done
+
+build_index() {
+    local mode=$1
+    local index=$working_directory/$mode.index
+    local log=$working_directory/results/$mode\_build.log
+    case $mode in
+        ibf)
+            /usr/bin/time -o $log -v $RAPTOR_BINARY_DIR/raptor build --kmer $K --window $W --size $SIZE --hash $HASH \
+                --threads $BUILD_THREADS --output $index $workload_directory/bins.list ;;
+        compressed)
+            /usr/bin/time -o $log -v $RAPTOR_BINARY_DIR/raptor build --kmer $K --window $W --size $SIZE --hash $HASH \
+                --threads $BUILD_THREADS --compressed --output $index $workload_directory/bins.list ;;
+        partitioned)
+            /usr/bin/time -o $log -v $RAPTOR_BINARY_DIR/raptor build --kmer $K --window $W --size $SIZE --hash $HASH \
+                --threads $BUILD_THREADS --parts $PARTS --output $index $workload_directory/bins.list ;;
+        hibf)
+            $CHOPPER_BINARY_DIR/chopper count --threads $BUILD_THREADS --column-index 1 \
+                --input-file $workload_directory/bins.list --output-prefix $working_directory/chopper
+            $CHOPPER_BINARY_DIR/chopper layout --input-prefix $working_directory/chopper --tmax 64 \
+                --false-positive-rate $FPR --threads $BUILD_THREADS --output-file $working_directory/hibf.layout \
+                1>/dev/null
+            /usr/bin/time -o $log -v $RAPTOR_BINARY_DIR/raptor build --kmer $K --window $W --hash $HASH --hibf \
+                --fpr $FPR --threads $BUILD_THREADS --output $index $working_directory/hibf.layout ;;
+    esac
+}
+
+run_search() {
+    local mode=$1
+    local scaling=$2
+    local threads=$3
+    local reads=$4
+    local prefix=$working_directory/results/$mode\_$scaling\_$threads
+    local hibf_flag=""
+    [ "$mode" = hibf ] && hibf_flag="--hibf"
+    /usr/bin/time -o $prefix.log -v \
+        $RAPTOR_BINARY_DIR/raptor search $hibf_flag \
+            --index $working_directory/$mode.index \
+            --query $reads \
+            --output $prefix.out \
+            --threads $threads \
+            --error $ERRORS \
+            --pattern $MIN_LENGTH \
+            --fpr $FPR \
+            --metrics $prefix.json
+    rm $prefix.out
+}
+
+for mode in $MODES; do
+    echo "[$(date +"%Y-%m-%d %T")] Building $mode"
+    build_index $mode
+
+    for threads in $THREAD_COUNTS; do
+        echo "[$(date +"%Y-%m-%d %T")] Searching $mode with $threads threads"
+        run_search $mode strong $threads $workload_directory/reads.fastq
+        run_search $mode weak $threads $workload_directory/reads_$threads.fastq
+    done
+
+    rm -f $working_directory/$mode.index*
+done
+
+python3 $SCRIPT_DIR/../evaluation_scripts/eval_search_scaling.py $working_directory/results \
+    > $BENCHMARK_DIR/search_scaling.csv
+echo "Results: $BENCHMARK_DIR/search_scaling.csv"
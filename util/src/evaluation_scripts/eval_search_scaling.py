@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+# -----------------------------------------------------------------------------------------------------
+# Copyright (c) 2006-2022, Knut Reinert & Freie Universität Berlin
+# Copyright (c) 2016-2022, Knut Reinert & MPI für molekulare Genetik
+# This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+# shipped with this file and also available at: https://github.com/seqan/raptor/blob/master/LICENSE.md
+# -----------------------------------------------------------------------------------------------------
+#
+# Usage eval_search_scaling.py <results directory>
+#
+# Collects the results of search_scaling.sh and prints them as CSV.
+# For each <mode>_<scaling>_<threads>, the directory must contain the `raptor search --metrics` output
+# <mode>_<scaling>_<threads>.json and the `/usr/bin/time -v` output <mode>_<scaling>_<threads>.log.
+import argparse
+import json
+import os
+import re
+
+def process_time_log(path):
+    peak_rss = 0
+    with open(path) as f:
+        for line in f:
+            match = re.match(r'\s*Maximum resident set size \(kbytes\): (\d+)', line)
+            if match:
+                peak_rss = int(match.group(1)) * 1024
+    return peak_rss
+
+def process_metrics(path):
+    with open(path) as f:
+        metrics = json.load(f)
+    stages = {stage['name']: stage for stage in metrics['stages']}
+    reads = metrics['counts']['reads']
+    compute = stages['compute']['time'] if 'compute' in stages else 0.0
+    index_io = stages['index_io']['time'] if 'index_io' in stages else 0.0
+    return {
+        'reads': reads,
+        'wall_time': metrics['wall_time'],
+        'index_io_time': index_io,
+        'compute_time': compute,
+        'reads_per_second': reads / compute if compute > 0 else 0.0,
+        'minimisers_per_read': metrics['per_read']['minimisers'],
+        'ibfs_visited_per_read': metrics['per_read']['ibfs_visited'],
+    }
+
+parser = argparse.ArgumentParser(description='Collects the results of search_scaling.sh and prints them as CSV.',
+                                 formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+parser.add_argument('input', type=str, help='Results directory of search_scaling.sh.')
+arguments = parser.parse_args()
+
+columns = ['mode', 'scaling', 'threads', 'reads', 'wall_time', 'index_io_time', 'compute_time', 'reads_per_second',
+           'latency_us_per_read', 'minimisers_per_read', 'ibfs_visited_per_read', 'peak_rss', 'efficiency']
+rows = []
+
+for filename in os.listdir(arguments.input):
+    match = re.fullmatch(r'(.+)_(strong|weak)_(\d+)\.json', filename)
+    if not match:
+        continue
+    row = {'mode': match.group(1), 'scaling': match.group(2), 'threads': int(match.group(3))}
+    row.update(process_metrics(os.path.join(arguments.input, filename)))
+    log = os.path.join(arguments.input, filename[:-len('.json')] + '.log')
+    row['peak_rss'] = process_time_log(log) if os.path.exists(log) else 0
+    # Each thread processes reads / threads reads in compute_time.
+    row['latency_us_per_read'] = row['compute_time'] * row['threads'] * 1e6 / row['reads'] if row['reads'] > 0 else 0.0
+    rows.append(row)
+
+rows.sort(key=lambda row: (row['mode'], row['scaling'], row['threads']))
+
+# Parallel efficiency relative to the smallest thread count of the same mode and scaling.
+# Strong scaling: T(1) / (p * T(p)). Weak scaling: T(1) / T(p).
+baselines = {}
+for row in rows:
+    key = (row['mode'], row['scaling'])
+    if key not in baselines:
+        baselines[key] = row
+    baseline = baselines[key]
+    factor = row['threads'] / baseline['threads'] if row['scaling'] == 'strong' else 1
+    row['efficiency'] = baseline['compute_time'] / (factor * row['compute_time']) if row['compute_time'] > 0 else 0.0
+
+print(','.join(columns))
+for row in rows:
+    print(','.join(str(round(row[column], 6)) if isinstance(row[column], float) else str(row[column])
+                   for column in columns))